@@ -2,14 +2,20 @@
 
 #include <curl/curl.h>
 #include <ctype.h>
+#include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <signal.h>
 #include <string.h>
+#include <sys/file.h>
+#include <sys/inotify.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -17,8 +23,90 @@
 #define PATH_MAX 4096
 #endif
 
+// ---------- Allocation counting ----------
+// malloc, calloc, realloc and strdup are routed through these wrappers (the macros below
+// come after the wrappers, which call the real functions), so a benchmark can report
+// allocations per operation. A realloc counts as one allocation of the new size.
+//
+// Building with -DSPELLINGBEE_ALLOC_PHASES also charges each allocation to the current
+// phase (loading, solving, payload construction, response handling; see
+// alloc_phase_enter), and --metrics-file reports the totals. Without it the phase calls
+// do nothing.
+typedef enum {
+    ALLOC_PHASE_OTHER,
+    ALLOC_PHASE_LOAD,
+    ALLOC_PHASE_SOLVE,
+    ALLOC_PHASE_PAYLOAD,
+    ALLOC_PHASE_RESPONSE,
+    ALLOC_PHASE_COUNT
+} AllocPhase;
+
+static uint64_t g_alloc_count;
+static uint64_t g_alloc_bytes;
+#ifdef SPELLINGBEE_ALLOC_PHASES
+static const char *const ALLOC_PHASE_NAMES[ALLOC_PHASE_COUNT] = {"other", "load", "solve", "payload", "response"};
+static AllocPhase g_alloc_phase;
+static uint64_t g_phase_alloc_count[ALLOC_PHASE_COUNT];
+static uint64_t g_phase_alloc_bytes[ALLOC_PHASE_COUNT];
+#endif
+
+static void count_allocation(size_t size) {
+    g_alloc_count++;
+    g_alloc_bytes += size;
+#ifdef SPELLINGBEE_ALLOC_PHASES
+    g_phase_alloc_count[g_alloc_phase]++;
+    g_phase_alloc_bytes[g_alloc_phase] += size;
+#endif
+}
+
+// Charges allocations to `phase` until alloc_phase_leave() is given the returned value.
+static AllocPhase alloc_phase_enter(AllocPhase phase) {
+#ifdef SPELLINGBEE_ALLOC_PHASES
+    AllocPhase saved = g_alloc_phase;
+    g_alloc_phase = phase;
+    return saved;
+#else
+    (void)phase;
+    return ALLOC_PHASE_OTHER;
+#endif
+}
+
+static void alloc_phase_leave(AllocPhase saved) {
+#ifdef SPELLINGBEE_ALLOC_PHASES
+    g_alloc_phase = saved;
+#else
+    (void)saved;
+#endif
+}
+
+static void *counted_malloc(size_t size) {
+    count_allocation(size);
+    return malloc(size);
+}
+
+static void *counted_calloc(size_t count, size_t size) {
+    count_allocation(count * size);
+    return calloc(count, size);
+}
+
+static void *counted_realloc(void *ptr, size_t size) {
+    count_allocation(size);
+    return realloc(ptr, size);
+}
+
+static char *counted_strdup(const char *text) {
+    count_allocation(strlen(text) + 1);
+    return strdup(text);
+}
+
+#define malloc(size) counted_malloc(size)
+#define calloc(count, size) counted_calloc(count, size)
+#define realloc(ptr, size) counted_realloc(ptr, size)
+#define strdup(text) counted_strdup(text)
+
 #define ARRAY_LEN(a) (sizeof(a) / sizeof((a)[0]))
 #define WD_ELEMENT_KEY "element-6066-11e4-a52e-4f735466cecf"
+#define SPELLING_BEE_URL "https://www.nytimes.com/puzzles/spelling-bee"
 
 typedef struct {
     char **items;
@@ -33,22 +121,111 @@ typedef struct {
     WordList massive_words;
 } WordDictionaries;
 
+// Per-word letter masks and lengths, computed once at load time. `words` is borrowed and
+// must outlive the index.
+typedef struct {
+    const WordList *words;
+    uint32_t *masks;
+    uint32_t *lengths;
+    size_t size;
+} WordIndex;
+
+// The solver's index: a base plus the changes of the delta segments (see
+// layer_word_changes), merged at query time. Base words a segment removed (tombstones) are
+// flagged and skipped; added words are indexed on their own. `base` and `added.words` are
+// borrowed, so a moved LayeredWordIndex needs them pointed at their new homes.
+typedef struct {
+    const WordIndex *base;
+    bool *removed;           // by base position; NULL when no base word is removed
+    size_t removed_count;
+    WordList added_words;
+    WordIndex added;
+} LayeredWordIndex;
+
+// One line of a delta segment: `word` added (present) or removed. `order` counts across the
+// segments, so once sorted the last change to a word can be kept (see word_changes_settle).
+typedef struct {
+    char *word;
+    size_t order;
+    bool present;
+} WordChange;
+
+typedef struct {
+    WordChange *items;
+    size_t size;
+    size_t capacity;
+} WordChanges;
+
+typedef struct {
+    unsigned long max_score;
+    WordList pangrams;
+} ScoreSummary;
+
+#define TIER_SHORT 0x01u
+#define TIER_MEDIUM 0x02u
+#define TIER_EXTENDED 0x04u
+#define TIER_MASSIVE 0x08u
+#define TIER_HIVE_LEGAL 0x10u
+
+typedef struct {
+    uint64_t hash;
+    const char *word;   // borrowed from the WordDictionaries
+    uint8_t tiers;      // 0 marks an empty slot
+} MembershipSlot;
+
+typedef struct {
+    MembershipSlot *slots;
+    size_t slot_mask;
+    size_t count;
+} MembershipTable;
+
 typedef struct {
     char *data;
     size_t length;
     size_t capacity;
 } StringBuffer;
 
+typedef struct CurlSession CurlSession;
+
 typedef struct {
     long status;
     char *body;
     size_t body_size;
+    size_t body_capacity;
+    CurlSession *pool;  // gets the body buffer back on cleanup, unless the body was taken
 } HttpResponse;
 
+#define TRANSPORT_MAX_ENDPOINTS 32
+
+// Call counts and curl's timings for one endpoint, ids masked ("GET /session/{id}/url").
 typedef struct {
+    char label[96];
+    size_t calls;
+    size_t failures;
+    double total_ms;
+    double max_ms;
+    double first_byte_ms;
+    double connect_ms;
+    curl_off_t bytes_sent;
+    curl_off_t bytes_received;
+} TransportEndpoint;
+
+struct CurlSession {
     CURL *curl;
     struct curl_slist *headers;
-} CurlSession;
+    // Outcome of the most recent request, kept for retry classification.
+    CURLcode last_code;
+    long last_status;
+    char last_error[64];
+    // A finished response's buffer, handed to the next request so it rarely reallocates.
+    char *spare_body;
+    size_t spare_capacity;
+    long timeout_override_ms;  // > 0 replaces the per-request timeout
+    TransportEndpoint endpoints[TRANSPORT_MAX_ENDPOINTS];
+    size_t endpoint_count;
+    FILE *record;  // --record=FILE, or NULL
+    struct timespec record_start;
+};
 
 typedef struct {
     CurlSession *session;
@@ -62,17 +239,63 @@ typedef enum {
     STEP_RESULT_QUIT
 } StepResult;
 
+typedef enum {
+    ERROR_CLASS_UNKNOWN = 0,
+    ERROR_CLASS_TRANSIENT,
+    ERROR_CLASS_PERMANENT
+} ErrorClass;
+
+#define SYNTHETIC_MAX_LENGTH 32
+#define MAX_STRESS_SIZES 16
+
+// Letter and word-length weights of the synthetic word generator.
+typedef struct {
+    uint32_t letter_weights[26];
+    uint32_t length_weights[SYNTHETIC_MAX_LENGTH + 1];  // by word length
+    uint64_t seed;
+} SyntheticSpec;
+
 typedef enum {
     STOP_ACTION_PROMPT = 0,
     STOP_ACTION_KEEP,
     STOP_ACTION_RERUN
 } StopAction;
 
+typedef enum {
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_FATAL,
+    LOG_LEVEL_OFF
+} LogLevel;
+
 typedef struct {
     StopAction stop_action;
     bool has_cli_letters;
     char letters_cli[8];
     char dictionary_dir[PATH_MAX];
+    char check_words_file[PATH_MAX];
+    int ready_timeout_seconds;
+    char session_file[PATH_MAX];
+    char record_file[PATH_MAX];  // empty: no recording
+    char metrics_prefix[PATH_MAX];  // empty: no phase metrics
+    char trace_file[PATH_MAX];      // empty: no trace
+    WordChanges word_changes;       // --add-words (present) / --remove-words, in order
+    bool compact_dictionaries;
+    LogLevel log_level;
+    bool log_json;
+    bool reuse_session;
+    int pace_ms;                  // -1: one actions request; else paced entry's initial pause
+    bool transport_stats;
+    int bench_decode_iterations;
+    bool bench;
+    uint64_t bench_words;  // 0: the real lists when present, else DEFAULT_BENCH_WORDS synthetic
+    SyntheticSpec synthetic;
+    char generate_dir[PATH_MAX];  // empty: do not generate
+    uint64_t synthetic_words;
+    uint64_t stress_sizes[MAX_STRESS_SIZES];
+    size_t stress_count;  // 0: no stress run
 } Config;
 
 typedef struct {
@@ -80,10 +303,493 @@ typedef struct {
     bool user_quit;
     bool fatal_error;
     char *fatal_message;
+    unsigned long projected_score;
 } AttemptResult;
 
+typedef struct {
+    long lettered_cells;
+    bool modal_open;
+    char *dismissed;
+} ReadinessProbe;
+
 typedef int (*OperationFn)(void *ctx, char **err_out);
 
+// ---------- Logging ----------
+// Diagnostics go through log_at() rather than straight to stderr. --log-level drops less
+// severe records before anything is formatted, so a disabled call costs one compare;
+// --log-format=json writes one JSON object per line (ts, level, thread, msg and any fields)
+// in place of the "[WARN] ..." text. The port is single-threaded, so each record is written
+// as it is logged, in a single write, and there is no writer thread or ring to drain.
+static const char *const LOG_LEVEL_NAMES[] = {"debug", "info", "warn", "error", "fatal", "off"};
+static const char *const LOG_LEVEL_TAGS[] = {"[DEBUG] ", "[INFO] ", "[WARN] ", "[ERROR] ", "[FATAL] ", ""};
+
+static LogLevel g_log_level = LOG_LEVEL_INFO;
+static bool g_log_json;
+
+typedef struct {
+    char text[384];  // JSON object members, comma separated
+    size_t len;
+} LogFields;
+
+static bool log_enabled(LogLevel level) {
+    return level >= g_log_level;
+}
+
+static bool parse_log_level(const char *name, LogLevel *out) {
+    for (size_t i = 0; i < sizeof(LOG_LEVEL_NAMES) / sizeof(LOG_LEVEL_NAMES[0]); ++i) {
+        if (strcmp(name, LOG_LEVEL_NAMES[i]) == 0) {
+            *out = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Writes `value` into `out` as the contents of a JSON string, cut short to fit `cap`.
+static void json_escape_into(char *out, size_t cap, const char *value) {
+    size_t len = 0;
+    for (const unsigned char *p = (const unsigned char *)value; *p && len + 7 < cap; ++p) {
+        if (*p == '"' || *p == '\\') {
+            out[len++] = '\\';
+            out[len++] = (char)*p;
+        } else if (*p < 0x20) {
+            len += (size_t)snprintf(out + len, cap - len, "\\u%04x", *p);
+        } else {
+            out[len++] = (char)*p;
+        }
+    }
+    out[len] = '\0';
+}
+
+// Appends `"key":` and a value formatted by `fmt`; a field that does not fit is dropped.
+static void log_field_format(LogFields *fields, const char *key, const char *fmt, ...) {
+    size_t room = sizeof(fields->text) - fields->len;
+    int n = snprintf(fields->text + fields->len, room, "%s\"%s\":", fields->len ? "," : "", key);
+    if (n < 0 || (size_t)n >= room) {
+        fields->text[fields->len] = '\0';
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int m = vsnprintf(fields->text + fields->len + (size_t)n, room - (size_t)n, fmt, ap);
+    va_end(ap);
+    if (m < 0 || (size_t)(n + m) >= room) {
+        fields->text[fields->len] = '\0';
+        return;
+    }
+    fields->len += (size_t)(n + m);
+}
+
+static void log_field_long(LogFields *fields, const char *key, long value) {
+    log_field_format(fields, key, "%ld", value);
+}
+
+static void log_field_bool(LogFields *fields, const char *key, bool value) {
+    log_field_format(fields, key, "%s", value ? "true" : "false");
+}
+
+static void log_field_string(LogFields *fields, const char *key, const char *value) {
+    char escaped[256];
+    json_escape_into(escaped, sizeof(escaped), value ? value : "");
+    log_field_format(fields, key, "\"%s\"", escaped);
+}
+
+static void log_write(LogLevel level, const LogFields *fields, const char *fmt, va_list ap) {
+    char message[1024];
+    vsnprintf(message, sizeof(message), fmt, ap);
+    // Leading newlines separate a record from a half-written prompt line; they stay ahead
+    // of the tag in text and are dropped from JSON.
+    const size_t newlines = strspn(message, "\n");
+    char line[3072];
+    int n;
+    if (!g_log_json) {
+        n = snprintf(line, sizeof(line), "%.*s%s%s\n", (int)newlines, message, LOG_LEVEL_TAGS[level],
+                     message + newlines);
+    } else {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        struct tm utc;
+        gmtime_r(&now.tv_sec, &utc);
+        char ts[32];
+        strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S", &utc);
+        char escaped[2048];
+        json_escape_into(escaped, sizeof(escaped), message + newlines);
+        const bool has_fields = fields && fields->len;
+        n = snprintf(line, sizeof(line), "{\"ts\":\"%s.%03ldZ\",\"level\":\"%s\",\"thread\":1,\"msg\":\"%s\"%s%s}\n", ts,
+                     now.tv_nsec / 1000000, LOG_LEVEL_NAMES[level], escaped, has_fields ? "," : "",
+                     has_fields ? fields->text : "");
+    }
+    if (n < 0) return;
+    fwrite(line, 1, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1, stderr);
+}
+
+// Logs a printf-style message; nothing is formatted when `level` is disabled.
+static void log_at(LogLevel level, const char *fmt, ...) {
+    if (!log_enabled(level)) return;
+    va_list ap;
+    va_start(ap, fmt);
+    log_write(level, NULL, fmt, ap);
+    va_end(ap);
+}
+
+// As log_at, with `fields` added to JSON records; text lines show the message only.
+static void log_fields(LogLevel level, const LogFields *fields, const char *fmt, ...) {
+    if (!log_enabled(level)) return;
+    va_list ap;
+    va_start(ap, fmt);
+    log_write(level, fields, fmt, ap);
+    va_end(ap);
+}
+
+// ---------- Phase metrics ----------
+// With --metrics-file=PREFIX every timed phase of a run feeds a histogram keyed by phase
+// and detail: dictionary load per file, index build, each WebDriver endpoint, board read,
+// solve, payload build and submission. The histograms are log-linear, HDR style: 32
+// sub-buckets per power of two of nanoseconds keep any value within about 3% of its
+// bucket at a fixed 10 KiB per histogram. PREFIX.prom (Prometheus text format) and
+// PREFIX.json are written at exit and after SIGUSR1, which is picked up at the next
+// recorded phase or while waiting at a prompt. Without the flag recording does nothing.
+#define PHASE_SUB_BUCKET_BITS 5
+#define PHASE_MAX_MSB 44  // ~4.9 hours; longer values land in the last bucket
+#define PHASE_BUCKETS (((PHASE_MAX_MSB - PHASE_SUB_BUCKET_BITS) << PHASE_SUB_BUCKET_BITS) + \
+                       (2u << PHASE_SUB_BUCKET_BITS))
+#define PHASE_MAX_HISTOGRAMS 64
+
+typedef struct {
+    char phase[24];
+    char detail[96];
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t buckets[PHASE_BUCKETS];
+} PhaseHistogram;
+
+static bool g_phase_metrics_enabled;
+static char g_metrics_prefix[PATH_MAX];
+static PhaseHistogram g_phase_histograms[PHASE_MAX_HISTOGRAMS];
+static size_t g_phase_histogram_count;
+static volatile sig_atomic_t g_metrics_dump_requested;
+
+static double monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static size_t phase_bucket_index(uint64_t ns) {
+    if (ns < (2u << PHASE_SUB_BUCKET_BITS)) return (size_t)ns;
+    unsigned msb = 0;
+    for (uint64_t v = ns; v >>= 1;) ++msb;
+    if (msb > PHASE_MAX_MSB) return PHASE_BUCKETS - 1;
+    unsigned shift = msb - PHASE_SUB_BUCKET_BITS;
+    return ((size_t)shift << PHASE_SUB_BUCKET_BITS) + (size_t)(ns >> shift);
+}
+
+static uint64_t phase_bucket_high(size_t index) {
+    if (index < (2u << PHASE_SUB_BUCKET_BITS)) return index;
+    unsigned shift = (unsigned)(index >> PHASE_SUB_BUCKET_BITS) - 1;
+    uint64_t top = (index & ((1u << PHASE_SUB_BUCKET_BITS) - 1)) + (1u << PHASE_SUB_BUCKET_BITS);
+    return ((top + 1) << shift) - 1;
+}
+
+// The highest value equivalent to the q-quantile's bucket, capped at the maximum.
+static uint64_t phase_percentile(const PhaseHistogram *h, double q) {
+    if (h->count == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)h->count);
+    if ((double)rank < q * (double)h->count || rank == 0) rank++;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < PHASE_BUCKETS; ++i) {
+        seen += h->buckets[i];
+        if (seen >= rank) return phase_bucket_high(i) < h->max_ns ? phase_bucket_high(i) : h->max_ns;
+    }
+    return h->max_ns;
+}
+
+// Values whose whole bucket lies at or below `ns`.
+static uint64_t phase_count_at_most(const PhaseHistogram *h, uint64_t ns) {
+    uint64_t n = 0;
+    for (size_t i = 0; i < PHASE_BUCKETS && phase_bucket_high(i) <= ns; ++i) n += h->buckets[i];
+    return n;
+}
+
+// Label values for both output formats; only quote and backslash need escaping.
+static void phase_print_escaped(FILE *out, const char *text) {
+    for (; *text; ++text) {
+        if (*text == '"' || *text == '\\') fputc('\\', out);
+        fputc(*text, out);
+    }
+}
+
+static void phase_write_prometheus(FILE *out) {
+    static const double bounds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1,
+                                    0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 300};
+    static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    fprintf(out, "# HELP spellingbee_phase_duration_seconds Time spent in each phase of a run.\n"
+                 "# TYPE spellingbee_phase_duration_seconds histogram\n");
+    for (size_t i = 0; i < g_phase_histogram_count; ++i) {
+        const PhaseHistogram *h = &g_phase_histograms[i];
+        for (size_t b = 0; b <= ARRAY_LEN(bounds); ++b) {
+            fprintf(out, "spellingbee_phase_duration_seconds_bucket{phase=\"%s\",detail=\"", h->phase);
+            phase_print_escaped(out, h->detail);
+            if (b < ARRAY_LEN(bounds)) {
+                fprintf(out, "\",le=\"%g\"} %llu\n", bounds[b],
+                        (unsigned long long)phase_count_at_most(h, (uint64_t)(bounds[b] * 1e9)));
+            } else {
+                fprintf(out, "\",le=\"+Inf\"} %llu\n", (unsigned long long)h->count);
+            }
+        }
+        fprintf(out, "spellingbee_phase_duration_seconds_sum{phase=\"%s\",detail=\"", h->phase);
+        phase_print_escaped(out, h->detail);
+        fprintf(out, "\"} %.9g\n", (double)h->sum_ns / 1e9);
+        fprintf(out, "spellingbee_phase_duration_seconds_count{phase=\"%s\",detail=\"", h->phase);
+        phase_print_escaped(out, h->detail);
+        fprintf(out, "\"} %llu\n", (unsigned long long)h->count);
+    }
+    fprintf(out, "# HELP spellingbee_phase_duration_quantile_seconds Quantiles of the phase durations.\n"
+                 "# TYPE spellingbee_phase_duration_quantile_seconds gauge\n");
+    for (size_t i = 0; i < g_phase_histogram_count; ++i) {
+        const PhaseHistogram *h = &g_phase_histograms[i];
+        for (size_t q = 0; q < ARRAY_LEN(quantiles); ++q) {
+            fprintf(out, "spellingbee_phase_duration_quantile_seconds{phase=\"%s\",detail=\"", h->phase);
+            phase_print_escaped(out, h->detail);
+            fprintf(out, "\",quantile=\"%g\"} %.9g\n", quantiles[q], (double)phase_percentile(h, quantiles[q]) / 1e9);
+        }
+    }
+#ifdef SPELLINGBEE_ALLOC_PHASES
+    fprintf(out, "# HELP spellingbee_phase_allocations_total Heap allocations made in each phase.\n"
+                 "# TYPE spellingbee_phase_allocations_total counter\n");
+    for (size_t p = 0; p < ALLOC_PHASE_COUNT; ++p) {
+        fprintf(out, "spellingbee_phase_allocations_total{phase=\"%s\"} %llu\n", ALLOC_PHASE_NAMES[p],
+                (unsigned long long)g_phase_alloc_count[p]);
+    }
+    fprintf(out, "# HELP spellingbee_phase_allocated_bytes_total Heap bytes allocated in each phase.\n"
+                 "# TYPE spellingbee_phase_allocated_bytes_total counter\n");
+    for (size_t p = 0; p < ALLOC_PHASE_COUNT; ++p) {
+        fprintf(out, "spellingbee_phase_allocated_bytes_total{phase=\"%s\"} %llu\n", ALLOC_PHASE_NAMES[p],
+                (unsigned long long)g_phase_alloc_bytes[p]);
+    }
+#endif
+}
+
+static void phase_write_json(FILE *out) {
+    fprintf(out, "{\n  \"unit\": \"ms\",\n  \"phases\": [");
+    for (size_t i = 0; i < g_phase_histogram_count; ++i) {
+        const PhaseHistogram *h = &g_phase_histograms[i];
+        fprintf(out, "%s\n    {\"phase\": \"%s\", \"detail\": \"", i ? "," : "", h->phase);
+        phase_print_escaped(out, h->detail);
+        fprintf(out,
+                "\", \"count\": %llu, \"sum_ms\": %.6f, \"min_ms\": %.6f, \"mean_ms\": %.6f, \"p50_ms\": %.6f, "
+                "\"p90_ms\": %.6f, \"p99_ms\": %.6f, \"p999_ms\": %.6f, \"max_ms\": %.6f}",
+                (unsigned long long)h->count, (double)h->sum_ns / 1e6, (double)h->min_ns / 1e6,
+                h->count ? (double)h->sum_ns / 1e6 / (double)h->count : 0.0, (double)phase_percentile(h, 0.5) / 1e6,
+                (double)phase_percentile(h, 0.9) / 1e6, (double)phase_percentile(h, 0.99) / 1e6,
+                (double)phase_percentile(h, 0.999) / 1e6, (double)h->max_ns / 1e6);
+    }
+    fprintf(out, "\n  ]");
+#ifdef SPELLINGBEE_ALLOC_PHASES
+    fprintf(out, ",\n  \"allocations\": [");
+    for (size_t p = 0; p < ALLOC_PHASE_COUNT; ++p) {
+        fprintf(out, "%s\n    {\"phase\": \"%s\", \"count\": %llu, \"bytes\": %llu}", p ? "," : "",
+                ALLOC_PHASE_NAMES[p], (unsigned long long)g_phase_alloc_count[p],
+                (unsigned long long)g_phase_alloc_bytes[p]);
+    }
+    fprintf(out, "\n  ]");
+#endif
+    fprintf(out, "\n}\n");
+}
+
+// Each file is written beside its final name and renamed over it, so a scraper never reads
+// half a file.
+static void write_phase_metrics(void) {
+    if (!g_phase_metrics_enabled) return;
+    static const char *const extensions[] = {".prom", ".json"};
+    for (size_t f = 0; f < ARRAY_LEN(extensions); ++f) {
+        char path[PATH_MAX + 16], tmp[PATH_MAX + 32];
+        snprintf(path, sizeof(path), "%s%s", g_metrics_prefix, extensions[f]);
+        snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+        FILE *out = fopen(tmp, "w");
+        if (out) {
+            if (f == 0) phase_write_prometheus(out);
+            else phase_write_json(out);
+        }
+        if (!out || (ferror(out) | fclose(out)) != 0 || rename(tmp, path) != 0) {
+            log_at(LOG_LEVEL_WARN, "Could not write metrics to %s", path);
+        }
+    }
+}
+
+static void phase_metrics_poll(void) {
+    if (!g_metrics_dump_requested) return;
+    g_metrics_dump_requested = 0;
+    write_phase_metrics();
+}
+
+static void handle_metrics_signal(int sig) {
+    (void)sig;
+    g_metrics_dump_requested = 1;
+}
+
+// No SA_RESTART, so a prompt blocked in fgets wakes up and can write the files.
+static void enable_phase_metrics(const char *prefix) {
+    snprintf(g_metrics_prefix, sizeof(g_metrics_prefix), "%s", prefix);
+    g_phase_metrics_enabled = true;
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_metrics_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR1, &sa, NULL);
+    atexit(write_phase_metrics);
+}
+
+static void record_phase(const char *phase, const char *detail, uint64_t ns) {
+    if (!g_phase_metrics_enabled) return;
+    PhaseHistogram *h = NULL;
+    for (size_t i = 0; i < g_phase_histogram_count && !h; ++i) {
+        if (strcmp(g_phase_histograms[i].phase, phase) == 0 && strcmp(g_phase_histograms[i].detail, detail) == 0) {
+            h = &g_phase_histograms[i];
+        }
+    }
+    if (!h) {
+        if (g_phase_histogram_count == PHASE_MAX_HISTOGRAMS) return;
+        h = &g_phase_histograms[g_phase_histogram_count++];
+        snprintf(h->phase, sizeof(h->phase), "%s", phase);
+        snprintf(h->detail, sizeof(h->detail), "%s", detail);
+        h->min_ns = UINT64_MAX;
+    }
+    h->buckets[phase_bucket_index(ns)]++;
+    h->count++;
+    h->sum_ns += ns;
+    if (ns < h->min_ns) h->min_ns = ns;
+    if (ns > h->max_ns) h->max_ns = ns;
+    phase_metrics_poll();
+}
+
+// Records the time since `start_ns` (from monotonic_ns) as one sample of `phase`.
+static void record_phase_since(const char *phase, const char *detail, double start_ns) {
+    if (g_phase_metrics_enabled) record_phase(phase, detail, (uint64_t)(monotonic_ns() - start_ns));
+}
+
+// ---------- Trace timeline ----------
+// With --trace=FILE a run is also written as Chrome trace-event JSON, for chrome://tracing
+// or Perfetto. The port is single-threaded, so one "run" track nests each run_attempt, its
+// steps, every retry_with_pause attempt and backoff, and the HTTP requests each attempt
+// made. Waits at a prompt are in the "human" category, so time spent on the person at the
+// keyboard stands apart from machine time. Events stream to FILE.tmp as spans close; the
+// file is completed and renamed into place at exit.
+#define TRACE_RUN_TRACK 1
+
+typedef struct {
+    bool active;
+    const char *category;
+    double start_ns;
+    char name[112];
+    char args[384];  // JSON object members, comma separated
+    size_t args_len;
+} TraceSpan;
+
+static FILE *g_trace_file;
+static char g_trace_path[PATH_MAX];
+static double g_trace_origin_ns;
+
+static void trace_print_escaped(FILE *out, const char *text) {
+    for (const unsigned char *p = (const unsigned char *)text; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(out, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(out, "\\u%04x", *p);
+        } else {
+            fputc(*p, out);
+        }
+    }
+}
+
+static void finish_trace(void) {
+    if (!g_trace_file) return;
+    char tmp[PATH_MAX + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", g_trace_path);
+    fprintf(g_trace_file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    if ((ferror(g_trace_file) | fclose(g_trace_file)) != 0 || rename(tmp, g_trace_path) != 0) {
+        log_at(LOG_LEVEL_WARN, "Could not write the trace to %s", g_trace_path);
+    }
+    g_trace_file = NULL;
+}
+
+static void trace_begin(TraceSpan *span, const char *category, const char *name) {
+    span->active = g_trace_file != NULL;
+    if (!span->active) return;
+    span->category = category;
+    snprintf(span->name, sizeof(span->name), "%s", name ? name : "");
+    span->args[0] = '\0';
+    span->args_len = 0;
+    span->start_ns = monotonic_ns();
+}
+
+// Appends `"key":` and a value formatted by `fmt`; an argument that does not fit is dropped.
+static void trace_arg_format(TraceSpan *span, const char *key, const char *fmt, ...) {
+    if (!span->active) return;
+    size_t room = sizeof(span->args) - span->args_len;
+    int n = snprintf(span->args + span->args_len, room, "%s\"%s\":", span->args_len ? "," : "", key);
+    if (n < 0 || (size_t)n >= room) {
+        span->args[span->args_len] = '\0';
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int m = vsnprintf(span->args + span->args_len + (size_t)n, room - (size_t)n, fmt, ap);
+    va_end(ap);
+    if (m < 0 || (size_t)(n + m) >= room) {
+        span->args[span->args_len] = '\0';
+        return;
+    }
+    span->args_len += (size_t)(n + m);
+}
+
+static void trace_arg_long(TraceSpan *span, const char *key, long value) {
+    trace_arg_format(span, key, "%ld", value);
+}
+
+static void trace_arg_bool(TraceSpan *span, const char *key, bool value) {
+    trace_arg_format(span, key, "%s", value ? "true" : "false");
+}
+
+static void trace_arg_string(TraceSpan *span, const char *key, const char *value) {
+    if (!span->active) return;
+    char escaped[256];
+    json_escape_into(escaped, sizeof(escaped), value);
+    trace_arg_format(span, key, "\"%s\"", escaped);
+}
+
+static void trace_end(TraceSpan *span) {
+    if (!span->active || !g_trace_file) return;
+    const double end_ns = monotonic_ns();
+    fprintf(g_trace_file, ",\n{\"name\":\"");
+    trace_print_escaped(g_trace_file, span->name);
+    fprintf(g_trace_file, "\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%ld,\"tid\":%d",
+            span->category, (span->start_ns - g_trace_origin_ns) / 1e3, (end_ns - span->start_ns) / 1e3,
+            (long)getpid(), TRACE_RUN_TRACK);
+    if (span->args_len) fprintf(g_trace_file, ",\"args\":{%s}", span->args);
+    fputc('}', g_trace_file);
+    span->active = false;
+}
+
+// False, with errno set, when FILE.tmp cannot be created.
+static bool enable_trace(const char *path) {
+    char tmp[PATH_MAX + 8];
+    snprintf(g_trace_path, sizeof(g_trace_path), "%s", path);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", g_trace_path);
+    g_trace_file = fopen(tmp, "w");
+    if (!g_trace_file) return false;
+    g_trace_origin_ns = monotonic_ns();
+    fprintf(g_trace_file,
+            "{\"traceEvents\":[\n"
+            "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":0,\"args\":{\"name\":\"spellingbee\"}},\n"
+            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%d,\"args\":{\"name\":\"run\"}}",
+            (long)getpid(), (long)getpid(), TRACE_RUN_TRACK);
+    atexit(finish_trace);
+    return true;
+}
+
 // ---------- Utility helpers ----------
 
 static void set_error(char **err_out, const char *fmt, ...) {
@@ -171,12 +877,25 @@ static int string_buffer_append_format(StringBuffer *sb, const char *fmt, ...) {
     return 0;
 }
 
-static char *string_buffer_steal(StringBuffer *sb) {
-    char *result = sb->data;
-    sb->data = NULL;
-    sb->length = 0;
-    sb->capacity = 0;
-    return result;
+// Appends `text` as a quoted JSON string literal.
+static int string_buffer_append_json_string(StringBuffer *sb, const char *text) {
+    if (string_buffer_append_char(sb, '"') != 0) return -1;
+    for (const char *p = text; *p; ++p) {
+        unsigned char ch = (unsigned char)*p;
+        int rc;
+        if (ch == '"' || ch == '\\') {
+            rc = string_buffer_append_char(sb, '\\');
+            if (rc == 0) rc = string_buffer_append_char(sb, (char)ch);
+        } else if (ch == '\n') {
+            rc = string_buffer_append(sb, "\\n");
+        } else if (ch < 0x20) {
+            rc = string_buffer_append_format(sb, "\\u%04x", ch);
+        } else {
+            rc = string_buffer_append_char(sb, (char)ch);
+        }
+        if (rc != 0) return -1;
+    }
+    return string_buffer_append_char(sb, '"');
 }
 
 static void string_buffer_free(StringBuffer *sb) {
@@ -255,22 +974,42 @@ static void trim_inplace(char *s) {
     }
 }
 
-static bool contains_vowel(const char *word) {
-    static const char vowels[] = "aeiouy";
-    if (!word) return false;
-    for (; *word; ++word) {
-        if (strchr(vowels, (char)tolower((unsigned char)*word))) {
-            return true;
-        }
+static int word_changes_append(WordChanges *changes, const char *word, bool present) {
+    if (changes->size == changes->capacity) {
+        size_t new_cap = changes->capacity ? changes->capacity * 2 : 64;
+        WordChange *items = (WordChange *)realloc(changes->items, new_cap * sizeof(WordChange));
+        if (!items) return -1;
+        changes->items = items;
+        changes->capacity = new_cap;
     }
-    return false;
+    char *copy = strdup(word);
+    if (!copy) return -1;
+    changes->items[changes->size] = (WordChange){copy, changes->size, present};
+    changes->size++;
+    return 0;
+}
+
+static void word_changes_free(WordChanges *changes) {
+    for (size_t i = 0; i < changes->size; ++i) free(changes->items[i].word);
+    free(changes->items);
+    changes->items = NULL;
+    changes->size = 0;
+    changes->capacity = 0;
 }
 
-static bool letters_contains(const char *letters, char c) {
-    for (const char *p = letters; *p; ++p) {
-        if (*p == c) return true;
+// Appends each word of the comma-separated `list`, trimmed and lowercased; empty ones are skipped.
+static int parse_word_changes_arg(const char *list, bool present, WordChanges *changes) {
+    char *copy = strdup(list);
+    if (!copy) return -1;
+    int rc = 0;
+    char *save = NULL;
+    for (char *word = strtok_r(copy, ",", &save); word && rc == 0; word = strtok_r(NULL, ",", &save)) {
+        trim_inplace(word);
+        to_lower_inplace(word);
+        if (word[0] != '\0') rc = word_changes_append(changes, word, present);
     }
-    return false;
+    free(copy);
+    return rc;
 }
 
 static void pause_banner(const char *reason) {
@@ -284,82 +1023,526 @@ static void pause_banner(const char *reason) {
 
 static void prompt_line(const char *prompt, char *buffer, size_t buffer_size) {
     if (!buffer || buffer_size == 0) return;
+    TraceSpan span;
+    trace_begin(&span, "human", "waiting for input");
+    trace_arg_string(&span, "prompt", prompt + strspn(prompt, " \n"));
     printf("%s", prompt);
     fflush(stdout);
-    if (!fgets(buffer, (int)buffer_size, stdin)) {
+    while (!fgets(buffer, (int)buffer_size, stdin)) {
         buffer[0] = '\0';
+        const bool interrupted = errno == EINTR && ferror(stdin);
         clearerr(stdin);
-        return;
+        if (!interrupted) break;
+        phase_metrics_poll();
     }
+    trace_end(&span);
     size_t len = strlen(buffer);
     if (len > 0 && buffer[len - 1] == '\n') {
         buffer[len - 1] = '\0';
     }
 }
 
-// ---------- CURL helpers ----------
+// ---------- JSON helpers ----------
+// A small scanner over JSON text. It walks the document without building a tree and
+// returns pointers into the original buffer, so pulling one field out copies only that
+// field. Keys only match in key position, never inside string values, and strings are
+// decoded (escapes, \uXXXX and surrogate pairs) when extracted.
 
-static size_t http_write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t total = size * nmemb;
-    HttpResponse *resp = (HttpResponse *)userp;
-    char *ptr = (char *)realloc(resp->body, resp->body_size + total + 1);
-    if (!ptr) return 0;
-    resp->body = ptr;
-    memcpy(resp->body + resp->body_size, contents, total);
-    resp->body_size += total;
-    resp->body[resp->body_size] = '\0';
-    return total;
-}
+#define JSON_MAX_DEPTH 64
 
-static int http_response_init(HttpResponse *resp) {
-    resp->status = 0;
-    resp->body_size = 0;
-    resp->body = (char *)malloc(1);
-    if (!resp->body) return -1;
-    resp->body[0] = '\0';
-    return 0;
+static const char *json_skip_ws(const char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    return p;
 }
 
-static void http_response_cleanup(HttpResponse *resp) {
-    free(resp->body);
-    resp->body = NULL;
-    resp->body_size = 0;
-    resp->status = 0;
+// `p` at '"': returns the position after the closing quote, or NULL.
+static const char *json_skip_string(const char *p) {
+    if (*p != '"') return NULL;
+    for (p++; *p; p++) {
+        if (*p == '\\') {
+            if (!p[1]) return NULL;
+            p++;
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    return NULL;
 }
 
-static int curl_session_init(CurlSession *s, char **err_out) {
-    s->curl = curl_easy_init();
-    if (!s->curl) {
-        set_error(err_out, "curl_easy_init failed");
-        return -1;
+static const char *json_skip_value(const char *p, int depth) {
+    p = json_skip_ws(p);
+    if (depth > JSON_MAX_DEPTH) return NULL;
+    if (*p == '"') return json_skip_string(p);
+    if (*p == '{' || *p == '[') {
+        char close = *p == '{' ? '}' : ']';
+        p = json_skip_ws(p + 1);
+        if (*p == close) return p + 1;
+        for (;;) {
+            if (close == '}') {
+                p = json_skip_string(json_skip_ws(p));
+                if (!p) return NULL;
+                p = json_skip_ws(p);
+                if (*p != ':') return NULL;
+                p++;
+            }
+            p = json_skip_value(p, depth + 1);
+            if (!p) return NULL;
+            p = json_skip_ws(p);
+            if (*p == ',') {
+                p++;
+                continue;
+            }
+            return *p == close ? p + 1 : NULL;
+        }
     }
-    s->headers = NULL;
-    curl_easy_setopt(s->curl, CURLOPT_TCP_KEEPALIVE, 1L);
-    curl_easy_setopt(s->curl, CURLOPT_TCP_KEEPIDLE, 30L);
-    curl_easy_setopt(s->curl, CURLOPT_TCP_KEEPINTVL, 15L);
-    curl_easy_setopt(s->curl, CURLOPT_TIMEOUT, 60L);
-    curl_easy_setopt(s->curl, CURLOPT_WRITEFUNCTION, http_write_callback);
-    s->headers = curl_slist_append(s->headers, "Content-Type: application/json");
-    if (!s->headers) {
-        set_error(err_out, "failed to append HTTP header");
-        return -1;
+    const char *start = p;
+    while (*p && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') p++;
+    return p > start ? p : NULL;
+}
+
+static int json_hex4(const char *p, unsigned long *out) {
+    unsigned long cp = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = p[i];
+        cp <<= 4;
+        if (c >= '0' && c <= '9') cp |= (unsigned long)(c - '0');
+        else if (c >= 'a' && c <= 'f') cp |= (unsigned long)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') cp |= (unsigned long)(c - 'A' + 10);
+        else return -1;
     }
-    curl_easy_setopt(s->curl, CURLOPT_HTTPHEADER, s->headers);
+    *out = cp;
     return 0;
 }
 
-static void curl_session_cleanup(CurlSession *s) {
-    if (s->headers) {
-        curl_slist_free_all(s->headers);
-        s->headers = NULL;
-    }
-    if (s->curl) {
-        curl_easy_cleanup(s->curl);
-        s->curl = NULL;
+// Decodes the string literal at `p` (at its opening quote) into `out`, which must hold at
+// least as many bytes as the literal: decoding never grows it. Returns the decoded length,
+// or -1 for a malformed literal.
+static long json_decode_string_into(const char *p, char *out) {
+    if (*p != '"') return -1;
+    size_t len = 0;
+    for (p++; *p != '"'; p++) {
+        if (!*p) return -1;
+        if (*p != '\\') {
+            out[len++] = *p;
+            continue;
+        }
+        p++;
+        switch (*p) {
+            case '"': out[len++] = '"'; break;
+            case '\\': out[len++] = '\\'; break;
+            case '/': out[len++] = '/'; break;
+            case 'b': out[len++] = '\b'; break;
+            case 'f': out[len++] = '\f'; break;
+            case 'n': out[len++] = '\n'; break;
+            case 'r': out[len++] = '\r'; break;
+            case 't': out[len++] = '\t'; break;
+            case 'u': {
+                unsigned long cp = 0;
+                if (json_hex4(p + 1, &cp) != 0) return -1;
+                p += 4;
+                unsigned long low = 0;
+                if (cp >= 0xD800 && cp <= 0xDBFF && p[1] == '\\' && p[2] == 'u' && json_hex4(p + 3, &low) == 0 &&
+                    low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+                if (cp < 0x80) {
+                    out[len++] = (char)cp;
+                } else if (cp < 0x800) {
+                    out[len++] = (char)(0xC0 | (cp >> 6));
+                    out[len++] = (char)(0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    out[len++] = (char)(0xE0 | (cp >> 12));
+                    out[len++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    out[len++] = (char)(0x80 | (cp & 0x3F));
+                } else {
+                    out[len++] = (char)(0xF0 | (cp >> 18));
+                    out[len++] = (char)(0x80 | ((cp >> 12) & 0x3F));
+                    out[len++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    out[len++] = (char)(0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default: return -1;
+        }
     }
+    out[len] = '\0';
+    return (long)len;
 }
 
-static int curl_session_request(CurlSession *s,
+// Allocates and decodes the string literal at `p`.
+static bool json_decode_string(const char *p, char **out_value) {
+    const char *end = json_skip_string(p);
+    if (!end) return false;
+    char *value = (char *)malloc((size_t)(end - p));
+    if (!value) return false;
+    if (json_decode_string_into(p, value) < 0) {
+        free(value);
+        return false;
+    }
+    *out_value = value;
+    return true;
+}
+
+// Whether the key literal at `p` (at its opening quote, ending before `end`) equals `key`.
+static bool json_key_equals(const char *p, const char *end, const char *key) {
+    size_t raw_len = (size_t)(end - p) - 2;
+    if (!memchr(p + 1, '\\', raw_len)) return strlen(key) == raw_len && strncmp(p + 1, key, raw_len) == 0;
+    char decoded[256];
+    if (raw_len + 1 > sizeof(decoded)) return false;
+    return json_decode_string_into(p, decoded) >= 0 && strcmp(decoded, key) == 0;
+}
+
+// `p` at '{': the value of member `key`, or NULL.
+static const char *json_object_member(const char *p, const char *key) {
+    if (*p != '{') return NULL;
+    p = json_skip_ws(p + 1);
+    while (*p == '"') {
+        const char *key_end = json_skip_string(p);
+        if (!key_end) return NULL;
+        bool match = json_key_equals(p, key_end, key);
+        p = json_skip_ws(key_end);
+        if (*p != ':') return NULL;
+        p = json_skip_ws(p + 1);
+        if (match) return p;
+        p = json_skip_value(p, 1);
+        if (!p) return NULL;
+        p = json_skip_ws(p);
+        if (*p != ',') return NULL;
+        p = json_skip_ws(p + 1);
+    }
+    return NULL;
+}
+
+// The value at `path` (object keys from the root), or NULL.
+static const char *json_find_path(const char *json, const char *const *path, size_t depth) {
+    const char *p = json_skip_ws(json);
+    for (size_t i = 0; i < depth && p; ++i) p = json_object_member(p, path[i]);
+    return p;
+}
+
+// The value of the first member named `key` at any depth, in document order, or NULL.
+static const char *json_find_key_at(const char *p, const char *key, int depth) {
+    p = json_skip_ws(p);
+    if (depth > JSON_MAX_DEPTH || (*p != '{' && *p != '[')) return NULL;
+    bool object = *p == '{';
+    char close = object ? '}' : ']';
+    p = json_skip_ws(p + 1);
+    if (*p == close) return NULL;
+    for (;;) {
+        if (object) {
+            const char *key_end = json_skip_string(p);
+            if (!key_end) return NULL;
+            bool match = json_key_equals(p, key_end, key);
+            p = json_skip_ws(key_end);
+            if (*p != ':') return NULL;
+            p = json_skip_ws(p + 1);
+            if (match) return p;
+        }
+        const char *found = json_find_key_at(p, key, depth + 1);
+        if (found) return found;
+        p = json_skip_value(p, depth + 1);
+        if (!p) return NULL;
+        p = json_skip_ws(p);
+        if (*p != ',') return NULL;
+        p = json_skip_ws(p + 1);
+    }
+}
+
+static const char *json_find_key_value(const char *json, const char *key) {
+    return json_find_key_at(json, key, 0);
+}
+
+static bool json_extract_string(const char *json,
+                                const char *key,
+                                char **out_value) {
+    const char *pos = json_find_key_value(json, key);
+    return pos && json_decode_string(pos, out_value);
+}
+
+// The string at `path`; a null there gives *out_value = NULL.
+static bool json_extract_path_string(const char *json, const char *const *path, size_t depth, char **out_value) {
+    const char *pos = json_find_path(json, path, depth);
+    if (!pos) return false;
+    if (strncmp(pos, "null", 4) == 0) {
+        *out_value = NULL;
+        return true;
+    }
+    AllocPhase saved_phase = alloc_phase_enter(ALLOC_PHASE_RESPONSE);
+    bool ok = json_decode_string(pos, out_value);
+    alloc_phase_leave(saved_phase);
+    return ok;
+}
+
+// The top-level "value" member as a string; null gives *out_value = NULL.
+static bool json_extract_value_string(const char *json, char **out_value) {
+    static const char *const path[] = {"value"};
+    return json_extract_path_string(json, path, 1, out_value);
+}
+
+static bool json_extract_long(const char *json, const char *key, long *out_value) {
+    const char *pos = json_find_key_value(json, key);
+    if (!pos) return false;
+    char *end = NULL;
+    long value = strtol(pos, &end, 10);
+    if (end == pos) return false;
+    *out_value = value;
+    return true;
+}
+
+static bool json_extract_bool(const char *json, const char *key, bool *out_value) {
+    const char *pos = json_find_key_value(json, key);
+    if (!pos) return false;
+    if (strncmp(pos, "true", 4) == 0) {
+        *out_value = true;
+        return true;
+    }
+    if (strncmp(pos, "false", 5) == 0) {
+        *out_value = false;
+        return true;
+    }
+    return false;
+}
+
+// ---------- CURL helpers ----------
+
+static size_t http_write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t total = size * nmemb;
+    HttpResponse *resp = (HttpResponse *)userp;
+    size_t needed = resp->body_size + total + 1;
+    if (needed > resp->body_capacity) {
+        size_t capacity = resp->body_capacity ? resp->body_capacity : 256;
+        while (capacity < needed) capacity *= 2;
+        char *ptr = (char *)realloc(resp->body, capacity);
+        if (!ptr) return 0;
+        resp->body = ptr;
+        resp->body_capacity = capacity;
+    }
+    memcpy(resp->body + resp->body_size, contents, total);
+    resp->body_size += total;
+    resp->body[resp->body_size] = '\0';
+    return total;
+}
+
+static int http_response_init(HttpResponse *resp, CurlSession *pool) {
+    resp->status = 0;
+    resp->body_size = 0;
+    resp->pool = pool;
+    if (pool->spare_body) {
+        resp->body = pool->spare_body;
+        resp->body_capacity = pool->spare_capacity;
+        pool->spare_body = NULL;
+        pool->spare_capacity = 0;
+    } else {
+        resp->body_capacity = 256;
+        resp->body = (char *)malloc(resp->body_capacity);
+        if (!resp->body) return -1;
+    }
+    resp->body[0] = '\0';
+    return 0;
+}
+
+static void http_response_cleanup(HttpResponse *resp) {
+    if (resp->body && resp->pool && !resp->pool->spare_body) {
+        resp->pool->spare_body = resp->body;
+        resp->pool->spare_capacity = resp->body_capacity;
+    } else {
+        free(resp->body);
+    }
+    resp->body = NULL;
+    resp->body_size = 0;
+    resp->body_capacity = 0;
+    resp->status = 0;
+}
+
+// ---------- Transport tuning ----------
+// Per-request timeouts: reads fail fast so a retry can start, navigation and new sessions
+// get the time Chrome needs, and typing or script calls may run long.
+
+#define READ_TIMEOUT_MS 10000L
+#define COMMAND_TIMEOUT_MS 30000L
+#define NAVIGATION_TIMEOUT_MS 60000L
+#define INPUT_TIMEOUT_MS 120000L
+
+static bool url_ends_with(const char *url, const char *suffix) {
+    size_t url_len = strlen(url);
+    size_t suffix_len = strlen(suffix);
+    return url_len >= suffix_len && strcmp(url + url_len - suffix_len, suffix) == 0;
+}
+
+static long request_timeout_ms(const char *method, const char *url) {
+    if (url_ends_with(url, "/actions") || url_ends_with(url, "/execute/sync") || url_ends_with(url, "/value")) {
+        return INPUT_TIMEOUT_MS;
+    }
+    if (strcmp(method, "POST") == 0 && (url_ends_with(url, "/session") || url_ends_with(url, "/url"))) {
+        return NAVIGATION_TIMEOUT_MS;
+    }
+    if (strcmp(method, "GET") == 0) return READ_TIMEOUT_MS;
+    return COMMAND_TIMEOUT_MS;
+}
+
+// The request path with session and element ids masked, so calls to one endpoint aggregate.
+static void endpoint_label(const char *method, const char *url, char *out, size_t out_size) {
+    const char *scheme = strstr(url, "://");
+    const char *path = strchr(scheme ? scheme + 3 : url, '/');
+    size_t len = (size_t)snprintf(out, out_size, "%s ", method);
+    bool mask_next = false;
+    while (path && *path == '/' && len + 1 < out_size) {
+        const char *segment = path + 1;
+        const char *end = strchr(segment, '/');
+        size_t segment_len = end ? (size_t)(end - segment) : strlen(segment);
+        if (mask_next) {
+            len += (size_t)snprintf(out + len, out_size - len, "/{id}");
+        } else {
+            len += (size_t)snprintf(out + len, out_size - len, "/%.*s", (int)segment_len, segment);
+        }
+        mask_next = !mask_next && ((segment_len == 7 && strncmp(segment, "session", 7) == 0) ||
+                                   (segment_len == 7 && strncmp(segment, "element", 7) == 0));
+        path = end;
+    }
+    if (len >= out_size) out[out_size - 1] = '\0';
+}
+
+static void transport_record(CurlSession *s, const char *method, const char *url, bool ok) {
+    char label[sizeof(s->endpoints[0].label)];
+    endpoint_label(method, url, label, sizeof(label));
+    TransportEndpoint *e = NULL;
+    for (size_t i = 0; i < s->endpoint_count && !e; ++i) {
+        if (strcmp(s->endpoints[i].label, label) == 0) e = &s->endpoints[i];
+    }
+    if (!e) {
+        if (s->endpoint_count == TRANSPORT_MAX_ENDPOINTS) return;
+        e = &s->endpoints[s->endpoint_count++];
+        memset(e, 0, sizeof(*e));
+        snprintf(e->label, sizeof(e->label), "%s", label);
+    }
+    curl_off_t total_us = 0, connect_us = 0, first_byte_us = 0, sent = 0, received = 0;
+    curl_easy_getinfo(s->curl, CURLINFO_TOTAL_TIME_T, &total_us);
+    record_phase("webdriver", label, (uint64_t)total_us * 1000);
+    curl_easy_getinfo(s->curl, CURLINFO_CONNECT_TIME_T, &connect_us);
+    curl_easy_getinfo(s->curl, CURLINFO_STARTTRANSFER_TIME_T, &first_byte_us);
+    curl_easy_getinfo(s->curl, CURLINFO_SIZE_UPLOAD_T, &sent);
+    curl_easy_getinfo(s->curl, CURLINFO_SIZE_DOWNLOAD_T, &received);
+    e->calls++;
+    if (!ok) e->failures++;
+    e->total_ms += (double)total_us / 1000.0;
+    if ((double)total_us / 1000.0 > e->max_ms) e->max_ms = (double)total_us / 1000.0;
+    e->connect_ms += (double)connect_us / 1000.0;
+    e->first_byte_ms += (double)first_byte_us / 1000.0;
+    e->bytes_sent += sent;
+    e->bytes_received += received;
+}
+
+static void transport_print_stats(const CurlSession *s, FILE *out) {
+    if (s->endpoint_count == 0) return;
+    fprintf(out, "Transport (calls, failures, mean/max ms, mean first byte ms, connect ms, bytes out/in):\n");
+    for (size_t i = 0; i < s->endpoint_count; ++i) {
+        const TransportEndpoint *e = &s->endpoints[i];
+        fprintf(out, "  %-52s%6zu%4zu%9.1f%9.1f%9.1f%9.1f%10" CURL_FORMAT_CURL_OFF_T "%10" CURL_FORMAT_CURL_OFF_T "\n",
+                e->label, e->calls, e->failures, e->total_ms / (double)e->calls, e->max_ms,
+                e->first_byte_ms / (double)e->calls, e->connect_ms, e->bytes_sent, e->bytes_received);
+    }
+}
+
+// ---------- Traffic recording ----------
+// --record=FILE writes one JSON line per WebDriver request: when it started (ms since the
+// recording began), method, URL, payload, status, latency and the raw response body, for
+// tools/replay_webdriver.py to serve back with the same timings.
+
+static int curl_session_start_recording(CurlSession *s, const char *path, char **err_out) {
+    s->record = fopen(path, "w");
+    if (!s->record) {
+        set_error(err_out, "cannot write recording to %s: %s", path, strerror(errno));
+        return -1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &s->record_start);
+    return 0;
+}
+
+// `resp` is NULL, and the status 0, when the transfer failed below HTTP.
+static void traffic_record(CurlSession *s, const char *method, const char *url, const char *payload,
+                           CURLcode code, const HttpResponse *resp) {
+    curl_off_t total_us = 0;
+    long status = 0;
+    curl_easy_getinfo(s->curl, CURLINFO_TOTAL_TIME_T, &total_us);
+    if (code == CURLE_OK) curl_easy_getinfo(s->curl, CURLINFO_RESPONSE_CODE, &status);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double finished_ms = (double)(now.tv_sec - s->record_start.tv_sec) * 1000.0 +
+                         (double)(now.tv_nsec - s->record_start.tv_nsec) / 1e6;
+    if (!payload) payload = "";
+    StringBuffer line;
+    string_buffer_init(&line);
+    int rc = string_buffer_append_format(&line, "{\"t_ms\":%.3f,\"method\":", finished_ms - (double)total_us / 1000.0);
+    if (rc == 0) rc = string_buffer_append_json_string(&line, method);
+    if (rc == 0) rc = string_buffer_append(&line, ",\"url\":");
+    if (rc == 0) rc = string_buffer_append_json_string(&line, url);
+    if (rc == 0) rc = string_buffer_append_format(&line, ",\"request_bytes\":%zu,\"payload\":", strlen(payload));
+    if (rc == 0) rc = string_buffer_append_json_string(&line, payload);
+    if (rc == 0) {
+        rc = string_buffer_append_format(&line, ",\"status\":%ld,\"latency_ms\":%.3f,\"response\":", status,
+                                         (double)total_us / 1000.0);
+    }
+    if (rc == 0) rc = string_buffer_append_json_string(&line, resp && resp->body_size ? resp->body : "");
+    if (rc == 0 && code != CURLE_OK) {
+        rc = string_buffer_append(&line, ",\"error\":");
+        if (rc == 0) rc = string_buffer_append_json_string(&line, curl_easy_strerror(code));
+    }
+    if (rc == 0) rc = string_buffer_append(&line, "}\n");
+    if (rc == 0) fputs(line.data, s->record);
+    string_buffer_free(&line);
+}
+
+static int curl_session_init(CurlSession *s, char **err_out) {
+    s->curl = curl_easy_init();
+    if (!s->curl) {
+        set_error(err_out, "curl_easy_init failed");
+        return -1;
+    }
+    s->headers = NULL;
+    s->last_code = CURLE_OK;
+    s->last_status = 0;
+    s->last_error[0] = '\0';
+    s->spare_body = NULL;
+    s->spare_capacity = 0;
+    s->timeout_override_ms = 0;
+    s->endpoint_count = 0;
+    s->record = NULL;
+    curl_easy_setopt(s->curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(s->curl, CURLOPT_TCP_KEEPIDLE, 30L);
+    curl_easy_setopt(s->curl, CURLOPT_TCP_KEEPINTVL, 15L);
+    curl_easy_setopt(s->curl, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(s->curl, CURLOPT_WRITEFUNCTION, http_write_callback);
+    s->headers = curl_slist_append(s->headers, "Content-Type: application/json");
+    // Without an empty Expect: curl sends "Expect: 100-continue" on large POST bodies (the
+    // /actions payload) and waits up to a second for a 100 response chromedriver never sends.
+    if (s->headers) s->headers = curl_slist_append(s->headers, "Expect:");
+    if (!s->headers) {
+        set_error(err_out, "failed to append HTTP header");
+        return -1;
+    }
+    curl_easy_setopt(s->curl, CURLOPT_HTTPHEADER, s->headers);
+    return 0;
+}
+
+static void curl_session_cleanup(CurlSession *s) {
+    if (s->record) {
+        fclose(s->record);
+        s->record = NULL;
+    }
+    free(s->spare_body);
+    s->spare_body = NULL;
+    if (s->headers) {
+        curl_slist_free_all(s->headers);
+        s->headers = NULL;
+    }
+    if (s->curl) {
+        curl_easy_cleanup(s->curl);
+        s->curl = NULL;
+    }
+}
+
+static int curl_session_request(CurlSession *s,
                                 const char *method,
                                 const char *url,
                                 const char *payload,
@@ -369,11 +1552,13 @@ static int curl_session_request(CurlSession *s,
         set_error(err_out, "curl session not initialised");
         return -1;
     }
-    if (http_response_init(out_resp) != 0) {
+    if (http_response_init(out_resp, s) != 0) {
         set_error(err_out, "out of memory allocating HTTP response");
         return -1;
     }
     curl_easy_setopt(s->curl, CURLOPT_URL, url);
+    curl_easy_setopt(s->curl, CURLOPT_TIMEOUT_MS,
+                     s->timeout_override_ms > 0 ? s->timeout_override_ms : request_timeout_ms(method, url));
     curl_easy_setopt(s->curl, CURLOPT_WRITEDATA, out_resp);
     curl_easy_setopt(s->curl, CURLOPT_HTTPGET, 0L);
     curl_easy_setopt(s->curl, CURLOPT_CUSTOMREQUEST, NULL);
@@ -403,58 +1588,47 @@ static int curl_session_request(CurlSession *s,
         }
     }
 
+    TraceSpan span;
+    trace_begin(&span, "http", NULL);
+    if (span.active) endpoint_label(method, url, span.name, sizeof(span.name));
+    AllocPhase saved_phase = alloc_phase_enter(ALLOC_PHASE_RESPONSE);
     CURLcode code = curl_easy_perform(s->curl);
+    transport_record(s, method, url, code == CURLE_OK);
+    s->last_code = code;
+    s->last_status = 0;
+    s->last_error[0] = '\0';
     if (code != CURLE_OK) {
+        trace_arg_string(&span, "error", curl_easy_strerror(code));
+        trace_end(&span);
+        if (s->record) traffic_record(s, method, url, payload, code, NULL);
         set_error(err_out, "CURL error: %s", curl_easy_strerror(code));
         http_response_cleanup(out_resp);
+        alloc_phase_leave(saved_phase);
         return -1;
     }
     curl_easy_getinfo(s->curl, CURLINFO_RESPONSE_CODE, &out_resp->status);
-    return 0;
-}
-
-// ---------- JSON helpers ----------
-
-static bool json_extract_string(const char *json,
-                                const char *key,
-                                char **out_value) {
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\":\"", key);
-    const char *pos = strstr(json, pattern);
-    if (!pos) return false;
-    pos += strlen(pattern);
-    const char *end = strchr(pos, '"');
-    if (!end) return false;
-    size_t len = (size_t)(end - pos);
-    char *value = (char *)malloc(len + 1);
-    if (!value) return false;
-    memcpy(value, pos, len);
-    value[len] = '\0';
-    *out_value = value;
-    return true;
-}
-
-static bool json_extract_value_string(const char *json, char **out_value) {
-    const char *pattern = "\"value\":";
-    const char *pos = strstr(json, pattern);
-    if (!pos) return false;
-    pos += strlen(pattern);
-    while (*pos && isspace((unsigned char)*pos)) pos++;
-    if (strncmp(pos, "null", 4) == 0) {
-        *out_value = NULL;
-        return true;
+    if (span.active) {
+        long new_connections = 0;
+        curl_easy_getinfo(s->curl, CURLINFO_NUM_CONNECTS, &new_connections);
+        trace_arg_long(&span, "status", out_resp->status);
+        trace_arg_long(&span, "bytes_out", payload ? (long)strlen(payload) : 0L);
+        trace_arg_long(&span, "bytes_in", (long)out_resp->body_size);
+        trace_arg_bool(&span, "new_connection", new_connections > 0);
+        trace_end(&span);
     }
-    if (*pos != '"') return false;
-    pos++;
-    const char *end = strchr(pos, '"');
-    if (!end) return false;
-    size_t len = (size_t)(end - pos);
-    char *value = (char *)malloc(len + 1);
-    if (!value) return false;
-    memcpy(value, pos, len);
-    value[len] = '\0';
-    *out_value = value;
-    return true;
+    if (s->record) traffic_record(s, method, url, payload, code, out_resp);
+    s->last_status = out_resp->status;
+    if ((out_resp->status < 200 || out_resp->status >= 300) && out_resp->body) {
+        // W3C error bodies look like {"value":{"error":"stale element reference",...}}.
+        static const char *const error_path[] = {"value", "error"};
+        char *error = NULL;
+        if (json_extract_path_string(out_resp->body, error_path, 2, &error) && error) {
+            snprintf(s->last_error, sizeof(s->last_error), "%s", error);
+        }
+        free(error);
+    }
+    alloc_phase_leave(saved_phase);
+    return 0;
 }
 
 // ---------- WebDriver helpers ----------
@@ -506,8 +1680,9 @@ static int wd_new_session(WD *wd, char **err_out) {
         return -1;
     }
 
+    static const char *const session_id_path[] = {"value", "sessionId"};
     char *session_id = NULL;
-    if (!json_extract_string(resp.body, "sessionId", &session_id)) {
+    if (!json_extract_path_string(resp.body, session_id_path, 2, &session_id) || !session_id) {
         set_error(err_out, "failed to parse sessionId from response: %s", resp.body ? resp.body : "(null)");
         http_response_cleanup(&resp);
         return -1;
@@ -577,6 +1752,45 @@ static int wd_navigate(WD *wd, const char *target, char **err_out) {
     return 0;
 }
 
+static int wd_current_url(WD *wd, char **out_url, char **err_out) {
+    if (!wd_has_session(wd)) {
+        set_error(err_out, "cannot query URL without active session");
+        return -1;
+    }
+    StringBuffer url;
+    string_buffer_init(&url);
+    if (string_buffer_append(&url, wd->base) != 0 ||
+        string_buffer_append(&url, "/session/") != 0 ||
+        string_buffer_append(&url, wd->session_id) != 0 ||
+        string_buffer_append(&url, "/url") != 0) {
+        set_error(err_out, "out of memory building URL query");
+        string_buffer_free(&url);
+        return -1;
+    }
+    HttpResponse resp;
+    int rc = curl_session_request(wd->session, "GET", url.data, NULL, &resp, err_out);
+    string_buffer_free(&url);
+    if (rc != 0) return -1;
+    if (resp.status < 200 || resp.status >= 300) {
+        set_error(err_out, "HTTP %ld getting current URL: %s", resp.status, resp.body ? resp.body : "");
+        http_response_cleanup(&resp);
+        return -1;
+    }
+    char *value = NULL;
+    if (!json_extract_value_string(resp.body, &value)) {
+        set_error(err_out, "failed to parse current URL: %s", resp.body ? resp.body : "");
+        http_response_cleanup(&resp);
+        return -1;
+    }
+    *out_url = value ? value : strdup("");
+    http_response_cleanup(&resp);
+    if (!*out_url) {
+        set_error(err_out, "out of memory duplicating URL");
+        return -1;
+    }
+    return 0;
+}
+
 static int wd_set_window_size(WD *wd, int width, int height, char **err_out) {
     if (!wd_has_session(wd)) {
         set_error(err_out, "cannot resize window without active session");
@@ -649,30 +1863,13 @@ static int wd_find_element_id_css(WD *wd, const char *css_selector, char **out_e
         http_response_cleanup(&resp);
         return -1;
     }
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "\"%s\":\"", WD_ELEMENT_KEY);
-    const char *pos = strstr(resp.body, pattern);
-    if (!pos) {
+    static const char *const id_path[] = {"value", WD_ELEMENT_KEY};
+    char *value = NULL;
+    if (!json_extract_path_string(resp.body, id_path, 2, &value) || !value) {
         set_error(err_out, "element response missing id: %s", resp.body ? resp.body : "");
         http_response_cleanup(&resp);
         return -1;
     }
-    pos += strlen(pattern);
-    const char *end = strchr(pos, '"');
-    if (!end) {
-        set_error(err_out, "element id string not terminated");
-        http_response_cleanup(&resp);
-        return -1;
-    }
-    size_t len = (size_t)(end - pos);
-    char *value = (char *)malloc(len + 1);
-    if (!value) {
-        set_error(err_out, "out of memory copying element id");
-        http_response_cleanup(&resp);
-        return -1;
-    }
-    memcpy(value, pos, len);
-    value[len] = '\0';
     *out_elem_id = value;
     http_response_cleanup(&resp);
     return 0;
@@ -801,9 +1998,12 @@ static int wd_click_element(WD *wd, const char *elem_id, char **err_out) {
     return 0;
 }
 
-static int wd_send_all_words_as_keys(WD *wd, const WordList *words, char **err_out) {
+// Runs `script` via execute/sync with no arguments; on success *out_body holds the raw
+// response body (caller frees).
+// `args_json` is the JSON array passed to the script as `arguments`.
+static int wd_execute_script_args(WD *wd, const char *script, const char *args_json, char **out_body, char **err_out) {
     if (!wd_has_session(wd)) {
-        set_error(err_out, "cannot send keys without active session");
+        set_error(err_out, "cannot execute script without active session");
         return -1;
     }
     StringBuffer url;
@@ -811,68 +2011,124 @@ static int wd_send_all_words_as_keys(WD *wd, const WordList *words, char **err_o
     if (string_buffer_append(&url, wd->base) != 0 ||
         string_buffer_append(&url, "/session/") != 0 ||
         string_buffer_append(&url, wd->session_id) != 0 ||
-        string_buffer_append(&url, "/actions") != 0) {
-        set_error(err_out, "out of memory building actions URL");
+        string_buffer_append(&url, "/execute/sync") != 0) {
+        set_error(err_out, "out of memory building execute URL");
         string_buffer_free(&url);
         return -1;
     }
     StringBuffer payload;
     string_buffer_init(&payload);
-    if (string_buffer_append(&payload,
-                             "{\"actions\":[{\"type\":\"key\",\"id\":\"keyboard\",\"actions\":[") != 0) {
-        set_error(err_out, "out of memory starting actions payload");
+    if (string_buffer_append(&payload, "{\"script\":") != 0 ||
+        string_buffer_append_json_string(&payload, script) != 0 ||
+        string_buffer_append(&payload, ",\"args\":") != 0 ||
+        string_buffer_append(&payload, args_json) != 0 ||
+        string_buffer_append(&payload, "}") != 0) {
+        set_error(err_out, "out of memory building execute payload");
         string_buffer_free(&url);
         string_buffer_free(&payload);
         return -1;
     }
 
+    HttpResponse resp;
+    int rc = curl_session_request(wd->session, "POST", url.data, payload.data, &resp, err_out);
+    string_buffer_free(&url);
+    string_buffer_free(&payload);
+    if (rc != 0) return -1;
+    if (resp.status < 200 || resp.status >= 300) {
+        set_error(err_out, "HTTP %ld executing script: %s", resp.status, resp.body ? resp.body : "");
+        http_response_cleanup(&resp);
+        return -1;
+    }
+    *out_body = resp.body;
+    resp.body = NULL;
+    http_response_cleanup(&resp);
+    return 0;
+}
+
+static int wd_execute_script(WD *wd, const char *script, char **out_body, char **err_out) {
+    return wd_execute_script_args(wd, script, "[]", out_body, err_out);
+}
+
+// Appends the W3C actions body typing `words`, each followed by Enter, with a `pause_ms`
+// pause action between consecutive words.
+static int build_actions_payload(StringBuffer *payload, char *const *words, size_t count, int pause_ms) {
+    if (string_buffer_append(payload, "{\"actions\":[{\"type\":\"key\",\"id\":\"keyboard\",\"actions\":[") != 0) {
+        return -1;
+    }
     bool first = true;
-    for (size_t i = 0; i < words->size; ++i) {
-        const char *word = words->items[i];
+    for (size_t i = 0; i < count; ++i) {
+        const char *word = words[i];
+        if (pause_ms > 0 && i > 0) {
+            if (string_buffer_append_format(payload, ",{\"type\":\"pause\",\"duration\":%d}", pause_ms) != 0) {
+                return -1;
+            }
+        }
         for (size_t j = 0; word[j]; ++j) {
             if (!first) {
-                if (string_buffer_append(&payload, ",") != 0) goto payload_fail;
+                if (string_buffer_append(payload, ",") != 0) return -1;
             }
             first = false;
-            if (string_buffer_append_format(&payload,
+            if (string_buffer_append_format(payload,
                                             "{\"type\":\"keyDown\",\"value\":\"%c\"}",
-                                            word[j]) != 0) goto payload_fail;
-            if (string_buffer_append(&payload, ",") != 0) goto payload_fail;
-            if (string_buffer_append_format(&payload,
+                                            word[j]) != 0) return -1;
+            if (string_buffer_append(payload, ",") != 0) return -1;
+            if (string_buffer_append_format(payload,
                                             "{\"type\":\"keyUp\",\"value\":\"%c\"}",
-                                            word[j]) != 0) goto payload_fail;
+                                            word[j]) != 0) return -1;
         }
         if (!first) {
-            if (string_buffer_append(&payload, ",") != 0) goto payload_fail;
+            if (string_buffer_append(payload, ",") != 0) return -1;
         }
         first = false;
-        if (string_buffer_append(&payload,
+        if (string_buffer_append(payload,
                                  "{\"type\":\"keyDown\",\"value\":\"\\uE007\"},{\"type\":\"keyUp\",\"value\":\"\\uE007\"}") != 0) {
-            goto payload_fail;
+            return -1;
         }
     }
-    if (string_buffer_append(&payload, "]}]}") != 0) goto payload_fail;
+    return string_buffer_append(payload, "]}]}");
+}
 
-    {
-        HttpResponse resp;
-        int rc = curl_session_request(wd->session, "POST", url.data, payload.data, &resp, err_out);
+static int wd_send_words_as_keys(WD *wd, char *const *words, size_t count, int pause_ms, char **err_out) {
+    if (!wd_has_session(wd)) {
+        set_error(err_out, "cannot send keys without active session");
+        return -1;
+    }
+    StringBuffer url;
+    string_buffer_init(&url);
+    if (string_buffer_append(&url, wd->base) != 0 ||
+        string_buffer_append(&url, "/session/") != 0 ||
+        string_buffer_append(&url, wd->session_id) != 0 ||
+        string_buffer_append(&url, "/actions") != 0) {
+        set_error(err_out, "out of memory building actions URL");
+        string_buffer_free(&url);
+        return -1;
+    }
+    StringBuffer payload;
+    string_buffer_init(&payload);
+    const double payload_start = monotonic_ns();
+    AllocPhase saved_phase = alloc_phase_enter(ALLOC_PHASE_PAYLOAD);
+    int payload_rc = build_actions_payload(&payload, words, count, pause_ms);
+    alloc_phase_leave(saved_phase);
+    record_phase_since("payload_build", "actions", payload_start);
+    if (payload_rc != 0) {
+        set_error(err_out, "out of memory building actions payload");
         string_buffer_free(&url);
         string_buffer_free(&payload);
-        if (rc != 0) return -1;
-        if (resp.status < 200 || resp.status >= 300) {
-            set_error(err_out, "HTTP %ld sending key actions: %s", resp.status, resp.body ? resp.body : "");
-            http_response_cleanup(&resp);
-            return -1;
-        }
-        http_response_cleanup(&resp);
-        return 0;
+        return -1;
     }
 
-payload_fail:
-    set_error(err_out, "out of memory building actions payload");
+    HttpResponse resp;
+    int rc = curl_session_request(wd->session, "POST", url.data, payload.data, &resp, err_out);
     string_buffer_free(&url);
     string_buffer_free(&payload);
-    return -1;
+    if (rc != 0) return -1;
+    if (resp.status < 200 || resp.status >= 300) {
+        set_error(err_out, "HTTP %ld sending key actions: %s", resp.status, resp.body ? resp.body : "");
+        http_response_cleanup(&resp);
+        return -1;
+    }
+    http_response_cleanup(&resp);
+    return 0;
 }
 
 // ---------- Game helpers ----------
@@ -903,15 +2159,24 @@ static bool has_class_token(const char *classes, const char *token) {
 }
 
 static void dump_cell_debug(const HiveCell *cells, size_t count) {
-    fprintf(stderr, "[DEBUG] Hive cell attributes:\n");
+    if (!log_enabled(LOG_LEVEL_DEBUG)) return;
     for (size_t i = 0; i < count; ++i) {
-        fprintf(stderr,
-                "  #%zu letter='%c' center=%s classes='%s' aria='%s'\n",
-                i + 1,
-                cells[i].letter,
-                cells[i].marked_center ? "true" : "false",
-                cells[i].class_attr ? cells[i].class_attr : "",
-                cells[i].aria_attr ? cells[i].aria_attr : "");
+        const char *classes = cells[i].class_attr ? cells[i].class_attr : "";
+        const char *aria = cells[i].aria_attr ? cells[i].aria_attr : "";
+        const char letter[2] = {cells[i].letter, '\0'};
+        LogFields fields = {.len = 0};
+        log_field_long(&fields, "cell", (long)(i + 1));
+        log_field_string(&fields, "letter", letter);
+        log_field_bool(&fields, "center", cells[i].marked_center);
+        log_field_string(&fields, "classes", classes);
+        log_field_string(&fields, "aria", aria);
+        log_fields(LOG_LEVEL_DEBUG, &fields,
+                   "Hive cell #%zu: letter='%c' center=%s classes='%s' aria='%s'",
+                   i + 1,
+                   cells[i].letter,
+                   cells[i].marked_center ? "true" : "false",
+                   classes,
+                   aria);
     }
 }
 
@@ -1016,7 +2281,7 @@ static int read_letters_from_board(WD *wd, char letters_out[8], char **err_out)
         if (cells[i].marked_center) center_count++;
     }
     if (center_count == 0) {
-        fprintf(stderr, "[WARN] No center marker found in hive; falling back to nth-child(4)\n");
+        log_at(LOG_LEVEL_WARN, "No center marker found in hive; falling back to nth-child(4)");
         dump_cell_debug(cells, 7);
         cells[3].marked_center = true;
         center_count = 1;
@@ -1086,50 +2351,328 @@ static int read_letters_from_board(WD *wd, char letters_out[8], char **err_out)
     return 0;
 }
 
-static int find_valid_words(const WordList *dictionary,
-                            const char letters[8],
-                            WordList *results) {
-    const char required = letters[6];
-    for (size_t i = 0; i < dictionary->size; ++i) {
-        const char *word = dictionary->items[i];
-        size_t len = strlen(word);
-        if (len < 4) continue;
-        bool missing = false;
-        for (size_t j = 0; j < len; ++j) {
-            char c = word[j];
-            if (!letters_contains(letters, c)) {
-                missing = true;
-                break;
+// One execute/sync round-trip per poll: click away the overlays the puzzle page is known
+// to show (splash "Play", welcome/stats modals, consent banners), then report whether all
+// seven hive cells carry a letter and nothing still covers the board.
+static const char *const READINESS_PROBE_SCRIPT =
+    "const visible = el => !!(el && el.getClientRects().length);\n"
+    "const dismissSelectors = ['.pz-moment__button.primary', '.sb-modal-close', '.pz-modal__close',\n"
+    "                          '.fides-accept-all-button', '.purr-blocker-card__button'];\n"
+    "const dismissed = [];\n"
+    "for (const sel of dismissSelectors) {\n"
+    "  const el = document.querySelector(sel);\n"
+    "  if (visible(el)) { el.click(); dismissed.push(sel); }\n"
+    "}\n"
+    "const cells = Array.from(document.querySelectorAll('.hive-cell'));\n"
+    "const lettered = cells.filter(c => /^[A-Za-z]$/.test((c.textContent || '').trim())).length;\n"
+    "const modal = Array.from(document.querySelectorAll('.sb-modal-wrapper, .pz-moment, .pz-modal, #fides-banner'))\n"
+    "  .some(visible);\n"
+    "return {cells: cells.length, lettered: lettered, modal: modal, dismissed: dismissed.join(' ')};\n";
+
+static int probe_board_readiness(WD *wd, ReadinessProbe *probe, char **err_out) {
+    char *body = NULL;
+    if (wd_execute_script(wd, READINESS_PROBE_SCRIPT, &body, err_out) != 0) return -1;
+    probe->lettered_cells = 0;
+    probe->modal_open = false;
+    probe->dismissed = NULL;
+    json_extract_long(body, "lettered", &probe->lettered_cells);
+    json_extract_bool(body, "modal", &probe->modal_open);
+    if (!json_extract_string(body, "dismissed", &probe->dismissed)) probe->dismissed = NULL;
+    free(body);
+    return 0;
+}
+
+// Polls until the board is ready or `timeout_seconds` pass. Probe failures (page
+// mid-load, script errors) just count as "not ready yet". Something dismissed in a round
+// may have uncovered another overlay, so that round never counts as ready.
+static bool wait_for_board_ready(WD *wd, int timeout_seconds) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    StringBuffer dismissed;
+    string_buffer_init(&dismissed);
+    bool ready = false;
+    for (;;) {
+        ReadinessProbe probe;
+        char *err = NULL;
+        if (probe_board_readiness(wd, &probe, &err) == 0) {
+            bool any_dismissed = probe.dismissed && probe.dismissed[0];
+            if (any_dismissed) {
+                if (dismissed.length > 0) string_buffer_append_char(&dismissed, ' ');
+                string_buffer_append(&dismissed, probe.dismissed);
+            }
+            free(probe.dismissed);
+            if (probe.lettered_cells >= 7 && !probe.modal_open && !any_dismissed) {
+                ready = true;
             }
         }
-        if (missing) continue;
-        if (!strchr(word, required)) continue;
-        if (!contains_vowel(word)) continue;
-        char *copy = strdup(word);
-        if (!copy) return -1;
-        to_upper_inplace(copy);
-        if (word_list_append_copy(results, copy) != 0) {
-            free(copy);
+        free(err);
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long waited_ms = (now.tv_sec - start.tv_sec) * 1000L + (now.tv_nsec - start.tv_nsec) / 1000000L;
+        if (ready) {
+            printf("Board ready after %ld ms", waited_ms);
+            if (dismissed.length > 0) printf(" (dismissed: %s)", dismissed.data);
+            printf(".\n");
+            fflush(stdout);
+            break;
+        }
+        if (waited_ms >= timeout_seconds * 1000L) break;
+        struct timespec pause = {0, 250L * 1000000L};
+        nanosleep(&pause, NULL);
+    }
+    string_buffer_free(&dismissed);
+    return ready;
+}
+
+// ---------- Word index & scoring ----------
+
+#define NON_LETTER_BIT (UINT32_C(1) << 26)
+#define LETTER_BIT(c) (UINT32_C(1) << ((c) - 'a'))
+#define VOWEL_MASK (LETTER_BIT('a') | LETTER_BIT('e') | LETTER_BIT('i') | \
+                    LETTER_BIT('o') | LETTER_BIT('u') | LETTER_BIT('y'))
+#define PANGRAM_BONUS 7
+
+static uint32_t letter_mask(const char *word, size_t *out_len) {
+    uint32_t mask = 0;
+    size_t len = 0;
+    for (; word[len]; ++len) {
+        int lower = tolower((unsigned char)word[len]);
+        mask |= (lower >= 'a' && lower <= 'z') ? LETTER_BIT(lower) : NON_LETTER_BIT;
+    }
+    if (out_len) *out_len = len;
+    return mask;
+}
+
+static int index_words(const WordList *words, WordIndex *index) {
+    index->words = words;
+    index->size = 0;
+    index->masks = (uint32_t *)malloc((words->size ? words->size : 1) * sizeof(uint32_t));
+    index->lengths = (uint32_t *)malloc((words->size ? words->size : 1) * sizeof(uint32_t));
+    if (!index->masks || !index->lengths) {
+        free(index->masks);
+        free(index->lengths);
+        index->masks = NULL;
+        index->lengths = NULL;
+        return -1;
+    }
+    for (size_t i = 0; i < words->size; ++i) {
+        size_t len = 0;
+        index->masks[i] = letter_mask(words->items[i], &len);
+        index->lengths[i] = (uint32_t)len;
+    }
+    index->size = words->size;
+    return 0;
+}
+
+static int build_word_index(const WordList *words, WordIndex *index) {
+    const double start = monotonic_ns();
+    if (index_words(words, index) != 0) return -1;
+    record_phase_since("index_build", "", start);
+    return 0;
+}
+
+static void free_word_index(WordIndex *index) {
+    free(index->masks);
+    free(index->lengths);
+    index->masks = NULL;
+    index->lengths = NULL;
+    index->size = 0;
+}
+
+static bool hive_accepts(uint32_t mask, uint32_t length, uint32_t allowed, uint32_t required) {
+    return length >= 4 && !(mask & ~allowed) && (mask & required) && (mask & VOWEL_MASK);
+}
+
+static unsigned long word_points(uint32_t length, bool pangram) {
+    unsigned long points = length == 4 ? 1 : length;
+    return pangram ? points + PANGRAM_BONUS : points;
+}
+
+// Filters and scores in the same pass: candidates only use hive letters, so a pangram is a
+// word whose mask covers the whole hive. Positions flagged in `removed` (may be NULL) are
+// skipped; only accepted words are looked up, so the flags cost nothing on the rest.
+static int collect_valid_words(const WordIndex *index,
+                               const bool *removed,
+                               uint32_t allowed,
+                               uint32_t required,
+                               WordList *results,
+                               ScoreSummary *score) {
+    for (size_t i = 0; i < index->size; ++i) {
+        const uint32_t mask = index->masks[i];
+        if (!hive_accepts(mask, index->lengths[i], allowed, required)) continue;
+        if (removed && removed[i]) continue;
+        if (word_list_append_copy(results, index->words->items[i]) != 0) return -1;
+        to_upper_inplace(results->items[results->size - 1]);
+        const bool pangram = mask == allowed;
+        score->max_score += word_points(index->lengths[i], pangram);
+        if (pangram && word_list_append_copy(&score->pangrams, results->items[results->size - 1]) != 0) {
             return -1;
         }
-        free(copy);
     }
     return 0;
 }
 
+static int find_valid_words(const WordIndex *index,
+                            const char letters[8],
+                            WordList *results,
+                            ScoreSummary *score) {
+    const double start = monotonic_ns();
+    score->max_score = 0;
+    word_list_init(&score->pangrams);
+    if (collect_valid_words(index, NULL, letter_mask(letters, NULL), LETTER_BIT(letters[6]), results, score) != 0) {
+        return -1;
+    }
+    record_phase_since("solve", "", start);
+    return 0;
+}
+
+// Base words first, less the removed ones, then the added words.
+static int find_layered_words(const LayeredWordIndex *index,
+                              const char letters[8],
+                              WordList *results,
+                              ScoreSummary *score) {
+    const double start = monotonic_ns();
+    const uint32_t allowed = letter_mask(letters, NULL);
+    const uint32_t required = LETTER_BIT(letters[6]);
+    score->max_score = 0;
+    word_list_init(&score->pangrams);
+    if (collect_valid_words(index->base, index->removed, allowed, required, results, score) != 0 ||
+        collect_valid_words(&index->added, NULL, allowed, required, results, score) != 0) {
+        return -1;
+    }
+    record_phase_since("solve", "", start);
+    return 0;
+}
+
 // ---------- Pause/Retry ----------
 
-static StepResult retry_with_pause(const char *what, OperationFn fn, void *ctx) {
-    for (;;) {
+// Automatic retries per step before falling back to the pause prompt. Sending words
+// retypes the whole list, so it gets a single retry.
+#define RETRY_BUDGET_SESSION 2
+#define RETRY_BUDGET_NAVIGATE 3
+#define RETRY_BUDGET_RESIZE 3
+#define RETRY_BUDGET_FOCUS 4
+#define RETRY_BUDGET_READ_LETTERS 4
+#define RETRY_BUDGET_SEND_WORDS 1
+#define RETRY_BASE_DELAY_MS 250L
+#define RETRY_MAX_DELAY_MS 4000L
+
+// Classifies the failure of the last request on `s`. Transient errors are retried
+// automatically; permanent ones (dead session, bad selector) and anything unrecognised
+// go to the pause prompt.
+static ErrorClass classify_failure(const CurlSession *s, char *reason, size_t reason_size) {
+    static const char *const transient_codes[] = {
+        "stale element reference", "no such element", "element click intercepted",
+        "element not interactable", "timeout", "script timeout",
+    };
+    static const char *const permanent_codes[] = {
+        "invalid session id", "session not created", "no such window", "invalid argument",
+        "invalid selector", "unknown command", "unknown method",
+    };
+    reason[0] = '\0';
+    switch (s->last_code) {
+    case CURLE_OK:
+        break;
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_PARTIAL_FILE:
+    case CURLE_OPERATION_TIMEDOUT:
+        snprintf(reason, reason_size, "%s", curl_easy_strerror(s->last_code));
+        return ERROR_CLASS_TRANSIENT;
+    default:
+        return ERROR_CLASS_UNKNOWN;
+    }
+    if (s->last_status >= 200 && s->last_status < 300) return ERROR_CLASS_UNKNOWN;
+    for (size_t i = 0; i < ARRAY_LEN(transient_codes); ++i) {
+        if (strcmp(s->last_error, transient_codes[i]) == 0) {
+            snprintf(reason, reason_size, "%s", s->last_error);
+            return ERROR_CLASS_TRANSIENT;
+        }
+    }
+    for (size_t i = 0; i < ARRAY_LEN(permanent_codes); ++i) {
+        if (strcmp(s->last_error, permanent_codes[i]) == 0) {
+            snprintf(reason, reason_size, "%s", s->last_error);
+            return ERROR_CLASS_PERMANENT;
+        }
+    }
+    if (s->last_status >= 500) {
+        snprintf(reason, reason_size, "HTTP %ld%s%s", s->last_status, s->last_error[0] ? " " : "", s->last_error);
+        return ERROR_CLASS_TRANSIENT;
+    }
+    return ERROR_CLASS_UNKNOWN;
+}
+
+// Exponential backoff with equal jitter: half the capped delay is fixed, half random.
+static long backoff_delay_ms(int attempt) {
+    long delay = RETRY_BASE_DELAY_MS;
+    for (int i = 1; i < attempt && delay < RETRY_MAX_DELAY_MS; ++i) delay *= 2;
+    if (delay > RETRY_MAX_DELAY_MS) delay = RETRY_MAX_DELAY_MS;
+    long half = delay / 2;
+    return delay - half + (long)(rand() % (half + 1));
+}
+
+static void sleep_ms(long ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+static StepResult run_step_with_retries(const char *what, int retry_budget, CurlSession *session, OperationFn fn,
+                                        void *ctx) {
+    int auto_retries = 0;
+    for (int attempts = 1;; ++attempts) {
+        session->last_code = CURLE_OK;
+        session->last_status = 0;
+        session->last_error[0] = '\0';
         char *err = NULL;
+        TraceSpan attempt_span;
+        trace_begin(&attempt_span, "attempt", NULL);
+        if (attempt_span.active) snprintf(attempt_span.name, sizeof(attempt_span.name), "%s attempt %d", what, attempts);
         int rc = fn(ctx, &err);
+        if (rc != 0) trace_arg_string(&attempt_span, "error", err ? err : "unknown error");
+        trace_end(&attempt_span);
         if (rc == 0) {
             free(err);
             return STEP_RESULT_OK;
         }
-        fprintf(stderr, "[WARN] %s failed: %s\n", what, err ? err : "unknown error");
+        char reason[96];
+        ErrorClass kind = classify_failure(session, reason, sizeof(reason));
+        if (kind == ERROR_CLASS_TRANSIENT && auto_retries < retry_budget) {
+            ++auto_retries;
+            long delay = backoff_delay_ms(auto_retries);
+            if (log_enabled(LOG_LEVEL_WARN)) {
+                LogFields fields = {.len = 0};
+                log_field_string(&fields, "step", what);
+                log_field_string(&fields, "reason", reason);
+                log_field_long(&fields, "retry", auto_retries);
+                log_field_long(&fields, "retries", retry_budget);
+                log_field_long(&fields, "delay_ms", delay);
+                log_fields(LOG_LEVEL_WARN, &fields, "%s failed (transient: %s); retry %d/%d in %ld ms",
+                           what, reason, auto_retries, retry_budget, delay);
+            }
+            free(err);
+            TraceSpan backoff_span;
+            trace_begin(&backoff_span, "retry", "backoff");
+            trace_arg_long(&backoff_span, "delay_ms", delay);
+            sleep_ms(delay);
+            trace_end(&backoff_span);
+            continue;
+        }
+        log_at(LOG_LEVEL_WARN, "%s failed: %s", what, err ? err : "unknown error");
         free(err);
-        pause_banner(what);
+        char banner[256];
+        if (kind == ERROR_CLASS_TRANSIENT) {
+            snprintf(banner, sizeof(banner), "Step: %s (still failing after %d automatic retries)", what, auto_retries);
+        } else if (kind == ERROR_CLASS_PERMANENT) {
+            snprintf(banner, sizeof(banner), "Step: %s (%s)", what, reason);
+        } else {
+            snprintf(banner, sizeof(banner), "Step: %s", what);
+        }
+        pause_banner(banner);
         char answer[32];
         prompt_line("> ", answer, sizeof(answer));
         if (strcmp(answer, "quit") == 0 || strcmp(answer, "q") == 0) {
@@ -1138,7 +2681,496 @@ static StepResult retry_with_pause(const char *what, OperationFn fn, void *ctx)
         if (strcmp(answer, "skip") == 0 || strcmp(answer, "s") == 0) {
             return STEP_RESULT_SKIP;
         }
+        // Retry with a fresh automatic budget.
+        auto_retries = 0;
+    }
+}
+
+static StepResult retry_with_pause(const char *what, int retry_budget, CurlSession *session, OperationFn fn, void *ctx) {
+    TraceSpan span;
+    trace_begin(&span, "step", what);
+    StepResult result = run_step_with_retries(what, retry_budget, session, fn, ctx);
+    trace_end(&span);
+    return result;
+}
+
+// ---------- Paced word entry ----------
+// With --pace-ms, words go in as W3C actions, PACE_BATCH_WORDS at a time with a pause
+// between words. Most words missing from the found-word list were rejected by the game, so
+// only the first PACE_PROBE_WORDS of a batch's missing words are typed again at a safer
+// pace. If one of them goes through, keystrokes are being dropped: the batch's other missing
+// words are typed again too and the pause doubles; otherwise the pause shortens by a
+// quarter. Batches are checked less often while no drops turn up (every batch, then every
+// 2nd, 4th, up to PACE_MAX_CHECK_INTERVAL).
+
+#define PACE_BATCH_WORDS 25
+#define PACE_PROBE_WORDS 3
+#define PACE_MAX_CHECK_INTERVAL 8
+#define PACE_MAX_PAUSE_MS 250
+#define PACE_SAFE_PAUSE_MS 20
+#define PACE_SETTLE_MS 60L
+
+// The words of arguments[0] the page has not accepted, space-separated. Null without a list.
+static const char *const MISSING_WORDS_SCRIPT =
+    "const list = document.querySelector('.sb-wordlist-items-pag, .sb-wordlist-box');\n"
+    "if (!list) return null;\n"
+    "const found = new Set(Array.from(list.querySelectorAll('.sb-anagram'), el => el.textContent.trim().toUpperCase()));\n"
+    "return arguments[0].filter(word => !found.has(word)).join(' ');\n";
+
+typedef struct {
+    bool feedback;      // the page showed a found-word list to check against
+    size_t submitted;
+    size_t accepted;
+    size_t dropped;     // words that only went through when typed again
+    double seconds;
+    int pause_ms;
+} PacingOutcome;
+
+// Appends the words of words[0..count) the page has not accepted to `missing`. `has_list`
+// is set false when there is no found-word list to compare against.
+static int find_missing_words(WD *wd, char *const *words, size_t count, WordList *missing, bool *has_list,
+                              char **err_out) {
+    StringBuffer args;
+    string_buffer_init(&args);
+    int rc = string_buffer_append(&args, "[[");
+    for (size_t i = 0; i < count && rc == 0; ++i) {
+        if (i > 0) rc = string_buffer_append_char(&args, ',');
+        if (rc == 0) rc = string_buffer_append_json_string(&args, words[i]);
+    }
+    if (rc == 0) rc = string_buffer_append(&args, "]]");
+    if (rc != 0) {
+        set_error(err_out, "out of memory building missing-words arguments");
+        string_buffer_free(&args);
+        return -1;
+    }
+    char *body = NULL;
+    rc = wd_execute_script_args(wd, MISSING_WORDS_SCRIPT, args.data, &body, err_out);
+    string_buffer_free(&args);
+    if (rc != 0) return -1;
+
+    char *value = NULL;
+    if (!json_extract_value_string(body, &value)) value = NULL;   // not a string: no list either
+    free(body);
+    *has_list = value != NULL;
+    if (!value) return 0;
+    char *save = NULL;
+    for (char *word = strtok_r(value, " ", &save); word; word = strtok_r(NULL, " ", &save)) {
+        if (word_list_append_copy(missing, word) != 0) {
+            set_error(err_out, "out of memory collecting missing words");
+            free(value);
+            return -1;
+        }
+    }
+    free(value);
+    return 0;
+}
+
+// Types words[0..count) again at `pause_ms` and sets *recovered to how many the page lists
+// afterwards.
+static int retype_missing_words(WD *wd, char *const *words, size_t count, int pause_ms, size_t *recovered,
+                                char **err_out) {
+    *recovered = 0;
+    if (wd_send_words_as_keys(wd, words, count, pause_ms, err_out) != 0) return -1;
+    sleep_ms(PACE_SETTLE_MS);
+    WordList still_missing;
+    word_list_init(&still_missing);
+    bool listed = false;
+    int rc = find_missing_words(wd, words, count, &still_missing, &listed, err_out);
+    if (rc == 0 && listed) *recovered = count - still_missing.size;
+    word_list_free(&still_missing);
+    return rc;
+}
+
+// Types `words`, adapting *pause_ms as it goes; the pause carries over to a retry. Words
+// the page already lists (a rerun, or a retry of this step) are skipped.
+static int send_words_paced(WD *wd, const WordList *words, int *pause_ms, PacingOutcome *outcome, char **err_out) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    memset(outcome, 0, sizeof(*outcome));
+    outcome->submitted = words->size;
+
+    WordList pending;
+    word_list_init(&pending);
+    bool has_list = false;
+    if (find_missing_words(wd, words->items, words->size, &pending, &has_list, err_out) != 0) {
+        word_list_free(&pending);
+        return -1;
+    }
+    outcome->feedback = has_list;
+    char *const *queue = has_list ? pending.items : words->items;
+    size_t queue_size = has_list ? pending.size : words->size;
+
+    int rc = 0;
+    size_t check_interval = 1;
+    size_t until_check = 0;
+    for (size_t begin = 0; begin < queue_size && rc == 0; begin += PACE_BATCH_WORDS) {
+        size_t batch = queue_size - begin < PACE_BATCH_WORDS ? queue_size - begin : PACE_BATCH_WORDS;
+        rc = wd_send_words_as_keys(wd, queue + begin, batch, *pause_ms, err_out);
+        if (rc != 0 || !has_list) continue;
+        if (until_check > 0) {
+            --until_check;
+            continue;
+        }
+
+        sleep_ms(PACE_SETTLE_MS);
+        WordList missing;
+        word_list_init(&missing);
+        bool listed = false;
+        size_t recovered = 0;
+        rc = find_missing_words(wd, queue + begin, batch, &missing, &listed, err_out);
+        if (rc == 0 && missing.size > 0) {
+            int safe_pause = 2 * *pause_ms > PACE_SAFE_PAUSE_MS ? 2 * *pause_ms : PACE_SAFE_PAUSE_MS;
+            size_t probe = missing.size < PACE_PROBE_WORDS ? missing.size : PACE_PROBE_WORDS;
+            rc = retype_missing_words(wd, missing.items, probe, safe_pause, &recovered, err_out);
+            if (rc == 0 && recovered > 0 && probe < missing.size) {
+                size_t rest_recovered = 0;
+                rc = retype_missing_words(wd, missing.items + probe, missing.size - probe, safe_pause,
+                                          &rest_recovered, err_out);
+                recovered += rest_recovered;
+            }
+        }
+        word_list_free(&missing);
+        outcome->dropped += recovered;
+        if (recovered > 0) {
+            *pause_ms = 2 * *pause_ms > 4 ? 2 * *pause_ms : 4;
+            if (*pause_ms > PACE_MAX_PAUSE_MS) *pause_ms = PACE_MAX_PAUSE_MS;
+            check_interval = 1;
+        } else {
+            *pause_ms = *pause_ms * 3 / 4;
+            check_interval = 2 * check_interval < PACE_MAX_CHECK_INTERVAL ? 2 * check_interval : PACE_MAX_CHECK_INTERVAL;
+        }
+        until_check = check_interval - 1;
+    }
+
+    if (rc == 0 && has_list) {
+        WordList missing;
+        word_list_init(&missing);
+        bool listed = false;
+        rc = find_missing_words(wd, words->items, words->size, &missing, &listed, err_out);
+        outcome->accepted = words->size - (listed ? missing.size : 0);
+        word_list_free(&missing);
+    }
+    word_list_free(&pending);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    outcome->seconds = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+    outcome->pause_ms = *pause_ms;
+    return rc;
+}
+
+static void print_pacing_outcome(const PacingOutcome *outcome) {
+    if (!outcome->feedback) {
+        printf("No found-word list on the page; typed %zu words with a %d ms pause.\n",
+               outcome->submitted, outcome->pause_ms);
+    } else {
+        double rate = outcome->seconds > 0 ? (double)outcome->accepted / outcome->seconds : 0.0;
+        printf("Accepted %zu of %zu words in %.1fs (%.1f accepted words/s); pause settled at %d ms, "
+               "%zu dropped word(s) typed again.\n",
+               outcome->accepted, outcome->submitted, outcome->seconds, rate, outcome->pause_ms, outcome->dropped);
+    }
+    fflush(stdout);
+}
+
+// ---------- Session persistence ----------
+// A session kept open at exit (detach: true leaves Chrome running) is recorded so the next
+// run can reattach instead of paying for Chrome startup, navigation and resizing again.
+
+static void default_session_state_path(char *out, size_t out_size) {
+    const char *state = getenv("XDG_STATE_HOME");
+    const char *home = getenv("HOME");
+    if (state && *state) {
+        snprintf(out, out_size, "%s/spellingbee/session.json", state);
+    } else if (home && *home) {
+        snprintf(out, out_size, "%s/.local/state/spellingbee/session.json", home);
+    } else {
+        snprintf(out, out_size, "spellingbee-session.json");
+    }
+}
+
+static void make_parent_dirs(const char *path) {
+    char dir[PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char *slash = strrchr(dir, '/');
+    if (!slash || slash == dir) return;
+    *slash = '\0';
+    for (char *p = dir + 1; *p; ++p) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(dir, 0755);
+            *p = '/';
+        }
+    }
+    mkdir(dir, 0755);
+}
+
+static void save_session_state(const char *path, const WD *wd) {
+    make_parent_dirs(path);
+    char tmp[PATH_MAX + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    StringBuffer out;
+    string_buffer_init(&out);
+    if (string_buffer_append(&out, "{\"base\":") != 0 ||
+        string_buffer_append_json_string(&out, wd->base) != 0 ||
+        string_buffer_append(&out, ",\"session_id\":") != 0 ||
+        string_buffer_append_json_string(&out, wd->session_id) != 0 ||
+        string_buffer_append(&out, "}\n") != 0) {
+        string_buffer_free(&out);
+        log_at(LOG_LEVEL_WARN, "Could not save session state to %s", path);
+        return;
+    }
+    FILE *fp = fopen(tmp, "w");
+    bool ok = fp && fputs(out.data, fp) >= 0;
+    if (fp && fclose(fp) != 0) ok = false;
+    string_buffer_free(&out);
+    if (!ok || rename(tmp, path) != 0) {
+        log_at(LOG_LEVEL_WARN, "Could not save session state to %s (%s)", path, strerror(errno));
+        remove(tmp);
+    }
+}
+
+static void clear_session_state(const char *path) {
+    remove(path);
+}
+
+// Adopts the saved session if it belongs to this WebDriver endpoint and still answers.
+// On success *out_url holds the page it is showing (caller frees); on failure the stale
+// record is dropped.
+static bool reattach_saved_session(WD *wd, const char *path, char **out_url) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return false;
+    char contents[1024];
+    size_t n = fread(contents, 1, sizeof(contents) - 1, fp);
+    fclose(fp);
+    contents[n] = '\0';
+
+    char *base = NULL;
+    char *session_id = NULL;
+    bool matches = json_extract_string(contents, "base", &base) &&
+                   json_extract_string(contents, "session_id", &session_id) &&
+                   strcmp(base, wd->base) == 0 && session_id[0] &&
+                   strlen(session_id) < sizeof(wd->session_id);
+    if (matches) snprintf(wd->session_id, sizeof(wd->session_id), "%s", session_id);
+    free(base);
+    if (!matches) {
+        free(session_id);
+        return false;
+    }
+
+    char *err = NULL;
+    wd->session->timeout_override_ms = 5000L;
+    int rc = wd_current_url(wd, out_url, &err);
+    wd->session->timeout_override_ms = 0;
+    if (rc != 0) {
+        log_at(LOG_LEVEL_WARN, "Saved session %s is gone (%s); starting a new one.",
+               session_id, err ? err : "unknown error");
+        wd_clear_session(wd);
+        clear_session_state(path);
+    }
+    free(err);
+    free(session_id);
+    return rc == 0;
+}
+
+// ---------- Synthetic dictionaries ----------
+// English-looking words for benchmarks and stress runs: by default lengths 3-14 peaking at
+// 6-7 and letters drawn with English text frequencies. The generator is a seeded xorshift64*
+// so every platform, and the C++ port, produces the same lists for the same spec.
+static const uint32_t SYNTHETIC_LETTER_WEIGHTS[26] = {
+    82, 15, 28, 43, 127, 22, 20, 61, 70, 2, 8, 40, 24, 67, 75, 19, 1, 60, 63, 91, 28, 10, 24, 2, 20, 1};
+static const uint32_t SYNTHETIC_LENGTH_WEIGHTS[] = {0, 0, 0, 4, 8, 12, 14, 14, 13, 11, 9, 7, 5, 4, 3};  // by length
+#define SYNTHETIC_SEED UINT64_C(0x5eed5b1e5eed5b1e)
+
+static const char *const LIST_FILES[] = {
+    "wordlist.txt", "wiki-100k.txt", "words.txt", "words400k.txt", "wlist_match1.txt",
+};
+static const int LIST_FILE_PERCENT[] = {5, 20, 40, 60, 100};  // share of the generated words per file
+
+static void synthetic_spec_init(SyntheticSpec *spec) {
+    memset(spec, 0, sizeof(*spec));
+    memcpy(spec->letter_weights, SYNTHETIC_LETTER_WEIGHTS, sizeof(SYNTHETIC_LETTER_WEIGHTS));
+    memcpy(spec->length_weights, SYNTHETIC_LENGTH_WEIGHTS, sizeof(SYNTHETIC_LENGTH_WEIGHTS));
+    spec->seed = SYNTHETIC_SEED;
+}
+
+// Applies "key:weight,..." overrides, e.g. "e:150,z:0" for letters or "3:0,15:2" for
+// lengths; entries not named keep their weight.
+static bool parse_synthetic_weights(const char *spec, bool letters, SyntheticSpec *out, char **err_out) {
+    const char *what = letters ? "--letter-weights" : "--word-lengths";
+    for (const char *p = spec;;) {
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len == 0 && !end) break;
+        char term[64];
+        if (len >= sizeof(term)) {
+            set_error(err_out, "%s: entry '%.*s' is too long", what, (int)len, p);
+            return false;
+        }
+        memcpy(term, p, len);
+        term[len] = '\0';
+        char *colon = strchr(term, ':');
+        if (!colon) {
+            set_error(err_out, "%s: expected key:weight, got '%s'", what, term);
+            return false;
+        }
+        *colon = '\0';
+        char *weight_end = NULL;
+        errno = 0;
+        unsigned long weight = strtoul(colon + 1, &weight_end, 10);
+        if (weight_end == colon + 1 || *weight_end != '\0' || errno != 0 || weight > 1000000UL) {
+            set_error(err_out, "%s: bad weight in '%s:%s'", what, term, colon + 1);
+            return false;
+        }
+        if (letters) {
+            if (strlen(term) != 1 || !isalpha((unsigned char)term[0])) {
+                set_error(err_out, "--letter-weights: '%s' is not a letter", term);
+                return false;
+            }
+            out->letter_weights[tolower((unsigned char)term[0]) - 'a'] = (uint32_t)weight;
+        } else {
+            char *length_end = NULL;
+            long length = strtol(term, &length_end, 10);
+            if (length_end == term || *length_end != '\0' || length < 1 || length > SYNTHETIC_MAX_LENGTH) {
+                set_error(err_out, "--word-lengths: length '%s' is not between 1 and %d", term, SYNTHETIC_MAX_LENGTH);
+                return false;
+            }
+            out->length_weights[length] = (uint32_t)weight;
+        }
+        if (!end) break;
+        p = end + 1;
+    }
+    const uint32_t *weights = letters ? out->letter_weights : out->length_weights;
+    size_t count = letters ? ARRAY_LEN(out->letter_weights) : ARRAY_LEN(out->length_weights);
+    for (size_t i = 0; i < count; ++i) {
+        if (weights[i] != 0) return true;
+    }
+    set_error(err_out, "%s leaves every weight at zero", what);
+    return false;
+}
+
+// "250000", "1M", "2.5k": word counts with an optional k, M or G multiplier.
+static bool parse_word_count(const char *text, uint64_t *out, char **err_out) {
+    char *end = NULL;
+    errno = 0;
+    double value = strtod(text, &end);
+    if (end == text || errno != 0) {
+        set_error(err_out, "bad word count '%s'", text);
+        return false;
+    }
+    if (*end == 'k' || *end == 'K') value *= 1e3, ++end;
+    else if (*end == 'm' || *end == 'M') value *= 1e6, ++end;
+    else if (*end == 'g' || *end == 'G') value *= 1e9, ++end;
+    if (*end != '\0') {
+        set_error(err_out, "bad word count '%s'", text);
+        return false;
+    }
+    if (!(value >= 1 && value <= 1e10)) {
+        set_error(err_out, "word count '%s' out of range", text);
+        return false;
+    }
+    *out = (uint64_t)value;
+    return true;
+}
+
+typedef struct {
+    const SyntheticSpec *spec;
+    uint64_t state;
+    uint32_t letter_total;
+    uint32_t length_total;
+    char word[SYNTHETIC_MAX_LENGTH + 1];
+} SyntheticWords;
+
+static void synthetic_words_init(SyntheticWords *gen, const SyntheticSpec *spec) {
+    gen->spec = spec;
+    gen->state = spec->seed ? spec->seed : SYNTHETIC_SEED;
+    gen->letter_total = 0;
+    gen->length_total = 0;
+    for (size_t i = 0; i < ARRAY_LEN(spec->letter_weights); ++i) gen->letter_total += spec->letter_weights[i];
+    for (size_t i = 0; i < ARRAY_LEN(spec->length_weights); ++i) gen->length_total += spec->length_weights[i];
+}
+
+static size_t synthetic_pick(SyntheticWords *gen, const uint32_t *weights, uint32_t total) {
+    gen->state ^= gen->state >> 12;
+    gen->state ^= gen->state << 25;
+    gen->state ^= gen->state >> 27;
+    uint32_t roll = (uint32_t)(((gen->state * UINT64_C(0x2545F4914F6CDD1D)) >> 32) % total);
+    size_t i = 0;
+    while (roll >= weights[i]) roll -= weights[i++];
+    return i;
+}
+
+// The next word, valid until the following call.
+static const char *synthetic_words_next(SyntheticWords *gen, size_t *out_len) {
+    size_t len = synthetic_pick(gen, gen->spec->length_weights, gen->length_total);
+    for (size_t i = 0; i < len; ++i) {
+        gen->word[i] = (char)('a' + synthetic_pick(gen, gen->spec->letter_weights, gen->letter_total));
+    }
+    gen->word[len] = '\0';
+    *out_len = len;
+    return gen->word;
+}
+
+// Streams `count` words into the five files load_word_dictionaries reads. Word i goes to
+// every file whose share covers it, so each tier is a leading share of the massive list and
+// no more than one word is held in memory.
+static int write_synthetic_dictionaries(const char *dir, uint64_t count, const SyntheticSpec *spec,
+                                        uint64_t *out_bytes, char **err_out) {
+    FILE *files[ARRAY_LEN(LIST_FILES)] = {0};
+    uint64_t limits[ARRAY_LEN(LIST_FILES)];
+    char path[PATH_MAX + 32];
+    int rc = 0;
+    for (size_t f = 0; f < ARRAY_LEN(LIST_FILES) && rc == 0; ++f) {
+        snprintf(path, sizeof(path), "%s/%s", dir, LIST_FILES[f]);
+        files[f] = fopen(path, "w");
+        if (!files[f]) {
+            set_error(err_out, "failed to write %s: %s", path, strerror(errno));
+            rc = -1;
+        }
+        limits[f] = count * (uint64_t)LIST_FILE_PERCENT[f] / 100;
+    }
+    SyntheticWords words;
+    synthetic_words_init(&words, spec);
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < count && rc == 0; ++i) {
+        size_t len = 0;
+        const char *word = synthetic_words_next(&words, &len);
+        for (size_t f = 0; f < ARRAY_LEN(LIST_FILES); ++f) {
+            if (i >= limits[f]) continue;
+            fwrite(word, 1, len, files[f]);
+            fputc('\n', files[f]);
+            bytes += len + 1;
+        }
     }
+    for (size_t f = 0; f < ARRAY_LEN(LIST_FILES); ++f) {
+        if (files[f] && (ferror(files[f]) | fclose(files[f])) != 0 && rc == 0) {
+            snprintf(path, sizeof(path), "%s/%s", dir, LIST_FILES[f]);
+            set_error(err_out, "failed to write %s", path);
+            rc = -1;
+        }
+    }
+    if (out_bytes) *out_bytes = bytes;
+    return rc;
+}
+
+static void remove_synthetic_dictionaries(const char *dir) {
+    char path[PATH_MAX + 32];
+    for (size_t f = 0; f < ARRAY_LEN(LIST_FILES); ++f) {
+        snprintf(path, sizeof(path), "%s/%s", dir, LIST_FILES[f]);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
+// Creates a fresh "<prefix>XXXXXX" directory under $TMPDIR (or /tmp) for synthetic lists.
+static bool make_scratch_dir(const char *prefix, char *out, size_t out_size) {
+    const char *tmp = getenv("TMPDIR");
+    snprintf(out, out_size, "%s/%sXXXXXX", tmp && *tmp ? tmp : "/tmp", prefix);
+    if (!mkdtemp(out)) {
+        log_at(LOG_LEVEL_FATAL, "cannot create a scratch directory: %s", strerror(errno));
+        out[0] = '\0';
+        return false;
+    }
+    return true;
 }
 
 // ---------- Argument parsing ----------
@@ -1179,7 +3211,7 @@ static bool find_default_dictionary_dir(char *out_dir, size_t out_size) {
     };
     for (size_t i = 0; i < ARRAY_LEN(candidates); ++i) {
         if (path_is_directory(candidates[i])) {
-            strncpy(out_dir, candidates[i], out_size);
+            strncpy(out_dir, candidates[i], out_size - 1);
             out_dir[out_size - 1] = '\0';
             return true;
         }
@@ -1192,6 +3224,26 @@ static bool parse_args(int argc, char **argv, Config *config) {
     config->has_cli_letters = false;
     config->letters_cli[0] = '\0';
     config->dictionary_dir[0] = '\0';
+    config->check_words_file[0] = '\0';
+    config->ready_timeout_seconds = 15;
+    config->reuse_session = true;
+    config->pace_ms = -1;
+    config->transport_stats = false;
+    config->record_file[0] = '\0';
+    config->metrics_prefix[0] = '\0';
+    config->trace_file[0] = '\0';
+    config->word_changes = (WordChanges){0};
+    config->compact_dictionaries = false;
+    config->log_level = LOG_LEVEL_INFO;
+    config->log_json = false;
+    config->bench_decode_iterations = 0;
+    config->bench = false;
+    config->bench_words = 0;
+    synthetic_spec_init(&config->synthetic);
+    config->generate_dir[0] = '\0';
+    config->synthetic_words = 1000000;
+    config->stress_count = 0;
+    default_session_state_path(config->session_file, sizeof(config->session_file));
     find_default_dictionary_dir(config->dictionary_dir, sizeof(config->dictionary_dir));
 
     for (int i = 1; i < argc; ++i) {
@@ -1203,7 +3255,55 @@ static bool parse_args(int argc, char **argv, Config *config) {
             printf("  --keep-open-on-stop              Shortcut for --stop-action=keep.\n");
             printf("  --rerun-on-stop                  Shortcut for --stop-action=rerun.\n");
             printf("  --letters=ABCDEFg                Supply hive letters (center letter last).\n");
-            printf("  --dictionary-dir=PATH            Override word list directory.\n");
+            printf("  --dictionary-dir=PATH            Override word list directory. Changes to the lists are\n");
+            printf("                                   picked up between runs, without a restart.\n");
+            printf("  --add-words=W,W,...              Write a delta segment adding the words to the massive list\n");
+            printf("                                   and exit; a running solver picks it up before its next run.\n");
+            printf("  --remove-words=W,W,...           Likewise, removing the words.\n");
+            printf("  --compact-dictionaries           Fold the delta segments into wlist_match1.txt, delete them\n");
+            printf("                                   and exit (after writing any --add-words/--remove-words).\n");
+            printf("                                   A running solver does this itself past 1024 changes.\n");
+            printf("  --check-words=FILE|-             Print the tier bitmask of each listed word and exit\n");
+            printf("                                   (1 short, 2 medium, 4 extended, 8 massive, 16 hive-legal).\n");
+            printf("  --ready-timeout=SECONDS          Wait up to SECONDS for the board to load (dismissing\n");
+            printf("                                   known modals) before asking; 0 always asks (default 15).\n");
+            printf("  --session-file=PATH              Where a kept browser session is recorded for reuse\n");
+            printf("                                   (default $XDG_STATE_HOME/spellingbee/session.json).\n");
+            printf("  --new-session                    Ignore any saved session and start a fresh browser.\n");
+            printf("  --transport-stats                Print per-endpoint WebDriver call counts and timings on exit.\n");
+            printf("  --record=FILE                    Log every WebDriver request and reply to FILE (JSON lines)\n");
+            printf("                                   for tools/replay_webdriver.py.\n");
+            printf("  --metrics-file=PREFIX            Time every phase (loads, index, WebDriver calls, board read,\n");
+            printf("                                   solve, payload, submit) into histograms and write\n");
+            printf("                                   PREFIX.prom and PREFIX.json on exit and on SIGUSR1.\n");
+            printf("  --trace=FILE                     Write a Chrome trace (chrome://tracing, Perfetto) of each run:\n");
+            printf("                                   steps, retries, WebDriver requests and prompt waits.\n");
+            printf("  --log-level=LEVEL                Least severe diagnostics shown: debug, info (default), warn,\n");
+            printf("                                   error, fatal or off. debug adds the hive cell attributes\n");
+            printf("                                   when the board read goes wrong.\n");
+            printf("  --log-format=text|json           Write diagnostics as [WARN] lines (default) or as JSON lines\n");
+            printf("                                   with ts, level, thread, msg and per-record fields.\n");
+            printf("  --bench                          Run the loader, solver and payload micro-benchmarks, print\n");
+            printf("                                   JSON (time and allocations per op) and exit. Uses synthetic\n");
+            printf("                                   word lists unless all five are in the dictionary directory.\n");
+            printf("                                   Exits 1 if loading, solving, the payload or reply decoding\n");
+            printf("                                   goes over its allocation budget.\n");
+            printf("  --bench-words=N                  Benchmark against N synthetic words even if real lists exist.\n");
+            printf("  --generate-dictionaries=DIR      Write the five word lists, filled with synthetic English-like\n");
+            printf("                                   words, to DIR and exit.\n");
+            printf("  --synthetic-words=N              Words to generate (default 1M; k, M and G suffixes work).\n");
+            printf("  --word-lengths=LEN:W,...         Override the weight of word lengths, e.g. 3:0,15:2.\n");
+            printf("  --letter-weights=L:W,...         Override letter frequencies (per mille), e.g. e:150,z:0.\n");
+            printf("  --synthetic-seed=N               Seed of the synthetic word generator.\n");
+            printf("  --stress[=N,N,...]               Generate, load, index and solve synthetic dictionaries of\n");
+            printf("                                   each size (default 1M,3M,10M), print load time, RSS and\n");
+            printf("                                   solve latency per size as JSON, and exit. Larger sizes,\n");
+            printf("                                   e.g. --stress=30M,100M, need tens of GB of RAM and a few\n");
+            printf("                                   GB of $TMPDIR.\n");
+            printf("  --bench-decode=N                 Time N decodes of typical chromedriver replies and exit.\n");
+            printf("  --pace-ms=MS                     Type words in batches with an MS pause between words,\n");
+            printf("                                   lengthened when retyped words show dropped keys,\n");
+            printf("                                   instead of one W3C actions request.\n");
             return false;
         }
         if (strncmp(arg, "--stop-action=", 14) == 0) {
@@ -1265,90 +3365,1039 @@ static bool parse_args(int argc, char **argv, Config *config) {
             config->dictionary_dir[sizeof(config->dictionary_dir) - 1] = '\0';
             continue;
         }
-        fprintf(stderr, "Unknown argument: %s\n", arg);
-        return false;
+        if (strncmp(arg, "--add-words=", 12) == 0 || strncmp(arg, "--remove-words=", 15) == 0) {
+            const bool add = arg[2] == 'a';
+            const size_t listed = config->word_changes.size;
+            if (parse_word_changes_arg(strchr(arg, '=') + 1, add, &config->word_changes) != 0) {
+                fprintf(stderr, "out of memory parsing %s\n", add ? "--add-words" : "--remove-words");
+                return false;
+            }
+            if (config->word_changes.size == listed) {
+                fprintf(stderr, "%s requires a comma-separated word list\n", add ? "--add-words" : "--remove-words");
+                return false;
+            }
+            continue;
+        }
+        if (strcmp(arg, "--compact-dictionaries") == 0) {
+            config->compact_dictionaries = true;
+            continue;
+        }
+        if (strcmp(arg, "--check-words") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "--check-words requires a value\n");
+                return false;
+            }
+            strncpy(config->check_words_file, argv[++i], sizeof(config->check_words_file) - 1);
+            config->check_words_file[sizeof(config->check_words_file) - 1] = '\0';
+            continue;
+        }
+        if (strncmp(arg, "--check-words=", 14) == 0) {
+            strncpy(config->check_words_file, arg + 14, sizeof(config->check_words_file) - 1);
+            config->check_words_file[sizeof(config->check_words_file) - 1] = '\0';
+            continue;
+        }
+        if (strncmp(arg, "--session-file=", 15) == 0) {
+            if (arg[15] == '\0') {
+                fprintf(stderr, "--session-file requires a path\n");
+                return false;
+            }
+            strncpy(config->session_file, arg + 15, sizeof(config->session_file) - 1);
+            config->session_file[sizeof(config->session_file) - 1] = '\0';
+            continue;
+        }
+        if (strncmp(arg, "--record=", 9) == 0) {
+            if (arg[9] == '\0') {
+                fprintf(stderr, "--record requires a path\n");
+                return false;
+            }
+            strncpy(config->record_file, arg + 9, sizeof(config->record_file) - 1);
+            config->record_file[sizeof(config->record_file) - 1] = '\0';
+            continue;
+        }
+        if (strncmp(arg, "--metrics-file=", 15) == 0) {
+            if (arg[15] == '\0' || strlen(arg + 15) >= sizeof(config->metrics_prefix) - 8) {
+                fprintf(stderr, "--metrics-file requires a path prefix\n");
+                return false;
+            }
+            strcpy(config->metrics_prefix, arg + 15);
+            continue;
+        }
+        if (strncmp(arg, "--trace=", 8) == 0) {
+            if (arg[8] == '\0' || strlen(arg + 8) >= sizeof(config->trace_file)) {
+                fprintf(stderr, "--trace requires a path\n");
+                return false;
+            }
+            strcpy(config->trace_file, arg + 8);
+            continue;
+        }
+        if (strncmp(arg, "--log-level=", 12) == 0) {
+            if (!parse_log_level(arg + 12, &config->log_level)) {
+                fprintf(stderr, "Invalid --log-level value: %s\n", arg + 12);
+                return false;
+            }
+            continue;
+        }
+        if (strncmp(arg, "--log-format=", 13) == 0) {
+            if (strcmp(arg + 13, "text") == 0) {
+                config->log_json = false;
+            } else if (strcmp(arg + 13, "json") == 0) {
+                config->log_json = true;
+            } else {
+                fprintf(stderr, "Invalid --log-format value: %s\n", arg + 13);
+                return false;
+            }
+            continue;
+        }
+        if (strcmp(arg, "--new-session") == 0) {
+            config->reuse_session = false;
+            continue;
+        }
+        if (strcmp(arg, "--transport-stats") == 0) {
+            config->transport_stats = true;
+            continue;
+        }
+        if (strcmp(arg, "--bench") == 0) {
+            config->bench = true;
+            continue;
+        }
+        if (strncmp(arg, "--bench-words=", 14) == 0) {
+            char *err = NULL;
+            if (!parse_word_count(arg + 14, &config->bench_words, &err)) {
+                fprintf(stderr, "Invalid --bench-words: %s\n", err ? err : arg);
+                free(err);
+                return false;
+            }
+            config->bench = true;
+            continue;
+        }
+        if (strncmp(arg, "--generate-dictionaries=", 24) == 0) {
+            if (arg[24] == '\0' || strlen(arg + 24) >= sizeof(config->generate_dir)) {
+                fprintf(stderr, "--generate-dictionaries requires a directory\n");
+                return false;
+            }
+            strcpy(config->generate_dir, arg + 24);
+            continue;
+        }
+        if (strncmp(arg, "--synthetic-words=", 18) == 0) {
+            char *err = NULL;
+            if (!parse_word_count(arg + 18, &config->synthetic_words, &err)) {
+                fprintf(stderr, "Invalid --synthetic-words: %s\n", err ? err : arg);
+                free(err);
+                return false;
+            }
+            continue;
+        }
+        if (strncmp(arg, "--word-lengths=", 15) == 0 || strncmp(arg, "--letter-weights=", 17) == 0) {
+            const bool letters = strncmp(arg, "--letter-weights=", 17) == 0;
+            char *err = NULL;
+            if (!parse_synthetic_weights(arg + (letters ? 17 : 15), letters, &config->synthetic, &err)) {
+                fprintf(stderr, "Invalid %s: %s\n", arg, err ? err : "bad value");
+                free(err);
+                return false;
+            }
+            continue;
+        }
+        if (strncmp(arg, "--synthetic-seed=", 17) == 0) {
+            char *end = NULL;
+            errno = 0;
+            config->synthetic.seed = strtoull(arg + 17, &end, 10);
+            if (end == arg + 17 || *end != '\0' || errno != 0) {
+                fprintf(stderr, "--synthetic-seed requires a number\n");
+                return false;
+            }
+            continue;
+        }
+        if (strcmp(arg, "--stress") == 0) {
+            static const uint64_t default_sizes[] = {1000000, 3000000, 10000000};
+            memcpy(config->stress_sizes, default_sizes, sizeof(default_sizes));
+            config->stress_count = ARRAY_LEN(default_sizes);
+            continue;
+        }
+        if (strncmp(arg, "--stress=", 9) == 0) {
+            config->stress_count = 0;
+            for (const char *p = arg + 9; *p;) {
+                const char *comma = strchr(p, ',');
+                size_t len = comma ? (size_t)(comma - p) : strlen(p);
+                char size[32];
+                char *err = NULL;
+                if (config->stress_count >= ARRAY_LEN(config->stress_sizes) || len >= sizeof(size)) {
+                    fprintf(stderr, "--stress takes at most %d sizes\n", MAX_STRESS_SIZES);
+                    return false;
+                }
+                memcpy(size, p, len);
+                size[len] = '\0';
+                if (!parse_word_count(size, &config->stress_sizes[config->stress_count++], &err)) {
+                    fprintf(stderr, "Invalid --stress: %s\n", err ? err : arg);
+                    free(err);
+                    return false;
+                }
+                p = comma ? comma + 1 : p + len;
+            }
+            if (config->stress_count == 0) {
+                fprintf(stderr, "--stress needs at least one size\n");
+                return false;
+            }
+            continue;
+        }
+        if (strncmp(arg, "--bench-decode=", 15) == 0) {
+            char *end = NULL;
+            long iterations = strtol(arg + 15, &end, 10);
+            if (end == arg + 15 || *end != '\0' || iterations <= 0 || iterations > 100000000L) {
+                fprintf(stderr, "--bench-decode requires a positive iteration count\n");
+                return false;
+            }
+            config->bench_decode_iterations = (int)iterations;
+            continue;
+        }
+        if (strncmp(arg, "--ready-timeout=", 16) == 0) {
+            char *end = NULL;
+            long seconds = strtol(arg + 16, &end, 10);
+            if (end == arg + 16 || *end != '\0' || seconds < 0 || seconds > 3600) {
+                fprintf(stderr, "--ready-timeout requires a non-negative number of seconds\n");
+                return false;
+            }
+            config->ready_timeout_seconds = (int)seconds;
+            continue;
+        }
+        if (strncmp(arg, "--pace-ms=", 10) == 0) {
+            char *end = NULL;
+            long ms = strtol(arg + 10, &end, 10);
+            if (end == arg + 10 || *end != '\0' || ms < 0 || ms > PACE_MAX_PAUSE_MS) {
+                fprintf(stderr, "--pace-ms requires a pause between 0 and %d ms\n", PACE_MAX_PAUSE_MS);
+                return false;
+            }
+            config->pace_ms = (int)ms;
+            continue;
+        }
+        fprintf(stderr, "Unknown argument: %s\n", arg);
+        return false;
+    }
+    return true;
+}
+
+// ---------- Dictionary loading ----------
+
+static int compare_strings(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+// Sorts `list` and frees repeated words, leaving it a set like the C++ port's std::set tiers.
+static void word_list_sort_unique(WordList *list) {
+    if (list->size < 2) return;
+    qsort(list->items, list->size, sizeof(char *), compare_strings);
+    size_t kept = 1;
+    for (size_t i = 1; i < list->size; ++i) {
+        if (strcmp(list->items[i], list->items[kept - 1]) == 0) {
+            free(list->items[i]);
+        } else {
+            list->items[kept++] = list->items[i];
+        }
+    }
+    list->size = kept;
+}
+
+// Adds the words of `path`, trimmed and lowercased, to `out_list`, which is left sorted and
+// without repeats (a word listed in two files of the same tier is kept once).
+static int load_word_file(const char *path, WordList *out_list) {
+    const double start = monotonic_ns();
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "failed to open dictionary file: %s (%s)\n", path, strerror(errno));
+        return -1;
+    }
+    char *line = NULL;
+    size_t cap = 0;
+    ssize_t len;
+    while ((len = getline(&line, &cap, fp)) != -1) {
+        (void)len;
+        trim_inplace(line);
+        if (line[0] == '\0') continue;
+        to_lower_inplace(line);
+        if (word_list_append_copy(out_list, line) != 0) {
+            fprintf(stderr, "out of memory loading dictionary words\n");
+            free(line);
+            fclose(fp);
+            return -1;
+        }
+    }
+    free(line);
+    fclose(fp);
+    word_list_sort_unique(out_list);
+    const char *name = strrchr(path, '/');
+    record_phase_since("dictionary_load", name ? name + 1 : path, start);
+    return 0;
+}
+
+static int load_word_dictionaries(const Config *config, WordDictionaries *dicts) {
+    word_list_init(&dicts->short_words);
+    word_list_init(&dicts->medium_words);
+    word_list_init(&dicts->extended_words);
+    word_list_init(&dicts->massive_words);
+
+    StringBuffer path;
+    string_buffer_init(&path);
+
+    if (string_buffer_append_format(&path, "%s/%s", config->dictionary_dir, "wordlist.txt") != 0 ||
+        load_word_file(path.data, &dicts->short_words) != 0) {
+        string_buffer_free(&path);
+        return -1;
+    }
+    path.length = 0; path.data[0] = '\0';
+    if (string_buffer_append_format(&path, "%s/%s", config->dictionary_dir, "wiki-100k.txt") != 0 ||
+        load_word_file(path.data, &dicts->medium_words) != 0) {
+        string_buffer_free(&path);
+        return -1;
+    }
+    path.length = 0; path.data[0] = '\0';
+    if (string_buffer_append_format(&path, "%s/%s", config->dictionary_dir, "words.txt") != 0 ||
+        load_word_file(path.data, &dicts->extended_words) != 0) {
+        string_buffer_free(&path);
+        return -1;
+    }
+    path.length = 0; path.data[0] = '\0';
+    if (string_buffer_append_format(&path, "%s/%s", config->dictionary_dir, "words400k.txt") != 0 ||
+        load_word_file(path.data, &dicts->extended_words) != 0) {
+        string_buffer_free(&path);
+        return -1;
+    }
+    path.length = 0; path.data[0] = '\0';
+    if (string_buffer_append_format(&path, "%s/%s", config->dictionary_dir, "wlist_match1.txt") != 0 ||
+        load_word_file(path.data, &dicts->massive_words) != 0) {
+        string_buffer_free(&path);
+        return -1;
+    }
+
+    string_buffer_free(&path);
+    return 0;
+}
+
+static void free_word_dictionaries(WordDictionaries *dicts) {
+    word_list_free(&dicts->short_words);
+    word_list_free(&dicts->medium_words);
+    word_list_free(&dicts->extended_words);
+    word_list_free(&dicts->massive_words);
+}
+
+// Delta segments are files named delta-*.txt beside the word lists. Each line is "+word",
+// adding a word to the massive list, or "-word", a tombstone removing one. Segments apply in
+// file name order on top of wlist_match1.txt, so the last line about a word wins, and are
+// merged at query time (LayeredWordIndex) instead of rebuilding the index. --add-words and
+// --remove-words write a segment; --compact-dictionaries folds them into wlist_match1.txt.
+#define DELTA_SEGMENT_PREFIX "delta-"
+#define DELTA_SEGMENT_SUFFIX ".txt"
+// Past this many layered changes, the solver folds the segments into wlist_match1.txt on
+// disk after its next run.
+#define COMPACT_AFTER_CHANGES 1024
+
+static bool is_delta_segment(const char *name) {
+    const size_t len = strlen(name);
+    const size_t prefix = strlen(DELTA_SEGMENT_PREFIX);
+    const size_t suffix = strlen(DELTA_SEGMENT_SUFFIX);
+    return len > prefix + suffix && strncmp(name, DELTA_SEGMENT_PREFIX, prefix) == 0 &&
+           strcmp(name + len - suffix, DELTA_SEGMENT_SUFFIX) == 0;
+}
+
+// Paths of the segments in `dir`, in the order they apply.
+static int list_delta_segments(const char *dir, WordList *out, char **err_out) {
+    word_list_init(out);
+    DIR *d = opendir(dir);
+    if (!d) {
+        set_error(err_out, "cannot list %s: %s", dir, strerror(errno));
+        return -1;
+    }
+    StringBuffer path;
+    string_buffer_init(&path);
+    int rc = 0;
+    struct dirent *entry;
+    while (rc == 0 && (entry = readdir(d)) != NULL) {
+        if (!is_delta_segment(entry->d_name)) continue;
+        path.length = 0;
+        if (string_buffer_append_format(&path, "%s/%s", dir, entry->d_name) != 0 ||
+            word_list_append_copy(out, path.data) != 0) {
+            set_error(err_out, "out of memory listing delta segments");
+            rc = -1;
+        }
+    }
+    closedir(d);
+    string_buffer_free(&path);
+    if (rc != 0) {
+        word_list_free(out);
+        return -1;
+    }
+    if (out->size > 1) qsort(out->items, out->size, sizeof(char *), compare_strings);
+    return 0;
+}
+
+static int compare_word_changes(const void *a, const void *b) {
+    const WordChange *x = (const WordChange *)a;
+    const WordChange *y = (const WordChange *)b;
+    const int c = strcmp(x->word, y->word);
+    if (c != 0) return c;
+    return (x->order > y->order) - (x->order < y->order);
+}
+
+static int compare_word_to_change(const void *key, const void *item) {
+    return strcmp((const char *)key, ((const WordChange *)item)->word);
+}
+
+// The change to `word` in settled `changes`, or NULL.
+static const WordChange *find_word_change(const WordChanges *changes, const char *word) {
+    if (changes->size == 0) return NULL;
+    return (const WordChange *)bsearch(word, changes->items, changes->size, sizeof(WordChange),
+                                       compare_word_to_change);
+}
+
+// Sorts by word and keeps only the last change to each, so lookups can bsearch.
+static void word_changes_settle(WordChanges *changes) {
+    if (changes->size == 0) return;
+    qsort(changes->items, changes->size, sizeof(WordChange), compare_word_changes);
+    size_t kept = 0;
+    for (size_t i = 0; i < changes->size; ++i) {
+        if (i + 1 < changes->size && strcmp(changes->items[i].word, changes->items[i + 1].word) == 0) {
+            free(changes->items[i].word);
+            continue;
+        }
+        changes->items[kept++] = changes->items[i];
+    }
+    changes->size = kept;
+}
+
+// Reads the segments of `dir` into `out`, settled.
+static int read_word_changes(const char *dir, WordChanges *out, char **err_out) {
+    *out = (WordChanges){0};
+    WordList segments;
+    if (list_delta_segments(dir, &segments, err_out) != 0) return -1;
+    char *line = NULL;
+    size_t cap = 0;
+    int rc = 0;
+    for (size_t s = 0; s < segments.size && rc == 0; ++s) {
+        FILE *fp = fopen(segments.items[s], "r");
+        if (!fp) {
+            set_error(err_out, "failed to open delta segment %s: %s", segments.items[s], strerror(errno));
+            rc = -1;
+            break;
+        }
+        while (rc == 0 && getline(&line, &cap, fp) != -1) {
+            trim_inplace(line);
+            if (line[0] != '+' && line[0] != '-') continue;
+            char *word = line + 1;
+            trim_inplace(word);
+            to_lower_inplace(word);
+            if (word[0] != '\0' && word_changes_append(out, word, line[0] == '+') != 0) {
+                set_error(err_out, "out of memory reading delta segments");
+                rc = -1;
+            }
+        }
+        fclose(fp);
+    }
+    free(line);
+    word_list_free(&segments);
+    if (rc != 0) {
+        word_changes_free(out);
+        return -1;
+    }
+    word_changes_settle(out);
+    return 0;
+}
+
+static void free_layered_word_index(LayeredWordIndex *index) {
+    free(index->removed);
+    index->removed = NULL;
+    index->removed_count = 0;
+    free_word_index(&index->added);
+    word_list_free(&index->added_words);
+}
+
+// Layers settled `changes` over `base` in one pass: each base word is looked up in the
+// changes, which are few, and flagged when removed; added words not already in the base are
+// indexed on their own.
+static int layer_word_changes(const WordIndex *base, const WordChanges *changes, LayeredWordIndex *out) {
+    out->base = base;
+    out->removed = NULL;
+    out->removed_count = 0;
+    word_list_init(&out->added_words);
+    bool *in_base = (bool *)calloc(changes->size ? changes->size : 1, sizeof(bool));
+    int rc = in_base ? 0 : -1;
+    for (size_t i = 0; changes->size && i < base->size && rc == 0; ++i) {
+        const WordChange *change = find_word_change(changes, base->words->items[i]);
+        if (!change) continue;
+        in_base[change - changes->items] = true;
+        if (change->present) continue;
+        if (!out->removed && !(out->removed = (bool *)calloc(base->size, sizeof(bool)))) {
+            rc = -1;
+            break;
+        }
+        out->removed[i] = true;
+        out->removed_count++;
+    }
+    for (size_t c = 0; c < changes->size && rc == 0; ++c) {
+        if (changes->items[c].present && !in_base[c]) {
+            rc = word_list_append_copy(&out->added_words, changes->items[c].word);
+        }
+    }
+    free(in_base);
+    if (rc == 0 && index_words(&out->added_words, &out->added) != 0) rc = -1;
+    if (rc != 0) {
+        free(out->removed);
+        out->removed = NULL;
+        word_list_free(&out->added_words);
+        return -1;
+    }
+    return 0;
+}
+
+// Frees `dst` and moves `src` into it, layered over `base`.
+static void adopt_layered_word_index(LayeredWordIndex *dst, LayeredWordIndex *src, const WordIndex *base) {
+    free_layered_word_index(dst);
+    *dst = *src;
+    dst->base = base;
+    dst->added.words = &dst->added_words;
+}
+
+static size_t layered_word_changes(const LayeredWordIndex *index) {
+    return index->removed_count + index->added.size;
+}
+
+// Reads the segments of the dictionary directory and layers them over `base`.
+static int load_word_changes(const Config *config, const WordIndex *base, LayeredWordIndex *out, char **err_out) {
+    WordChanges changes;
+    AllocPhase saved_phase = alloc_phase_enter(ALLOC_PHASE_LOAD);
+    int rc = read_word_changes(config->dictionary_dir, &changes, err_out);
+    if (rc == 0) {
+        rc = layer_word_changes(base, &changes, out);
+        if (rc != 0) set_error(err_out, "out of memory layering delta segments");
+        word_changes_free(&changes);
+    }
+    alloc_phase_leave(saved_phase);
+    return rc;
+}
+
+// Writes `changes` as a new segment named after the current time, so it sorts after the
+// existing ones. It is renamed into place, so a watcher never reads it half-written.
+static int write_delta_segment(const char *dir, const WordChanges *changes, StringBuffer *path, char **err_out) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    const long long stamp = (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+    StringBuffer tmp;
+    string_buffer_init(&tmp);
+    if (string_buffer_append_format(path, "%s/" DELTA_SEGMENT_PREFIX "%020lld" DELTA_SEGMENT_SUFFIX, dir, stamp) != 0 ||
+        string_buffer_append_format(&tmp, "%s/." DELTA_SEGMENT_PREFIX "%020lld" DELTA_SEGMENT_SUFFIX ".tmp", dir,
+                                    stamp) != 0) {
+        set_error(err_out, "out of memory");
+        string_buffer_free(&tmp);
+        return -1;
+    }
+    FILE *fp = fopen(tmp.data, "w");
+    int rc = fp ? 0 : -1;
+    for (size_t i = 0; fp && i < changes->size; ++i) {
+        fprintf(fp, "%c%s\n", changes->items[i].present ? '+' : '-', changes->items[i].word);
+    }
+    if (fp && (ferror(fp) | fclose(fp)) != 0) rc = -1;
+    if (rc == 0 && rename(tmp.data, path->data) != 0) rc = -1;
+    if (rc != 0) {
+        set_error(err_out, "cannot write %s: %s", tmp.data, strerror(errno));
+        remove(tmp.data);
+    }
+    string_buffer_free(&tmp);
+    return rc;
+}
+
+// Writes the words of `index` to `path`, sorted, through a temporary file renamed into place.
+static int write_layered_words(const char *path, const LayeredWordIndex *index, size_t *written, char **err_out) {
+    WordList words;
+    word_list_init(&words);
+    const size_t total = index->base->size - index->removed_count + index->added.size;
+    if (word_list_reserve(&words, total ? total : 1) != 0) {
+        set_error(err_out, "out of memory compacting the word list");
+        return -1;
+    }
+    // Borrowed, not copied: `words` only orders them, so its items are never freed.
+    for (size_t i = 0; i < index->base->size; ++i) {
+        if (!index->removed || !index->removed[i]) words.items[words.size++] = index->base->words->items[i];
+    }
+    for (size_t i = 0; i < index->added.size; ++i) words.items[words.size++] = index->added_words.items[i];
+    qsort(words.items, words.size, sizeof(char *), compare_strings);
+
+    StringBuffer tmp;
+    string_buffer_init(&tmp);
+    const char *name = strrchr(path, '/');
+    int rc = 0;
+    if (string_buffer_append_format(&tmp, "%.*s/.%s.tmp", (int)(name - path), path, name + 1) != 0) {
+        set_error(err_out, "out of memory");
+        rc = -1;
+    }
+    FILE *fp = rc == 0 ? fopen(tmp.data, "w") : NULL;
+    if (rc == 0 && !fp) rc = -1;
+    *written = 0;
+    for (size_t i = 0; fp && i < words.size; ++i) {
+        if (i > 0 && strcmp(words.items[i], words.items[i - 1]) == 0) continue;
+        fprintf(fp, "%s\n", words.items[i]);
+        ++*written;
+    }
+    if (fp && (ferror(fp) | fclose(fp)) != 0) rc = -1;
+    if (fp && rc == 0 && rename(tmp.data, path) != 0) rc = -1;
+    if (fp && rc != 0) {
+        set_error(err_out, "cannot write %s: %s", tmp.data, strerror(errno));
+        remove(tmp.data);
+    }
+    string_buffer_free(&tmp);
+    free(words.items);
+    return rc;
+}
+
+// Takes an exclusive flock on <dir>/.compact.lock, so that a solver and
+// --compact-dictionaries never fold the same segments at once. Sets *fd to the descriptor
+// to close() when done, or to -1 when `wait` is off and another process holds the lock.
+static int lock_compaction(const char *dir, bool wait, int *fd, char **err_out) {
+    StringBuffer path;
+    string_buffer_init(&path);
+    *fd = -1;
+    if (string_buffer_append_format(&path, "%s/.compact.lock", dir) != 0) {
+        set_error(err_out, "out of memory");
+        return -1;
+    }
+    int rc = 0;
+    const int lock_fd = open(path.data, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lock_fd < 0) {
+        set_error(err_out, "cannot open %s: %s", path.data, strerror(errno));
+        rc = -1;
+    }
+    while (rc == 0 && flock(lock_fd, LOCK_EX | (wait ? 0 : LOCK_NB)) != 0) {
+        if (errno == EINTR) continue;
+        if (errno != EWOULDBLOCK) {
+            set_error(err_out, "cannot lock %s: %s", path.data, strerror(errno));
+            rc = -1;
+        }
+        close(lock_fd);
+        string_buffer_free(&path);
+        return rc;
+    }
+    if (rc == 0) *fd = lock_fd;
+    string_buffer_free(&path);
+    return rc;
+}
+
+typedef struct {
+    size_t segments;
+    size_t added;
+    size_t removed;
+    size_t words;
+} FoldResult;
+
+// Folds every delta segment in `dir` into wlist_match1.txt (sorted, one word per line) and
+// deletes them. Only the segments listed here are deleted, so one an --add-words writes
+// meanwhile survives and still applies on top. The caller holds the compaction lock.
+static int fold_delta_segments(const Config *config, FoldResult *result, char **err_out) {
+    const char *dir = config->dictionary_dir;
+    memset(result, 0, sizeof(*result));
+    WordList segments;
+    if (list_delta_segments(dir, &segments, err_out) != 0) return -1;
+    if (segments.size == 0) {
+        word_list_free(&segments);
+        return 0;
+    }
+    StringBuffer path;
+    string_buffer_init(&path);
+    WordList base_words;
+    word_list_init(&base_words);
+    WordIndex base;
+    LayeredWordIndex layered;
+    int rc = 0;
+    if (string_buffer_append_format(&path, "%s/wlist_match1.txt", dir) != 0) {
+        set_error(err_out, "out of memory");
+        rc = -1;
+    } else if (load_word_file(path.data, &base_words) != 0) {
+        set_error(err_out, "cannot read %s", path.data);
+        rc = -1;
+    } else if (index_words(&base_words, &base) != 0) {
+        set_error(err_out, "out of memory indexing %s", path.data);
+        rc = -1;
+    } else {
+        rc = load_word_changes(config, &base, &layered, err_out);
+        if (rc == 0) {
+            rc = write_layered_words(path.data, &layered, &result->words, err_out);
+            if (rc == 0) {
+                for (size_t i = 0; i < segments.size; ++i) remove(segments.items[i]);
+                result->segments = segments.size;
+                result->added = layered.added.size;
+                result->removed = layered.removed_count;
+            }
+            free_layered_word_index(&layered);
+        }
+        free_word_index(&base);
+    }
+    word_list_free(&base_words);
+    word_list_free(&segments);
+    string_buffer_free(&path);
+    return rc;
+}
+
+// Writes the --add-words / --remove-words segment, then with --compact-dictionaries folds
+// every segment into wlist_match1.txt, waiting for a running solver's fold to finish first.
+static int run_dictionary_update(const Config *config) {
+    const char *dir = config->dictionary_dir;
+    char *err = NULL;
+    StringBuffer path;
+    string_buffer_init(&path);
+    int rc = 0;
+    if (config->word_changes.size > 0) {
+        rc = write_delta_segment(dir, &config->word_changes, &path, &err);
+        if (rc == 0) printf("Wrote %zu word changes to %s\n", config->word_changes.size, path.data);
+    }
+    int lock_fd = -1;
+    if (rc == 0 && config->compact_dictionaries) rc = lock_compaction(dir, true, &lock_fd, &err);
+    FoldResult folded;
+    if (rc == 0 && config->compact_dictionaries && (rc = fold_delta_segments(config, &folded, &err)) == 0) {
+        if (folded.segments == 0) {
+            printf("No delta segments to compact in %s.\n", dir);
+        } else {
+            printf("Folded %zu delta segments into %s/wlist_match1.txt (%zu added, %zu removed, %zu words).\n",
+                   folded.segments, dir, folded.added, folded.removed, folded.words);
+        }
+    }
+    if (lock_fd >= 0) close(lock_fd);
+    if (rc != 0) log_at(LOG_LEVEL_FATAL, "%s", err ? err : "cannot update the word lists");
+    free(err);
+    string_buffer_free(&path);
+    return rc == 0 ? 0 : 1;
+}
+
+// The solver's own fold, run between attempts once the segments make more than
+// COMPACT_AFTER_CHANGES changes; skipped while another process folds them. The new list
+// landing is a list change, which the next poll reloads.
+static void compact_word_changes(const Config *config, const LayeredWordIndex *index) {
+    const size_t changes = layered_word_changes(index);
+    if (changes <= COMPACT_AFTER_CHANGES) return;
+    const double start = monotonic_ns();
+    char *err = NULL;
+    int lock_fd = -1;
+    FoldResult folded = {0};
+    int rc = lock_compaction(config->dictionary_dir, false, &lock_fd, &err);
+    if (rc == 0 && lock_fd >= 0) {
+        rc = fold_delta_segments(config, &folded, &err);
+        close(lock_fd);
+    }
+    if (rc != 0) {
+        log_at(LOG_LEVEL_WARN, "Could not fold the delta segments in %s into wlist_match1.txt (%s); they are still "
+               "layered at every load.", config->dictionary_dir, err ? err : "unknown error");
+    } else if (folded.segments > 0) {
+        log_at(LOG_LEVEL_INFO, "Folded %zu delta segments (%zu word changes) into wlist_match1.txt in %.0f ms",
+               folded.segments, changes, (monotonic_ns() - start) / 1e6);
+    }
+    free(err);
+}
+
+// Between runs the word list directory is checked for changes through a non-blocking
+// inotify descriptor; once writes to the lists have settled they are loaded and indexed
+// again and swapped in for the next run. The port is single-threaded, so the rebuild
+// happens there rather than on a background thread. A reload that fails, say on a list
+// caught half-written, is logged and the current lists kept. A new or removed delta
+// segment only re-layers the segments over the current index.
+#define DICTIONARY_SETTLE_MS 500
+#define DICTIONARY_WATCH_EVENTS \
+    (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM | IN_DELETE_SELF | IN_MOVE_SELF)
+
+typedef enum {
+    DICTIONARY_UNCHANGED,
+    DICTIONARY_SEGMENTS_CHANGED,
+    DICTIONARY_LISTS_CHANGED,   // the segments are read again along with the lists
+} DictionaryChange;
+
+typedef struct {
+    int fd;                 // inotify descriptor, -1 when not watching
+    const char *dir;
+    bool lists_changed;     // a list changed since the last reload
+    bool segments_changed;  // a delta segment appeared or went since the last layering
+    double last_change_ns;
+} DictionaryWatch;
+
+static void dictionary_watch_start(DictionaryWatch *watch, const char *dir) {
+    watch->dir = dir;
+    watch->lists_changed = false;
+    watch->segments_changed = false;
+    watch->last_change_ns = 0;
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd >= 0 && inotify_add_watch(watch->fd, dir, DICTIONARY_WATCH_EVENTS) >= 0) return;
+    log_at(LOG_LEVEL_WARN, "Cannot watch %s for word list changes: %s", dir, strerror(errno));
+    if (watch->fd >= 0) close(watch->fd);
+    watch->fd = -1;
+}
+
+static void dictionary_watch_stop(DictionaryWatch *watch) {
+    if (watch->fd >= 0) close(watch->fd);
+    watch->fd = -1;
+}
+
+static bool is_word_list_file(const char *name) {
+    for (size_t i = 0; i < ARRAY_LEN(LIST_FILES); ++i) {
+        if (strcmp(name, LIST_FILES[i]) == 0) return true;
+    }
+    return false;
+}
+
+// Drains the queued events. Lists count as changed once none has been touched for
+// DICTIONARY_SETTLE_MS, waiting out the rest of that time if needed; segments are renamed
+// into place whole, so they count at once.
+static DictionaryChange dictionary_watch_poll(DictionaryWatch *watch) {
+    while (watch->fd >= 0) {
+        _Alignas(struct inotify_event) char buf[4096];
+        ssize_t n;
+        while ((n = read(watch->fd, buf, sizeof(buf))) > 0) {
+            for (ssize_t offset = 0; offset < n;) {
+                const struct inotify_event *event = (const struct inotify_event *)(buf + offset);
+                offset += (ssize_t)(sizeof(struct inotify_event) + event->len);
+                if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                    log_at(LOG_LEVEL_WARN, "%s was moved or removed; word list changes are no longer picked up.",
+                           watch->dir);
+                    dictionary_watch_stop(watch);
+                    return DICTIONARY_UNCHANGED;
+                }
+                if (event->len && is_word_list_file(event->name)) {
+                    watch->lists_changed = true;
+                    watch->last_change_ns = monotonic_ns();
+                } else if (event->len && is_delta_segment(event->name)) {
+                    watch->segments_changed = true;
+                }
+            }
+        }
+        if (!watch->lists_changed) {
+            const bool segments_changed = watch->segments_changed;
+            watch->segments_changed = false;
+            return segments_changed ? DICTIONARY_SEGMENTS_CHANGED : DICTIONARY_UNCHANGED;
+        }
+        const double quiet_ms = (monotonic_ns() - watch->last_change_ns) / 1e6;
+        if (quiet_ms >= DICTIONARY_SETTLE_MS) {
+            watch->lists_changed = false;
+            watch->segments_changed = false;
+            return DICTIONARY_LISTS_CHANGED;
+        }
+        sleep_ms((long)(DICTIONARY_SETTLE_MS - quiet_ms) + 1);
+    }
+    return DICTIONARY_UNCHANGED;
+}
+
+// Layers the segments again over the current base index; on failure `index` is kept.
+static int relayer_word_changes(const Config *config, LayeredWordIndex *index, char **err_out) {
+    const double start = monotonic_ns();
+    LayeredWordIndex fresh;
+    if (load_word_changes(config, index->base, &fresh, err_out) != 0) return -1;
+    adopt_layered_word_index(index, &fresh, index->base);
+    log_at(LOG_LEVEL_INFO, "Applied delta segments from %s (%zu word changes) in %.0f ms", config->dictionary_dir,
+           layered_word_changes(index), (monotonic_ns() - start) / 1e6);
+    return 0;
+}
+
+// Loads and indexes the lists again and layers the segments over them; only when that
+// succeeds are `dicts`, `index` and `layered` freed and replaced.
+static int reload_word_dictionaries(const Config *config, WordDictionaries *dicts, WordIndex *index,
+                                    LayeredWordIndex *layered, char **err_out) {
+    const double start = monotonic_ns();
+    WordDictionaries fresh;
+    WordIndex fresh_index;
+    LayeredWordIndex fresh_layered;
+    AllocPhase saved_phase = alloc_phase_enter(ALLOC_PHASE_LOAD);
+    int rc = load_word_dictionaries(config, &fresh);
+    if (rc != 0) {
+        set_error(err_out, "cannot read the word lists");
+    } else if (fresh.massive_words.size == 0) {
+        set_error(err_out, "word list 'wlist_match1.txt' is empty");
+        rc = -1;
+    } else if (build_word_index(&fresh.massive_words, &fresh_index) != 0) {
+        set_error(err_out, "out of memory building word index");
+        rc = -1;
+    } else if (load_word_changes(config, &fresh_index, &fresh_layered, err_out) != 0) {
+        free_word_index(&fresh_index);
+        rc = -1;
+    }
+    alloc_phase_leave(saved_phase);
+    if (rc != 0) {
+        free_word_dictionaries(&fresh);
+        return -1;
+    }
+    free_word_index(index);
+    free_word_dictionaries(dicts);
+    *dicts = fresh;
+    *index = fresh_index;
+    index->words = &dicts->massive_words;   // the index borrowed the local copy's list
+    adopt_layered_word_index(layered, &fresh_layered, index);
+    log_at(LOG_LEVEL_INFO, "Reloaded word lists from %s (massive set size: %zu) in %.0f ms", config->dictionary_dir,
+           dicts->massive_words.size, (monotonic_ns() - start) / 1e6);
+    return 0;
+}
+
+// ---------- Membership ----------
+
+static uint64_t hash_word(const char *word) {
+    uint64_t h = UINT64_C(14695981039346656037);   // FNV-1a
+    for (; *word; ++word) {
+        h ^= (unsigned char)*word;
+        h *= UINT64_C(1099511628211);
+    }
+    return h;
+}
+
+static void membership_add_tier(MembershipTable *table, const WordList *words, uint8_t tier) {
+    for (size_t w = 0; w < words->size; ++w) {
+        const char *word = words->items[w];
+        const uint64_t h = hash_word(word);
+        for (size_t i = h & table->slot_mask;; i = (i + 1) & table->slot_mask) {
+            MembershipSlot *slot = &table->slots[i];
+            if (slot->tiers == 0) {
+                slot->hash = h;
+                slot->word = word;
+                slot->tiers = tier;
+                table->count++;
+                break;
+            }
+            if (slot->hash == h && strcmp(slot->word, word) == 0) {
+                slot->tiers |= tier;
+                break;
+            }
+        }
+    }
+}
+
+// Flat open-addressing table (linear probing, load factor <= 0.5) mapping each word of
+// every tier to the bitmask of tiers containing it.
+static int membership_table_build(MembershipTable *table, const WordDictionaries *dicts) {
+    const size_t total = dicts->short_words.size + dicts->medium_words.size +
+                         dicts->extended_words.size + dicts->massive_words.size;
+    size_t capacity = 16;
+    while (capacity < total * 2) capacity <<= 1;
+    table->slots = (MembershipSlot *)calloc(capacity, sizeof(MembershipSlot));
+    if (!table->slots) return -1;
+    table->slot_mask = capacity - 1;
+    table->count = 0;
+    membership_add_tier(table, &dicts->short_words, TIER_SHORT);
+    membership_add_tier(table, &dicts->medium_words, TIER_MEDIUM);
+    membership_add_tier(table, &dicts->extended_words, TIER_EXTENDED);
+    membership_add_tier(table, &dicts->massive_words, TIER_MASSIVE);
+    return 0;
+}
+
+static void membership_table_free(MembershipTable *table) {
+    free(table->slots);
+    table->slots = NULL;
+    table->slot_mask = 0;
+    table->count = 0;
+}
+
+static uint8_t membership_probe(const MembershipTable *table, uint64_t h, const char *word) {
+    for (size_t i = h & table->slot_mask;; i = (i + 1) & table->slot_mask) {
+        const MembershipSlot *slot = &table->slots[i];
+        if (slot->tiers == 0) return 0;
+        if (slot->hash == h && strcmp(slot->word, word) == 0) return slot->tiers;
+    }
+}
+
+// Hashes a block of words and prefetches their home slots before probing so the cache
+// misses overlap. Words must be lowercase. When `letters` is non-NULL, TIER_HIVE_LEGAL is
+// added for words that are legal in that hive.
+static void membership_lookup_batch(const MembershipTable *table,
+                                    char *const *words,
+                                    size_t count,
+                                    const char *letters,
+                                    uint8_t *out_bits) {
+    enum { BLOCK = 16 };
+    uint64_t hashes[BLOCK];
+    const uint32_t allowed = letters ? letter_mask(letters, NULL) : 0;
+    const uint32_t required = letters ? LETTER_BIT(letters[6]) : 0;
+    for (size_t base = 0; base < count; base += BLOCK) {
+        const size_t n = count - base < BLOCK ? count - base : BLOCK;
+        for (size_t j = 0; j < n; ++j) {
+            hashes[j] = hash_word(words[base + j]);
+            __builtin_prefetch(&table->slots[hashes[j] & table->slot_mask]);
+        }
+        for (size_t j = 0; j < n; ++j) {
+            const char *word = words[base + j];
+            uint8_t bits = membership_probe(table, hashes[j], word);
+            if (letters) {
+                size_t len = 0;
+                const uint32_t mask = letter_mask(word, &len);
+                if (hive_accepts(mask, (uint32_t)len, allowed, required)) bits |= TIER_HIVE_LEGAL;
+            }
+            out_bits[base + j] = bits;
+        }
     }
-    return true;
 }
 
-// ---------- Dictionary loading ----------
+static void describe_tiers(uint8_t bits, char *out, size_t out_size) {
+    static const struct { uint8_t bit; const char *name; } names[] = {
+        {TIER_SHORT, "short"}, {TIER_MEDIUM, "medium"}, {TIER_EXTENDED, "extended"},
+        {TIER_MASSIVE, "massive"}, {TIER_HIVE_LEGAL, "hive"}};
+    size_t used = 0;
+    out[0] = '\0';
+    for (size_t i = 0; i < ARRAY_LEN(names); ++i) {
+        if (!(bits & names[i].bit)) continue;
+        int n = snprintf(out + used, out_size - used, "%s%s", used ? "," : "", names[i].name);
+        if (n < 0 || (size_t)n >= out_size - used) break;
+        used += (size_t)n;
+    }
+    if (used == 0) snprintf(out, out_size, "-");
+}
 
-static int load_word_file(const char *path, WordList *out_list) {
-    FILE *fp = fopen(path, "r");
+static int run_membership_check(const Config *config, const WordDictionaries *dicts) {
+    const bool from_stdin = strcmp(config->check_words_file, "-") == 0;
+    FILE *fp = from_stdin ? stdin : fopen(config->check_words_file, "r");
     if (!fp) {
-        fprintf(stderr, "failed to open dictionary file: %s (%s)\n", path, strerror(errno));
-        return -1;
+        log_at(LOG_LEVEL_FATAL, "failed to open word list: %s (%s)", config->check_words_file, strerror(errno));
+        return 1;
     }
+    WordList words;
+    word_list_init(&words);
     char *line = NULL;
     size_t cap = 0;
-    ssize_t len;
-    while ((len = getline(&line, &cap, fp)) != -1) {
-        (void)len;
+    int rc = 0;
+    while (getline(&line, &cap, fp) != -1) {
         trim_inplace(line);
         if (line[0] == '\0') continue;
         to_lower_inplace(line);
-        if (word_list_append_copy(out_list, line) != 0) {
-            fprintf(stderr, "out of memory loading dictionary words\n");
-            free(line);
-            fclose(fp);
-            return -1;
+        if (word_list_append_copy(&words, line) != 0) {
+            rc = -1;
+            break;
         }
     }
     free(line);
-    fclose(fp);
-    return 0;
-}
-
-static int load_word_dictionaries(const Config *config, WordDictionaries *dicts) {
-    word_list_init(&dicts->short_words);
-    word_list_init(&dicts->medium_words);
-    word_list_init(&dicts->extended_words);
-    word_list_init(&dicts->massive_words);
+    if (!from_stdin) fclose(fp);
 
-    StringBuffer path;
-    string_buffer_init(&path);
-
-    if (string_buffer_append_format(&path, "%s/%s", config->dictionary_dir, "wordlist.txt") != 0 ||
-        load_word_file(path.data, &dicts->short_words) != 0) {
-        string_buffer_free(&path);
-        return -1;
-    }
-    path.length = 0; path.data[0] = '\0';
-    if (string_buffer_append_format(&path, "%s/%s", config->dictionary_dir, "wiki-100k.txt") != 0 ||
-        load_word_file(path.data, &dicts->medium_words) != 0) {
-        string_buffer_free(&path);
-        return -1;
+    // The delta segments override the massive tier bit of the words they name, as in the solver.
+    WordChanges changes = {0};
+    char *err = NULL;
+    if (rc == 0 && read_word_changes(config->dictionary_dir, &changes, &err) != 0) {
+        log_at(LOG_LEVEL_FATAL, "%s", err ? err : "cannot read delta segments");
+        free(err);
+        word_list_free(&words);
+        return 1;
     }
-    path.length = 0; path.data[0] = '\0';
-    if (string_buffer_append_format(&path, "%s/%s", config->dictionary_dir, "words.txt") != 0 ||
-        load_word_file(path.data, &dicts->extended_words) != 0) {
-        string_buffer_free(&path);
-        return -1;
+    MembershipTable table;
+    uint8_t *bits = (uint8_t *)malloc(words.size ? words.size : 1);
+    if (rc != 0 || !bits || membership_table_build(&table, dicts) != 0) {
+        log_at(LOG_LEVEL_FATAL, "out of memory checking words");
+        free(bits);
+        word_changes_free(&changes);
+        word_list_free(&words);
+        return 1;
     }
-    path.length = 0; path.data[0] = '\0';
-    if (string_buffer_append_format(&path, "%s/%s", config->dictionary_dir, "words400k.txt") != 0 ||
-        load_word_file(path.data, &dicts->extended_words) != 0) {
-        string_buffer_free(&path);
-        return -1;
+    membership_lookup_batch(&table, words.items, words.size,
+                            config->has_cli_letters ? config->letters_cli : NULL, bits);
+    for (size_t i = 0; i < words.size; ++i) {
+        const WordChange *change = find_word_change(&changes, words.items[i]);
+        if (change) bits[i] = change->present ? (uint8_t)(bits[i] | TIER_MASSIVE) : (uint8_t)(bits[i] & ~TIER_MASSIVE);
     }
-    path.length = 0; path.data[0] = '\0';
-    if (string_buffer_append_format(&path, "%s/%s", config->dictionary_dir, "wlist_match1.txt") != 0 ||
-        load_word_file(path.data, &dicts->massive_words) != 0) {
-        string_buffer_free(&path);
-        return -1;
+    word_changes_free(&changes);
+    for (size_t i = 0; i < words.size; ++i) {
+        char names[64];
+        describe_tiers(bits[i], names, sizeof(names));
+        printf("%s\t%u\t%s\n", words.items[i], (unsigned)bits[i], names);
     }
-
-    string_buffer_free(&path);
+    fflush(stdout);
+    fprintf(stderr, "%zu words checked against %zu dictionary entries.\n", words.size, table.count);
+    membership_table_free(&table);
+    free(bits);
+    word_list_free(&words);
     return 0;
 }
 
-static void free_word_dictionaries(WordDictionaries *dicts) {
-    word_list_free(&dicts->short_words);
-    word_list_free(&dicts->medium_words);
-    word_list_free(&dicts->extended_words);
-    word_list_free(&dicts->massive_words);
-}
-
 // ---------- Operation wrappers ----------
 
 static int op_new_session(void *ctx, char **err_out) {
@@ -1383,7 +4432,10 @@ typedef struct {
 
 static int op_read_letters(void *ctx, char **err_out) {
     LettersCtx *lc = (LettersCtx *)ctx;
-    return read_letters_from_board(lc->wd, lc->letters, err_out);
+    const double start = monotonic_ns();
+    int rc = read_letters_from_board(lc->wd, lc->letters, err_out);
+    record_phase_since("board_read", "blocking", start);
+    return rc;
 }
 
 typedef struct {
@@ -1403,24 +4455,37 @@ static int op_focus_hive(void *ctx, char **err_out) {
 typedef struct {
     WD *wd;
     const WordList *words;
+    int pause_ms;
+    PacingOutcome outcome;
 } SendWordsCtx;
 
 static int op_send_words(void *ctx, char **err_out) {
     SendWordsCtx *sw = (SendWordsCtx *)ctx;
-    return wd_send_all_words_as_keys(sw->wd, sw->words, err_out);
+    const double start = monotonic_ns();
+    if (sw->pause_ms < 0) {
+        int rc = wd_send_words_as_keys(sw->wd, sw->words->items, sw->words->size, 0, err_out);
+        record_phase_since("submit", "actions", start);
+        return rc;
+    }
+    int rc = send_words_paced(sw->wd, sw->words, &sw->pause_ms, &sw->outcome, err_out);
+    record_phase_since("submit", "paced", start);
+    return rc;
 }
 
 // ---------- Attempt runner ----------
 
-static AttemptResult run_attempt(WD *wd,
-                                 bool have_session,
-                                 bool do_full_setup,
-                                 int attempt_index,
-                                 const Config *config,
-                                 const WordDictionaries *dicts) {
+static AttemptResult run_attempt_steps(WD *wd,
+                                       bool have_session,
+                                       bool do_full_setup,
+                                       int attempt_index,
+                                       const Config *config,
+                                       const LayeredWordIndex *index) {
     AttemptResult result = {0};
     WordList words_upper;
     word_list_init(&words_upper);
+    ScoreSummary score;
+    score.max_score = 0;
+    word_list_init(&score.pangrams);
     char letters[8] = {0};
 
     bool quit = false;
@@ -1428,7 +4493,7 @@ static AttemptResult run_attempt(WD *wd,
     do_full_setup = do_full_setup || !have_session;
 
     if (!session_active) {
-        StepResult sr = retry_with_pause("start session", op_new_session, wd);
+        StepResult sr = retry_with_pause("start session", RETRY_BUDGET_SESSION, wd->session, op_new_session, wd);
         if (sr == STEP_RESULT_QUIT) {
             quit = true;
         } else if (sr == STEP_RESULT_OK) {
@@ -1447,22 +4512,34 @@ static AttemptResult run_attempt(WD *wd,
     }
 
     if (!quit && do_full_setup) {
-        NavigateCtx nav = {.wd = wd, .url = "https://www.nytimes.com/puzzles/spelling-bee"};
-        StepResult sr = retry_with_pause("navigate", op_navigate, &nav);
+        NavigateCtx nav = {.wd = wd, .url = SPELLING_BEE_URL};
+        StepResult sr = retry_with_pause("navigate", RETRY_BUDGET_NAVIGATE, wd->session, op_navigate, &nav);
         if (sr == STEP_RESULT_QUIT || sr == STEP_RESULT_SKIP) quit = true;
     }
 
     if (!quit && do_full_setup) {
         ResizeCtx rs = {.wd = wd, .width = 1680, .height = 939};
-        StepResult sr = retry_with_pause("resize window", op_resize, &rs);
+        StepResult sr = retry_with_pause("resize window", RETRY_BUDGET_RESIZE, wd->session, op_resize, &rs);
         if (sr == STEP_RESULT_QUIT || sr == STEP_RESULT_SKIP) quit = true;
     }
 
     if (!quit) {
         if (do_full_setup) {
-            pause_banner("Browser ready? Clear modals/login, then press Enter to begin.");
-            char dummy[8];
-            prompt_line("> ", dummy, sizeof(dummy));
+            bool ready = false;
+            if (config->ready_timeout_seconds > 0) {
+                TraceSpan span;
+                trace_begin(&span, "step", "wait for board");
+                ready = wait_for_board_ready(wd, config->ready_timeout_seconds);
+                trace_end(&span);
+            }
+            if (!ready) {
+                if (config->ready_timeout_seconds > 0) {
+                    log_at(LOG_LEVEL_WARN, "Board not ready after %ds; asking instead.", config->ready_timeout_seconds);
+                }
+                pause_banner("Browser ready? Clear modals/login, then press Enter to begin.");
+                char dummy[8];
+                prompt_line("> ", dummy, sizeof(dummy));
+            }
         } else {
             printf("\n--- Restarting word list (attempt %d) ---\n", attempt_index);
             fflush(stdout);
@@ -1471,7 +4548,7 @@ static AttemptResult run_attempt(WD *wd,
 
     if (!quit) {
         FocusCtx fc = {.wd = wd};
-        StepResult sr = retry_with_pause("focus hive", op_focus_hive, &fc);
+        StepResult sr = retry_with_pause("focus hive", RETRY_BUDGET_FOCUS, wd->session, op_focus_hive, &fc);
         if (sr == STEP_RESULT_QUIT || sr == STEP_RESULT_SKIP) quit = true;
     }
 
@@ -1480,7 +4557,7 @@ static AttemptResult run_attempt(WD *wd,
             memcpy(letters, config->letters_cli, sizeof(letters));
         } else {
             LettersCtx lc = {.wd = wd};
-            StepResult sr = retry_with_pause("read hive letters", op_read_letters, &lc);
+            StepResult sr = retry_with_pause("read hive letters", RETRY_BUDGET_READ_LETTERS, wd->session, op_read_letters, &lc);
             if (sr == STEP_RESULT_QUIT || sr == STEP_RESULT_SKIP) {
                 quit = true;
             } else if (sr == STEP_RESULT_OK) {
@@ -1496,10 +4573,19 @@ static AttemptResult run_attempt(WD *wd,
     }
 
     if (!quit) {
-        if (find_valid_words(&dicts->massive_words, letters, &words_upper) != 0) {
+        TraceSpan span;
+        trace_begin(&span, "step", "solve");
+        trace_arg_string(&span, "letters", letters);
+        AllocPhase saved_phase = alloc_phase_enter(ALLOC_PHASE_SOLVE);
+        int rc = find_layered_words(index, letters, &words_upper, &score);
+        alloc_phase_leave(saved_phase);
+        trace_end(&span);
+        if (rc != 0) {
             result.fatal_error = true;
             result.fatal_message = strdup("failed to compute valid words");
             quit = true;
+        } else {
+            result.projected_score = score.max_score;
         }
     }
 
@@ -1512,22 +4598,617 @@ static AttemptResult run_attempt(WD *wd,
         char center_display = (char)toupper((unsigned char)letters[6]);
         printf("Letters: %s (center %c)\n", outer_display, center_display);
         printf("Generated %zu candidate words.\n", words_upper.size);
+        printf("Projected max score: %lu (%zu pangrams", score.max_score, score.pangrams.size);
+        for (size_t i = 0; i < score.pangrams.size; ++i) {
+            printf("%s%s", i == 0 ? ": " : ", ", score.pangrams.items[i]);
+        }
+        printf(")\n");
         fflush(stdout);
     }
 
     if (!quit) {
-        SendWordsCtx sw = {.wd = wd, .words = &words_upper};
-        StepResult sr = retry_with_pause("send words", op_send_words, &sw);
+        SendWordsCtx sw = {.wd = wd, .words = &words_upper, .pause_ms = config->pace_ms};
+        StepResult sr = retry_with_pause("send words", RETRY_BUDGET_SEND_WORDS, wd->session, op_send_words, &sw);
         if (sr == STEP_RESULT_QUIT) quit = true;
+        if (sr == STEP_RESULT_OK && sw.pause_ms >= 0) print_pacing_outcome(&sw.outcome);
     }
 
     result.session_active = wd_has_session(wd);
     result.user_quit = quit;
 
     word_list_free(&words_upper);
+    word_list_free(&score.pangrams);
+    return result;
+}
+
+static AttemptResult run_attempt(WD *wd,
+                                 bool have_session,
+                                 bool do_full_setup,
+                                 int attempt_index,
+                                 const Config *config,
+                                 const LayeredWordIndex *index) {
+    TraceSpan span;
+    trace_begin(&span, "run", NULL);
+    if (span.active) snprintf(span.name, sizeof(span.name), "run_attempt %d", attempt_index);
+    trace_arg_bool(&span, "full_setup", do_full_setup || !have_session);
+    AttemptResult result = run_attempt_steps(wd, have_session, do_full_setup, attempt_index, config, index);
+    trace_arg_bool(&span, "user_quit", result.user_quit);
+    if (result.fatal_error) trace_arg_string(&span, "fatal", result.fatal_message ? result.fatal_message : "");
+    trace_end(&span);
     return result;
 }
 
+// ---------- Decode benchmark ----------
+// Replies as chromedriver sends them, each with the field the client reads from it and
+// what that field decodes to.
+typedef struct {
+    const char *name;
+    const char *body;
+    const char *path[2];
+    size_t depth;
+    const char *expected;
+} DecodeBenchCase;
+
+static const DecodeBenchCase DECODE_BENCH_CASES[] = {
+    {"find_element",
+     "{\"value\":{\"" WD_ELEMENT_KEY "\":\"f.2D4C3A1B6E5F7A8B9C0D1E2F3A4B5C6D.d.9E8F7A6B5C4D3E2F1A0B9C8D7E6F5A4B.e.42\"}}",
+     {"value", WD_ELEMENT_KEY}, 2, "f.2D4C3A1B6E5F7A8B9C0D1E2F3A4B5C6D.d.9E8F7A6B5C4D3E2F1A0B9C8D7E6F5A4B.e.42"},
+    {"element_text", "{\"value\":\"G\"}", {"value"}, 1, "G"},
+    {"attribute_escaped", "{\"value\":\"hive-cell center \\\"g\\\" \\u00e9\\ud83d\\udc1d\"}", {"value"}, 1,
+     "hive-cell center \"g\" \xc3\xa9\xf0\x9f\x90\x9d"},
+    {"current_url", "{\"value\":\"https:\\/\\/www.nytimes.com\\/puzzles\\/spelling-bee\"}", {"value"}, 1,
+     "https://www.nytimes.com/puzzles/spelling-bee"},
+    {"new_session",
+     "{\"value\":{\"capabilities\":{\"acceptInsecureCerts\":false,\"browserName\":\"chrome\",\"browserVersion\":\"126.0.6478.126\","
+     "\"chrome\":{\"chromedriverVersion\":\"126.0.6478.126 (d36ace6122e0a59570e258d82441395206d60e1c-refs/branch-heads/6478@{#1591})\","
+     "\"userDataDir\":\"/tmp/.org.chromium.Chromium.w2P1kq\"},\"fedcm:accounts\":true,"
+     "\"goog:chromeOptions\":{\"debuggerAddress\":\"localhost:40193\"},\"networkConnectionEnabled\":false,"
+     "\"pageLoadStrategy\":\"normal\",\"platformName\":\"linux\",\"proxy\":{},\"setWindowRect\":true,"
+     "\"strictFileInteractability\":false,\"timeouts\":{\"implicit\":0,\"pageLoad\":300000,\"script\":30000},"
+     "\"unhandledPromptBehavior\":\"dismiss and notify\",\"webauthn:extension:credBlob\":true,"
+     "\"webauthn:extension:largeBlob\":true,\"webauthn:extension:minPinLength\":true,"
+     "\"webauthn:extension:prf\":true,\"webauthn:virtualAuthenticators\":true},"
+     "\"sessionId\":\"8c3f4b7e2d1a9f6e5c4b3a2d1e0f9a8b\"}}",
+     {"value", "sessionId"}, 2, "8c3f4b7e2d1a9f6e5c4b3a2d1e0f9a8b"},
+    {"error_stacktrace",
+     "{\"value\":{\"error\":\"stale element reference\",\"message\":\"stale element reference: stale element "
+     "not found in the current frame\\n  (Session info: chrome=126.0.6478.126)\","
+     "\"stacktrace\":\"#0 0x55d1c3a0e8da <unknown>\\n#1 0x55d1c36f3ae0 <unknown>\\n#2 0x55d1c36fb4c7 <unknown>\\n"
+     "#3 0x55d1c36fd85c <unknown>\\n#4 0x55d1c36fd8e0 <unknown>\\n#5 0x55d1c3743f5a <unknown>\\n"
+     "#6 0x55d1c3766d22 <unknown>\\n#7 0x55d1c373b9b2 <unknown>\\n#8 0x55d1c3767e5e <unknown>\\n"
+     "#9 0x55d1c3785d6e <unknown>\\n#10 0x55d1c3766a93 <unknown>\\n#11 0x55d1c373a1b4 <unknown>\\n"
+     "#12 0x55d1c373b9de <unknown>\\n#13 0x55d1c39d5c4b <unknown>\\n#14 0x55d1c39d9b2c <unknown>\\n"
+     "#15 0x55d1c39c2355 <unknown>\\n#16 0x55d1c39da5d7 <unknown>\\n#17 0x55d1c39a4d6f <unknown>\\n"
+     "#18 0x55d1c39fe378 <unknown>\\n#19 0x55d1c39fe550 <unknown>\\n#20 0x55d1c3a0d6cc <unknown>\\n"
+     "#21 0x7f1e0f294ac3 <unknown>\\n\"}}",
+     {"value", "error"}, 2, "stale element reference"},
+};
+
+// Decodes each case `iterations` times, checking the result, and prints ns per decode as JSON.
+static int run_decode_benchmark(int iterations) {
+    size_t sink = 0;
+    printf("{\n  \"iterations\": %d,\n  \"replies\": [\n", iterations);
+    for (size_t c = 0; c < ARRAY_LEN(DECODE_BENCH_CASES); ++c) {
+        const DecodeBenchCase *bench = &DECODE_BENCH_CASES[c];
+        char *value = NULL;
+        if (!json_extract_path_string(bench->body, bench->path, bench->depth, &value) || !value ||
+            strcmp(value, bench->expected) != 0) {
+            log_at(LOG_LEVEL_FATAL, "%s decoded to %s", bench->name, value ? value : "(nothing)");
+            free(value);
+            return 1;
+        }
+        free(value);
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < iterations; ++i) {
+            json_extract_path_string(bench->body, bench->path, bench->depth, &value);
+            sink += strlen(value);
+            free(value);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double ns = (double)(end.tv_sec - start.tv_sec) * 1e9 + (double)(end.tv_nsec - start.tv_nsec);
+        printf("    {\"reply\": \"%s\", \"bytes\": %zu, \"scan_ns\": %.1f}%s\n", bench->name, strlen(bench->body),
+               ns / iterations, c + 1 < ARRAY_LEN(DECODE_BENCH_CASES) ? "," : "");
+    }
+    printf("  ]\n}\n");
+    return sink == 0;  // never true; keeps the decodes from being optimized away
+}
+
+// ---------- Micro-benchmarks ----------
+// --bench times the hot paths that do not need a browser. Each benchmark runs once to warm
+// up, then in growing batches until one batch takes MICRO_BENCH_MIN_NS; that batch is
+// reported together with the allocations it made.
+#define DEFAULT_BENCH_WORDS 200000
+#define MICRO_BENCH_MIN_NS 200e6
+#define MICRO_BENCH_PAYLOAD_WORDS 1000
+
+static const char BENCH_HIVES[][8] = {"taegnil", "mopcrae", "ybdlnoa", "hutirsk"};
+
+// Shared by every benchmark op; an op that fails sets `failed` and the run stops.
+typedef struct {
+    Config config;  // dictionary_dir is the benchmarked directory
+    char massive_path[PATH_MAX + 32];
+    const WordDictionaries *dicts;
+    const WordIndex *index;
+    WordList payload_words;  // uppercase, as the solver hands them to the payload builder
+    bool failed;
+} MicroBenchContext;
+
+typedef size_t (*MicroBenchOp)(MicroBenchContext *ctx);
+
+static volatile size_t g_bench_sink;
+
+static size_t bench_normalize_letters(MicroBenchContext *ctx) {
+    char letters[8];
+    if (!normalize_letters_input("  TaEg NiL ", letters, NULL)) ctx->failed = true;
+    return strlen(letters);
+}
+
+static size_t bench_letter_mask(MicroBenchContext *ctx) {
+    uint32_t acc = 0;
+    for (size_t i = 0; i < ctx->dicts->massive_words.size; ++i) {
+        acc ^= letter_mask(ctx->dicts->massive_words.items[i], NULL);
+    }
+    return acc;
+}
+
+static size_t bench_load_word_file(MicroBenchContext *ctx) {
+    WordList words;
+    word_list_init(&words);
+    if (load_word_file(ctx->massive_path, &words) != 0) ctx->failed = true;
+    size_t n = words.size;
+    word_list_free(&words);
+    return n;
+}
+
+static size_t bench_load_word_dictionaries(MicroBenchContext *ctx) {
+    WordDictionaries dicts;
+    if (load_word_dictionaries(&ctx->config, &dicts) != 0) ctx->failed = true;
+    size_t n = dicts.massive_words.size;
+    free_word_dictionaries(&dicts);
+    return n;
+}
+
+static size_t bench_build_word_index(MicroBenchContext *ctx) {
+    WordIndex index;
+    if (build_word_index(&ctx->dicts->massive_words, &index) != 0) {
+        ctx->failed = true;
+        return 0;
+    }
+    size_t n = index.size;
+    free_word_index(&index);
+    return n;
+}
+
+static size_t bench_find_valid_words(MicroBenchContext *ctx) {
+    size_t found = 0;
+    for (size_t h = 0; h < ARRAY_LEN(BENCH_HIVES); ++h) {
+        WordList results;
+        ScoreSummary score;
+        word_list_init(&results);
+        if (find_valid_words(ctx->index, BENCH_HIVES[h], &results, &score) != 0) ctx->failed = true;
+        found += results.size;
+        word_list_free(&results);
+        word_list_free(&score.pangrams);
+    }
+    return found;
+}
+
+static size_t bench_actions_payload(MicroBenchContext *ctx) {
+    StringBuffer payload;
+    string_buffer_init(&payload);
+    if (build_actions_payload(&payload, ctx->payload_words.items, ctx->payload_words.size, 0) != 0) {
+        ctx->failed = true;
+    }
+    size_t n = payload.length;
+    string_buffer_free(&payload);
+    return n;
+}
+
+static int run_micro_bench(const char *name, size_t items_per_op, const char *item, MicroBenchOp op,
+                           MicroBenchContext *ctx, bool last) {
+    size_t sink = op(ctx);
+    for (uint64_t iterations = 1; !ctx->failed;) {
+        const uint64_t allocs_before = g_alloc_count, bytes_before = g_alloc_bytes;
+        const double start = monotonic_ns();
+        for (uint64_t i = 0; i < iterations && !ctx->failed; ++i) sink += op(ctx);
+        const double elapsed_ns = monotonic_ns() - start;
+        const uint64_t allocs = g_alloc_count - allocs_before, bytes = g_alloc_bytes - bytes_before;
+        if (elapsed_ns >= MICRO_BENCH_MIN_NS) {
+            g_bench_sink += sink;
+            const double ns_per_op = elapsed_ns / (double)iterations;
+            printf("    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.1f, \"allocs_per_op\": %.2f, "
+                   "\"alloc_bytes_per_op\": %.1f, \"items_per_op\": %zu, \"item\": \"%s\", \"items_per_s\": %.0f}%s\n",
+                   name, (unsigned long long)iterations, ns_per_op, (double)allocs / (double)iterations,
+                   (double)bytes / (double)iterations, items_per_op, item, (double)items_per_op * 1e9 / ns_per_op,
+                   last ? "" : ",");
+            return 0;
+        }
+        double scale = elapsed_ns > 0 ? 1.2 * MICRO_BENCH_MIN_NS / elapsed_ns : 10.0;
+        if (scale > 10.0) scale = 10.0;
+        uint64_t next = (uint64_t)((double)iterations * scale);
+        iterations = next > iterations ? next : iterations + 1;
+    }
+    log_at(LOG_LEVEL_FATAL, "benchmark %s failed", name);
+    return -1;
+}
+
+// Allocation budgets --bench enforces: a fixed allowance per call plus one per item. The
+// solve is budgeted per word found, so allocating per dictionary word fails the run; a
+// payload or reply that starts costing more allocations per key or reply fails it too.
+typedef struct {
+    const char *phase;
+    const char *item;
+    double per_item;
+    double fixed;
+} AllocBudget;
+
+static const AllocBudget LOAD_ALLOC_BUDGET = {"load", "words", 2, 256};
+static const AllocBudget SOLVE_ALLOC_BUDGET = {"solve", "words found", 1, 64};  // each result is a copy
+static const AllocBudget PAYLOAD_ALLOC_BUDGET = {"payload", "keys", 0, 64};     // one growing buffer
+static const AllocBudget RESPONSE_ALLOC_BUDGET = {"response", "replies", 1, 0};
+
+// Prints one "alloc_budgets" entry; false when `allocs` is over budget.
+static bool report_alloc_budget(const AllocBudget *budget, const char *detail, uint64_t allocs, size_t items,
+                                bool last) {
+    const double limit = budget->fixed + budget->per_item * (double)items;
+    const bool ok = (double)allocs <= limit;
+    printf("    {\"phase\": \"%s\", \"detail\": \"%s\", \"allocs\": %llu, \"items\": %zu, \"item\": \"%s\", "
+           "\"budget\": %.0f, \"ok\": %s}%s\n",
+           budget->phase, detail, (unsigned long long)allocs, items, budget->item, limit, ok ? "true" : "false",
+           last ? "" : ",");
+    if (!ok) {
+        fprintf(stderr, "[FAIL] %s%s%s: %llu allocations for %zu %s, budget %.0f\n", budget->phase, detail[0] ? " " : "",
+                detail, (unsigned long long)allocs, items, budget->item, limit);
+    }
+    return ok;
+}
+
+static size_t budget_load(MicroBenchContext *ctx) {
+    WordDictionaries dicts;
+    if (load_word_dictionaries(&ctx->config, &dicts) != 0) ctx->failed = true;
+    size_t n = dicts.short_words.size + dicts.medium_words.size + dicts.extended_words.size + dicts.massive_words.size;
+    free_word_dictionaries(&dicts);
+    return n;
+}
+
+static size_t budget_solve(MicroBenchContext *ctx, const char *hive) {
+    WordList results;
+    ScoreSummary score;
+    word_list_init(&results);
+    if (find_valid_words(ctx->index, hive, &results, &score) != 0) ctx->failed = true;
+    size_t n = results.size;
+    word_list_free(&results);
+    word_list_free(&score.pangrams);
+    return n;
+}
+
+static size_t budget_payload(MicroBenchContext *ctx) {
+    size_t keys = 0;
+    for (size_t i = 0; i < ctx->payload_words.size; ++i) keys += strlen(ctx->payload_words.items[i]) + 1;  // + Enter
+    g_bench_sink += bench_actions_payload(ctx);
+    return keys;
+}
+
+static size_t budget_response(MicroBenchContext *ctx) {
+    for (size_t i = 0; i < ARRAY_LEN(DECODE_BENCH_CASES); ++i) {
+        const DecodeBenchCase *c = &DECODE_BENCH_CASES[i];
+        char *value = NULL;
+        if (!json_extract_path_string(c->body, c->path, c->depth, &value) || !value) ctx->failed = true;
+        free(value);
+    }
+    return ARRAY_LEN(DECODE_BENCH_CASES);
+}
+
+// Runs each budgeted operation once to warm up, then once counted. False if any is over.
+static bool run_alloc_budgets(MicroBenchContext *ctx) {
+    bool ok = true;
+    uint64_t before;
+    size_t items;
+
+    budget_load(ctx);
+    before = g_alloc_count;
+    items = budget_load(ctx);
+    ok &= report_alloc_budget(&LOAD_ALLOC_BUDGET, "", g_alloc_count - before, items, false);
+    for (size_t h = 0; h < ARRAY_LEN(BENCH_HIVES); ++h) {
+        budget_solve(ctx, BENCH_HIVES[h]);
+        before = g_alloc_count;
+        items = budget_solve(ctx, BENCH_HIVES[h]);
+        ok &= report_alloc_budget(&SOLVE_ALLOC_BUDGET, BENCH_HIVES[h], g_alloc_count - before, items, false);
+    }
+    budget_payload(ctx);
+    before = g_alloc_count;
+    items = budget_payload(ctx);
+    ok &= report_alloc_budget(&PAYLOAD_ALLOC_BUDGET, "", g_alloc_count - before, items, false);
+    budget_response(ctx);
+    before = g_alloc_count;
+    items = budget_response(ctx);
+    ok &= report_alloc_budget(&RESPONSE_ALLOC_BUDGET, "", g_alloc_count - before, items, true);
+    return ok && !ctx->failed;
+}
+
+// Prints the report for the lists loaded into `ctx`; `real_dir` is empty for synthetic ones.
+static int run_micro_bench_suite(MicroBenchContext *ctx, const char *real_dir) {
+    const WordDictionaries *dicts = ctx->dicts;
+    const size_t words = ctx->index->size;
+    for (size_t i = 0; i < dicts->massive_words.size && i < MICRO_BENCH_PAYLOAD_WORDS; ++i) {
+        if (word_list_append_copy(&ctx->payload_words, dicts->massive_words.items[i]) != 0) {
+            log_at(LOG_LEVEL_FATAL, "out of memory preparing the payload words");
+            return 1;
+        }
+        to_upper_inplace(ctx->payload_words.items[i]);
+    }
+    const size_t listed = dicts->short_words.size + dicts->medium_words.size + dicts->extended_words.size +
+                          dicts->massive_words.size;
+
+    StringBuffer dir_json;
+    string_buffer_init(&dir_json);
+    if (string_buffer_append_json_string(&dir_json, real_dir) != 0) {
+        string_buffer_free(&dir_json);
+        return 1;
+    }
+    printf("{\n  \"dictionary\": {\"source\": \"%s\", \"dir\": %s, \"words\": %zu},\n  \"benchmarks\": [\n",
+           real_dir[0] ? "real" : "synthetic", dir_json.data, words);
+    string_buffer_free(&dir_json);
+    if (run_micro_bench("normalize_letters", 1, "calls", bench_normalize_letters, ctx, false) != 0 ||
+        run_micro_bench("letter_mask", words, "words", bench_letter_mask, ctx, false) != 0 ||
+        run_micro_bench("load_word_file", dicts->massive_words.size, "words", bench_load_word_file, ctx, false) != 0 ||
+        run_micro_bench("load_word_dictionaries", listed, "words", bench_load_word_dictionaries, ctx, false) != 0 ||
+        run_micro_bench("build_word_index", words, "words", bench_build_word_index, ctx, false) != 0 ||
+        run_micro_bench("find_valid_words", words * ARRAY_LEN(BENCH_HIVES), "words", bench_find_valid_words, ctx,
+                        false) != 0 ||
+        run_micro_bench("actions_payload", ctx->payload_words.size, "words", bench_actions_payload, ctx, true) != 0) {
+        return 1;
+    }
+    printf("  ],\n  \"alloc_budgets\": [\n");
+    const bool within_budgets = run_alloc_budgets(ctx);
+    printf("  ]\n}\n");
+    return within_budgets ? 0 : 1;
+}
+
+// Uses the real lists when all five are in the dictionary directory and --bench-words is
+// not given; otherwise writes synthetic ones to a scratch directory first.
+static int run_micro_benchmarks(const Config *config) {
+    bool real = config->bench_words == 0 && config->dictionary_dir[0] != '\0';
+    for (size_t f = 0; real && f < ARRAY_LEN(LIST_FILES); ++f) {
+        char path[PATH_MAX + 32];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", config->dictionary_dir, LIST_FILES[f]);
+        real = stat(path, &st) == 0 && S_ISREG(st.st_mode);
+    }
+
+    MicroBenchContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.config = *config;
+    word_list_init(&ctx.payload_words);
+    char scratch[PATH_MAX] = "";
+    if (!real) {
+        if (!make_scratch_dir("spellingbee-bench-", scratch, sizeof(scratch))) return 1;
+        snprintf(ctx.config.dictionary_dir, sizeof(ctx.config.dictionary_dir), "%s", scratch);
+        char *err = NULL;
+        if (write_synthetic_dictionaries(scratch, config->bench_words ? config->bench_words : DEFAULT_BENCH_WORDS,
+                                         &config->synthetic, NULL, &err) != 0) {
+            log_at(LOG_LEVEL_FATAL, "%s", err ? err : "cannot write synthetic word lists");
+            free(err);
+            remove_synthetic_dictionaries(scratch);
+            return 1;
+        }
+    }
+    snprintf(ctx.massive_path, sizeof(ctx.massive_path), "%s/wlist_match1.txt", ctx.config.dictionary_dir);
+
+    WordDictionaries dicts;
+    WordIndex index = {0};
+    int rc = 1;
+    if (load_word_dictionaries(&ctx.config, &dicts) != 0 || build_word_index(&dicts.massive_words, &index) != 0) {
+        log_at(LOG_LEVEL_FATAL, "cannot load the benchmark word lists");
+    } else {
+        ctx.dicts = &dicts;
+        ctx.index = &index;
+        rc = run_micro_bench_suite(&ctx, real ? config->dictionary_dir : "");
+    }
+    word_list_free(&ctx.payload_words);
+    free_word_index(&index);
+    free_word_dictionaries(&dicts);
+    if (scratch[0]) remove_synthetic_dictionaries(scratch);
+    return rc;
+}
+
+// ---------- Scaling stress ----------
+// --stress generates a synthetic dictionary of each size, then loads, indexes and solves
+// it in a forked child. Each size starts from a clean heap, so RSS is its own, and a size
+// that runs out of memory is reported instead of ending the run.
+
+// VmRSS and VmHWM from /proc/self/status in KiB; zero where unavailable.
+typedef struct {
+    uint64_t rss_kib;
+    uint64_t peak_kib;
+} RssSample;
+
+static RssSample rss_sample(void) {
+    RssSample sample = {0, 0};
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (!fp) return sample;
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, "VmRSS:", 6) == 0) sample.rss_kib = strtoull(line + 6, NULL, 10);
+        else if (strncmp(line, "VmHWM:", 6) == 0) sample.peak_kib = strtoull(line + 6, NULL, 10);
+    }
+    fclose(fp);
+    return sample;
+}
+
+// Loads, indexes and solves the lists in `config->dictionary_dir` and appends the
+// measurements to `out` as JSON members.
+static int stress_one_size(const Config *config, StringBuffer *out) {
+    WordDictionaries dicts;
+    WordIndex index = {0};
+    const uint64_t allocs_before = g_alloc_count;
+    const double load_start = monotonic_ns();
+    if (load_word_dictionaries(config, &dicts) != 0) {
+        free_word_dictionaries(&dicts);
+        return -1;
+    }
+    const double load_end = monotonic_ns();
+    const uint64_t load_allocs = g_alloc_count - allocs_before;
+    const RssSample loaded = rss_sample();
+    if (build_word_index(&dicts.massive_words, &index) != 0) {
+        free_word_dictionaries(&dicts);
+        return -1;
+    }
+    const double index_end = monotonic_ns();
+
+    double solve_total_ms = 0, solve_max_ms = 0;
+    size_t solutions = 0;
+    int rc = 0;
+    for (size_t h = 0; h < ARRAY_LEN(BENCH_HIVES) && rc == 0; ++h) {
+        WordList results;
+        ScoreSummary score;
+        word_list_init(&results);
+        const double start = monotonic_ns();
+        rc = find_valid_words(&index, BENCH_HIVES[h], &results, &score);
+        const double ms = (monotonic_ns() - start) / 1e6;
+        solutions += results.size;
+        solve_total_ms += ms;
+        if (ms > solve_max_ms) solve_max_ms = ms;
+        word_list_free(&results);
+        word_list_free(&score.pangrams);
+    }
+    const RssSample end = rss_sample();
+    if (rc == 0) {
+        rc = string_buffer_append_format(
+            out,
+            "\"listed_words\": %zu, \"massive_words\": %zu, \"load_s\": %.3f, \"load_allocs\": %llu, "
+            "\"index_s\": %.3f, \"rss_loaded_mib\": %.1f, \"peak_rss_mib\": %.1f, \"solve_ms_mean\": %.3f, "
+            "\"solve_ms_max\": %.3f, \"solutions\": %zu",
+            dicts.short_words.size + dicts.medium_words.size + dicts.extended_words.size + dicts.massive_words.size,
+            index.size, (load_end - load_start) / 1e9, (unsigned long long)load_allocs, (index_end - load_end) / 1e9,
+            (double)loaded.rss_kib / 1024.0, (double)end.peak_kib / 1024.0,
+            solve_total_ms / (double)ARRAY_LEN(BENCH_HIVES), solve_max_ms, solutions);
+    }
+    free_word_index(&index);
+    free_word_dictionaries(&dicts);
+    return rc;
+}
+
+// Runs stress_one_size in a child and appends its members to `out`, or an "error" member
+// when the child failed or was killed (typically by the OOM killer).
+static int stress_in_child(const Config *config, StringBuffer *out) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        log_at(LOG_LEVEL_FATAL, "pipe: %s", strerror(errno));
+        return -1;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        log_at(LOG_LEVEL_FATAL, "fork: %s", strerror(errno));
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        StringBuffer report;
+        string_buffer_init(&report);
+        int status = stress_one_size(config, &report) == 0 ? 0 : 1;
+        for (size_t sent = 0; status == 0 && sent < report.length;) {
+            ssize_t n = write(fds[1], report.data + sent, report.length - sent);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            sent += (size_t)n;
+        }
+        _exit(status);
+    }
+    close(fds[1]);
+    StringBuffer reply;
+    string_buffer_init(&reply);
+    char buf[4096];
+    for (;;) {
+        ssize_t n = read(fds[0], buf, sizeof(buf) - 1);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        buf[n] = '\0';
+        string_buffer_append(&reply, buf);
+    }
+    close(fds[0]);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    int rc = 0;
+    if (WIFSIGNALED(status)) {
+        string_buffer_append_format(out, "\"error\": \"killed by signal %d\"", WTERMSIG(status));
+        rc = 1;
+    } else if (WEXITSTATUS(status) != 0 || reply.length == 0) {
+        string_buffer_append_format(out, "\"error\": \"child exited with status %d\"", WEXITSTATUS(status));
+        rc = 1;
+    } else {
+        string_buffer_append(out, reply.data);
+    }
+    string_buffer_free(&reply);
+    return rc;
+}
+
+// Stops at the first size that fails, since larger ones would fail the same way.
+static int run_stress(const Config *config) {
+    printf("{\n  \"hives\": [");
+    for (size_t h = 0; h < ARRAY_LEN(BENCH_HIVES); ++h) printf("%s\"%s\"", h ? ", " : "", BENCH_HIVES[h]);
+    printf("],\n  \"sizes\": [\n");
+    int rc = 0;
+    for (size_t s = 0; s < config->stress_count && rc == 0; ++s) {
+        const uint64_t words = config->stress_sizes[s];
+        Config child = *config;
+        if (!make_scratch_dir("spellingbee-stress-", child.dictionary_dir, sizeof(child.dictionary_dir))) {
+            rc = 1;
+            break;
+        }
+        char *err = NULL;
+        uint64_t bytes = 0;
+        const double start = monotonic_ns();
+        if (write_synthetic_dictionaries(child.dictionary_dir, words, &config->synthetic, &bytes, &err) != 0) {
+            log_at(LOG_LEVEL_FATAL, "%s", err ? err : "cannot write synthetic word lists");
+            free(err);
+            remove_synthetic_dictionaries(child.dictionary_dir);
+            rc = 1;
+            break;
+        }
+        StringBuffer entry;
+        string_buffer_init(&entry);
+        string_buffer_append_format(&entry, "    {\"words\": %llu, \"list_mib\": %.1f, \"generate_s\": %.3f, ",
+                                    (unsigned long long)words, (double)bytes / (1024.0 * 1024.0),
+                                    (monotonic_ns() - start) / 1e9);
+        fprintf(stderr, "stress: %llu words generated, loading\n", (unsigned long long)words);
+        rc = stress_in_child(&child, &entry);
+        remove_synthetic_dictionaries(child.dictionary_dir);
+        if (rc > 0) fprintf(stderr, "stress: %llu words failed\n", (unsigned long long)words);
+        if (rc >= 0) printf("%s%s}", s ? ",\n" : "", entry.data);
+        string_buffer_free(&entry);
+    }
+    printf("\n  ]\n}\n");
+    return rc == 0 ? 0 : 1;
+}
+
+// Writes --synthetic-words words to --generate-dictionaries for trying the solver at scale.
+static int run_generate_dictionaries(const Config *config) {
+    if (mkdir(config->generate_dir, 0755) != 0 && errno != EEXIST) {
+        log_at(LOG_LEVEL_FATAL, "cannot create %s: %s", config->generate_dir, strerror(errno));
+        return 1;
+    }
+    char *err = NULL;
+    uint64_t bytes = 0;
+    const double start = monotonic_ns();
+    if (write_synthetic_dictionaries(config->generate_dir, config->synthetic_words, &config->synthetic, &bytes,
+                                     &err) != 0) {
+        log_at(LOG_LEVEL_FATAL, "%s", err ? err : "cannot write synthetic word lists");
+        free(err);
+        return 1;
+    }
+    fprintf(stderr, "Wrote %llu synthetic words (%llu MiB across %zu files) to %s in %.1fs\n",
+            (unsigned long long)config->synthetic_words, (unsigned long long)(bytes / (1024 * 1024)),
+            ARRAY_LEN(LIST_FILES), config->generate_dir, (monotonic_ns() - start) / 1e9);
+    return 0;
+}
+
 // ---------- Main ----------
 
 int main(int argc, char **argv) {
@@ -1535,39 +5216,105 @@ int main(int argc, char **argv) {
     if (!parse_args(argc, argv, &config)) {
         return 1;
     }
+    g_log_level = config.log_level;
+    g_log_json = config.log_json;
+    if (config.generate_dir[0]) {
+        return run_generate_dictionaries(&config);
+    }
+    if (config.stress_count > 0) {
+        return run_stress(&config);
+    }
+    if (config.bench) {
+        return run_micro_benchmarks(&config);
+    }
+    if (config.bench_decode_iterations > 0) {
+        return run_decode_benchmark(config.bench_decode_iterations);
+    }
 
     if (config.dictionary_dir[0] == '\0') {
-        fprintf(stderr, "[FATAL] Could not locate word list directory. Specify --dictionary-dir=PATH.\n");
+        log_at(LOG_LEVEL_FATAL, "Could not locate word list directory. Specify --dictionary-dir=PATH.");
         return 1;
     }
     if (!path_is_directory(config.dictionary_dir)) {
-        fprintf(stderr, "[FATAL] Dictionary directory not found: %s\n", config.dictionary_dir);
+        log_at(LOG_LEVEL_FATAL, "Dictionary directory not found: %s", config.dictionary_dir);
+        return 1;
+    }
+    if (config.word_changes.size > 0 || config.compact_dictionaries) {
+        int rc = run_dictionary_update(&config);
+        word_changes_free(&config.word_changes);
+        return rc;
+    }
+    if (config.metrics_prefix[0] != '\0') enable_phase_metrics(config.metrics_prefix);
+    if (config.trace_file[0] != '\0' && !enable_trace(config.trace_file)) {
+        log_at(LOG_LEVEL_FATAL, "Cannot write the trace to %s: %s", config.trace_file, strerror(errno));
         return 1;
     }
 
     WordDictionaries dicts;
-    if (load_word_dictionaries(&config, &dicts) != 0) {
+    AllocPhase saved_phase = alloc_phase_enter(ALLOC_PHASE_LOAD);
+    int load_rc = load_word_dictionaries(&config, &dicts);
+    alloc_phase_leave(saved_phase);
+    if (load_rc != 0) {
         free_word_dictionaries(&dicts);
         return 1;
     }
 
     if (dicts.massive_words.size == 0) {
-        fprintf(stderr, "[FATAL] word list 'wlist_match1.txt' appears to be empty in %s\n", config.dictionary_dir);
+        log_at(LOG_LEVEL_FATAL, "word list 'wlist_match1.txt' appears to be empty in %s", config.dictionary_dir);
         free_word_dictionaries(&dicts);
         return 1;
     }
 
-    printf("Loaded word lists from %s (massive set size: %zu)\n",
-           config.dictionary_dir,
-           dicts.massive_words.size);
-    fflush(stdout);
+    // Keep stdout machine-readable when printing membership results.
+    FILE *status_out = config.check_words_file[0] ? stderr : stdout;
+    fprintf(status_out, "Loaded word lists from %s (massive set size: %zu)\n",
+            config.dictionary_dir,
+            dicts.massive_words.size);
+    fflush(status_out);
+
+    if (config.check_words_file[0]) {
+        int rc = run_membership_check(&config, &dicts);
+        free_word_dictionaries(&dicts);
+        return rc;
+    }
 
+    WordIndex massive_index;
+    saved_phase = alloc_phase_enter(ALLOC_PHASE_LOAD);
+    int index_rc = build_word_index(&dicts.massive_words, &massive_index);
+    alloc_phase_leave(saved_phase);
+    if (index_rc != 0) {
+        log_at(LOG_LEVEL_FATAL, "out of memory building word index");
+        free_word_dictionaries(&dicts);
+        return 1;
+    }
+    LayeredWordIndex layered_index;
+    char *layer_err = NULL;
+    if (load_word_changes(&config, &massive_index, &layered_index, &layer_err) != 0) {
+        log_at(LOG_LEVEL_FATAL, "%s", layer_err ? layer_err : "cannot read delta segments");
+        free(layer_err);
+        free_word_index(&massive_index);
+        free_word_dictionaries(&dicts);
+        return 1;
+    }
+    if (layered_word_changes(&layered_index) > 0) {
+        log_at(LOG_LEVEL_INFO, "Applied delta segments from %s (%zu word changes)", config.dictionary_dir,
+               layered_word_changes(&layered_index));
+    }
+
+    DictionaryWatch dictionary_watch;
+    dictionary_watch_start(&dictionary_watch, config.dictionary_dir);
+
+    srand((unsigned)time(NULL) ^ (unsigned)getpid());   // retry backoff jitter
     curl_global_init(CURL_GLOBAL_DEFAULT);
     CurlSession session;
     char *err = NULL;
-    if (curl_session_init(&session, &err) != 0) {
-        fprintf(stderr, "[FATAL] %s\n", err ? err : "failed to initialise curl session");
+    if (curl_session_init(&session, &err) != 0 ||
+        (config.record_file[0] && curl_session_start_recording(&session, config.record_file, &err) != 0)) {
+        log_at(LOG_LEVEL_FATAL, "%s", err ? err : "failed to initialise curl session");
         free(err);
+        dictionary_watch_stop(&dictionary_watch);
+        free_layered_word_index(&layered_index);
+        free_word_index(&massive_index);
         free_word_dictionaries(&dicts);
         curl_global_cleanup();
         return 1;
@@ -1586,7 +5333,31 @@ int main(int argc, char **argv) {
     bool need_full_setup = true;
     int attempt_index = 0;
 
+    char *reattached_url = NULL;
+    if (config.reuse_session && reattach_saved_session(&wd, config.session_file, &reattached_url)) {
+        // Still on the puzzle: treat the first attempt like a rerun in this process.
+        need_full_setup = strncmp(reattached_url, SPELLING_BEE_URL, strlen(SPELLING_BEE_URL)) != 0;
+        printf("Reattached to browser session %s.\n", wd.session_id);
+        free(reattached_url);
+    }
+
     while (!exit_program) {
+        const DictionaryChange change = dictionary_watch_poll(&dictionary_watch);
+        if (change == DICTIONARY_LISTS_CHANGED) {
+            char *reload_err = NULL;
+            if (reload_word_dictionaries(&config, &dicts, &massive_index, &layered_index, &reload_err) != 0) {
+                log_at(LOG_LEVEL_WARN, "Word lists in %s changed but could not be reloaded (%s); keeping the current ones.",
+                       config.dictionary_dir, reload_err ? reload_err : "unknown error");
+            }
+            free(reload_err);
+        } else if (change == DICTIONARY_SEGMENTS_CHANGED) {
+            char *reload_err = NULL;
+            if (relayer_word_changes(&config, &layered_index, &reload_err) != 0) {
+                log_at(LOG_LEVEL_WARN, "Delta segments in %s changed but could not be applied (%s); keeping the current ones.",
+                       config.dictionary_dir, reload_err ? reload_err : "unknown error");
+            }
+            free(reload_err);
+        }
         ++attempt_index;
         bool have_session = wd_has_session(&wd);
         bool do_full_setup = need_full_setup || !have_session;
@@ -1595,10 +5366,12 @@ int main(int argc, char **argv) {
                                             do_full_setup,
                                             attempt_index,
                                             &config,
-                                            &dicts);
+                                            &layered_index);
+        // After the run, so folding many segments never delays one.
+        compact_word_changes(&config, &layered_index);
 
         if (attempt.fatal_error) {
-            fprintf(stderr, "\n[FATAL] %s\n", attempt.fatal_message ? attempt.fatal_message : "unknown error");
+            log_at(LOG_LEVEL_FATAL, "\n%s", attempt.fatal_message ? attempt.fatal_message : "unknown error");
         }
 
         if (attempt.user_quit) {
@@ -1659,12 +5432,22 @@ int main(int argc, char **argv) {
 
     if (wd_has_session(&wd) && want_close) {
         char *cleanup_err = NULL;
-        wd_delete_session(&wd, &cleanup_err);
+        // Closing was chosen, so a session whose DELETE failed is not kept for reuse either.
+        if (wd_delete_session(&wd, &cleanup_err) != 0) wd_clear_session(&wd);
         free(cleanup_err);
     }
+    if (wd_has_session(&wd)) {
+        save_session_state(config.session_file, &wd);
+    } else {
+        clear_session_state(config.session_file);
+    }
+    if (config.transport_stats) transport_print_stats(&session, stderr);
 
     curl_session_cleanup(&session);
     curl_global_cleanup();
+    dictionary_watch_stop(&dictionary_watch);
+    free_layered_word_index(&layered_index);
+    free_word_index(&massive_index);
     free_word_dictionaries(&dicts);
     return 0;
 }
@@ -1,18 +1,48 @@
 // spellingbee_one_shot.cpp (always window, user-driven start, robust pause/retry, detach Chrome, no gotos)
 #include <curl/curl.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/inotify.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <nlohmann/json.hpp>
 #include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <csignal>
 #include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <algorithm>
+#include <atomic>
 #include <array>
+#include <bit>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <random>
 #include <set>
 #include <stdexcept>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <thread>
 #include <tuple>
 #include <vector>
@@ -28,494 +58,4993 @@ static size_t WriteToString(void* ptr, size_t size, size_t nmemb, void* userdata
     return size * nmemb;
 }
 
+// ---------- Allocation counting ----------
+// Every operator new goes through these two relaxed counters, so a benchmark can report
+// allocations per operation from the difference of two snapshots.
+//
+// Building with -DSPELLINGBEE_ALLOC_PHASES also charges each allocation to the phase its
+// thread is in (loading, solving, payload construction, response handling; see
+// AllocPhaseScope), and --metrics-file reports the totals. That costs a thread-local read
+// per allocation, so it is off by default and the scopes compile to nothing.
+static std::atomic<uint64_t> g_alloc_count{0};
+static std::atomic<uint64_t> g_alloc_bytes{0};
+
+enum class AllocPhase : uint8_t { Other, Load, Solve, Payload, Response };
+static constexpr const char* kAllocPhaseNames[] = {"other", "load", "solve", "payload", "response"};
+
+#ifdef SPELLINGBEE_ALLOC_PHASES
+static constexpr bool kAllocPhasesBuilt = true;
+static thread_local AllocPhase t_alloc_phase = AllocPhase::Other;
+static std::array<std::atomic<uint64_t>, std::size(kAllocPhaseNames)> g_phase_alloc_count{};
+static std::array<std::atomic<uint64_t>, std::size(kAllocPhaseNames)> g_phase_alloc_bytes{};
+#else
+static constexpr bool kAllocPhasesBuilt = false;
+#endif
+
+void* operator new(std::size_t size) {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+#ifdef SPELLINGBEE_ALLOC_PHASES
+    const auto phase = static_cast<size_t>(t_alloc_phase);
+    g_phase_alloc_count[phase].fetch_add(1, std::memory_order_relaxed);
+    g_phase_alloc_bytes[phase].fetch_add(size, std::memory_order_relaxed);
+#endif
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return ::operator new(size); }
+// Not inlined: GCC would otherwise see free() paired with operator new and warn.
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete[](void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+struct AllocSnapshot {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+
+    static AllocSnapshot now() {
+        return {g_alloc_count.load(std::memory_order_relaxed), g_alloc_bytes.load(std::memory_order_relaxed)};
+    }
+};
+
+// Charges the current thread's allocations to `phase` until destroyed; scopes nest.
+class AllocPhaseScope {
+public:
+#ifdef SPELLINGBEE_ALLOC_PHASES
+    explicit AllocPhaseScope(AllocPhase phase) : saved_(std::exchange(t_alloc_phase, phase)) {}
+    ~AllocPhaseScope() { t_alloc_phase = saved_; }
+#else
+    explicit AllocPhaseScope(AllocPhase) {}
+#endif
+    AllocPhaseScope(const AllocPhaseScope&) = delete;
+    AllocPhaseScope& operator=(const AllocPhaseScope&) = delete;
+
+#ifdef SPELLINGBEE_ALLOC_PHASES
+private:
+    AllocPhase saved_;
+#endif
+};
+
+// Allocations and bytes charged to each phase so far; empty unless built with
+// SPELLINGBEE_ALLOC_PHASES.
+static std::vector<std::tuple<const char*, uint64_t, uint64_t>> alloc_phase_totals() {
+    std::vector<std::tuple<const char*, uint64_t, uint64_t>> totals;
+#ifdef SPELLINGBEE_ALLOC_PHASES
+    for (size_t i = 0; i < std::size(kAllocPhaseNames); ++i) {
+        totals.emplace_back(kAllocPhaseNames[i], g_phase_alloc_count[i].load(std::memory_order_relaxed),
+                            g_phase_alloc_bytes[i].load(std::memory_order_relaxed));
+    }
+#endif
+    return totals;
+}
+
+// ---------- Logging ----------
+// Diagnostics go through log_at() rather than straight to std::cerr. The calling thread
+// formats a record into a slot of a fixed ring: producers claim slots with one
+// compare-and-swap on the tail and publish them through a per-slot sequence number (a
+// bounded MPSC queue after Vyukov), and a single writer thread drains the ring to stderr in
+// order, so threads neither serialize on the stream nor interleave lines. A full ring makes
+// the producer wait for the writer rather than lose records. --log-level drops less severe
+// records before anything is formatted, so a disabled call is one relaxed load;
+// --log-format=json writes one JSON object per line (ts, level, thread, msg and any fields)
+// in place of the "[WARN] ..." text.
+enum class LogLevel : uint8_t { Debug, Info, Warn, Error, Fatal, Off };
+constexpr const char* kLogLevelNames[] = {"debug", "info", "warn", "error", "fatal", "off"};
+constexpr const char* kLogLevelTags[] = {"[DEBUG] ", "[INFO] ", "[WARN] ", "[ERROR] ", "[FATAL] ", ""};
+enum class LogFormat { Text, Json };
+
+static std::optional<LogLevel> parse_log_level(std::string_view name) {
+    for (size_t i = 0; i < std::size(kLogLevelNames); ++i) {
+        if (name == kLogLevelNames[i]) return static_cast<LogLevel>(i);
+    }
+    return std::nullopt;
+}
+
+// Small ids in order of each thread's first record; the main thread takes 1 in start().
+static uint32_t log_thread_id() {
+    static std::atomic<uint32_t> next{0};
+    thread_local const uint32_t id = next.fetch_add(1, std::memory_order_relaxed) + 1;
+    return id;
+}
+
+class Logger {
+public:
+    static constexpr uint64_t kSlots = 1024;
+
+    Logger() {
+        for (uint64_t i = 0; i < kSlots; ++i) slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    ~Logger() { stop(); }
+
+    bool enabled(LogLevel level) const { return level >= level_.load(std::memory_order_relaxed); }
+    bool structured() const { return format_ == LogFormat::Json; }
+
+    void configure(LogLevel level, LogFormat format) {
+        level_ = level;
+        format_ = format;
+    }
+
+    // Until start(), after stop() and in a forked child records are written synchronously.
+    void start() {
+        if (writer_.joinable()) return;
+        (void)log_thread_id();
+        writer_ = std::thread([this] {
+            // Started first thing in main, before the signal masks are set up: leave SIGINT
+            // to the main thread and SIGUSR1 to the metrics thread.
+            sigset_t set;
+            sigemptyset(&set);
+            sigaddset(&set, SIGINT);
+            sigaddset(&set, SIGUSR1);
+            pthread_sigmask(SIG_BLOCK, &set, nullptr);
+            write_loop();
+        });
+        threaded_.store(true, std::memory_order_release);
+    }
+
+    // Drains what is left and joins the writer.
+    void stop() {
+        if (!writer_.joinable()) return;
+        stopping_.store(true, std::memory_order_release);
+        published_.fetch_add(1, std::memory_order_release);
+        published_.notify_one();
+        writer_.join();
+        threaded_.store(false, std::memory_order_release);
+        drain();
+    }
+
+    // The writer thread does not survive fork(); the child writes its records itself.
+    void forget_writer() { threaded_.store(false, std::memory_order_relaxed); }
+
+    // Returns once every record logged so far is on stderr, so a prompt comes after them.
+    void flush() {
+        if (!threaded_.load(std::memory_order_acquire)) return;
+        const uint64_t target = tail_.load(std::memory_order_acquire);
+        for (uint64_t done = written_.load(std::memory_order_acquire); done < target;
+             done = written_.load(std::memory_order_acquire)) {
+            written_.wait(done, std::memory_order_acquire);
+        }
+    }
+
+    void push(LogLevel level, std::string message, nlohmann::ordered_json fields = {}) {
+        Record record{level, log_thread_id(), std::chrono::system_clock::now(), std::move(message), std::move(fields)};
+        if (!threaded_.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(direct_mutex_);
+            std::string line;
+            format(record, line);
+            std::fwrite(line.data(), 1, line.size(), stderr);
+            std::fflush(stderr);
+            return;
+        }
+        uint64_t pos = tail_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        for (;;) {
+            slot = &slots_[pos & (kSlots - 1)];
+            const auto lag = static_cast<int64_t>(slot->sequence.load(std::memory_order_acquire) - pos);
+            if (lag == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                // Full: the writer still owns this slot from the previous lap.
+                std::this_thread::yield();
+                pos = tail_.load(std::memory_order_relaxed);
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->record = std::move(record);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        published_.fetch_add(1, std::memory_order_release);
+        published_.notify_one();
+    }
+
+private:
+    struct Record {
+        LogLevel level = LogLevel::Info;
+        uint32_t thread = 0;
+        std::chrono::system_clock::time_point at;
+        std::string message;
+        nlohmann::ordered_json fields;
+    };
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        Record record;
+    };
+
+    void write_loop() {
+        for (;;) {
+            const uint64_t seen = published_.load(std::memory_order_acquire);
+            drain();
+            if (stopping_.load(std::memory_order_acquire)) return;
+            published_.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    // Writes every published record in order; only the writer (or stop(), after the join) runs it.
+    void drain() {
+        std::string out;
+        for (;;) {
+            Slot& slot = slots_[head_ & (kSlots - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) break;
+            format(slot.record, out);
+            slot.record = Record{};
+            slot.sequence.store(head_ + kSlots, std::memory_order_release);
+            ++head_;
+        }
+        if (!out.empty()) {
+            std::fwrite(out.data(), 1, out.size(), stderr);
+            std::fflush(stderr);
+        }
+        written_.store(head_, std::memory_order_release);
+        written_.notify_all();
+    }
+
+    void format(const Record& record, std::string& out) const {
+        // Leading newlines separate a record from a half-written prompt line; they stay
+        // ahead of the tag in text and are dropped from JSON.
+        const size_t body = record.message.find_first_not_of('\n');
+        const std::string_view text = body == std::string::npos ? std::string_view{}
+                                                                : std::string_view(record.message).substr(body);
+        if (format_ == LogFormat::Text) {
+            out.append(record.message, 0, body == std::string::npos ? record.message.size() : body);
+            out += kLogLevelTags[static_cast<size_t>(record.level)];
+            out += text;
+            out += '\n';
+            return;
+        }
+        const auto since_epoch = record.at.time_since_epoch();
+        const std::time_t seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch).count();
+        const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch).count() % 1000;
+        std::tm utc{};
+        gmtime_r(&seconds, &utc);
+        char ts[40];
+        const size_t n = std::strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S", &utc);
+        std::snprintf(ts + n, sizeof(ts) - n, ".%03dZ", static_cast<int>(millis));
+        nlohmann::ordered_json line = {{"ts", ts}, {"level", kLogLevelNames[static_cast<size_t>(record.level)]},
+                                       {"thread", record.thread}, {"msg", text}};
+        if (record.fields.is_object()) {
+            for (const auto& [key, value] : record.fields.items()) line[key] = value;
+        }
+        out += line.dump(-1, ' ', false, json::error_handler_t::replace);
+        out += '\n';
+    }
+
+    std::atomic<LogLevel> level_{LogLevel::Info};
+    LogFormat format_ = LogFormat::Text;
+    std::array<Slot, kSlots> slots_;
+    alignas(64) std::atomic<uint64_t> tail_{0};       // next slot producers claim
+    alignas(64) std::atomic<uint64_t> published_{0};  // bumped per record, wakes the writer
+    alignas(64) std::atomic<uint64_t> written_{0};    // records on stderr, wakes flush()
+    uint64_t head_ = 0;                               // next slot the writer reads
+    std::atomic<bool> threaded_{false};
+    std::atomic<bool> stopping_{false};
+    std::mutex direct_mutex_;
+    std::thread writer_;
+};
+
+static Logger g_log;
+
+static void start_logging(LogLevel level, LogFormat format) {
+    g_log.configure(level, format);
+    g_log.start();
+    pthread_atfork(nullptr, nullptr, [] { g_log.forget_writer(); });
+}
+
+// Logs the concatenation of `parts`; nothing is formatted when `level` is disabled.
+template <typename... Parts>
+static void log_at(LogLevel level, const Parts&... parts) {
+    if (!g_log.enabled(level)) return;
+    std::ostringstream message;
+    (message << ... << parts);
+    g_log.push(level, std::move(message).str());
+}
+
+// As log_at, with the object `make_fields()` returns added to JSON records. Text lines show
+// the message only, so the fields are built only for an enabled level in JSON format.
+template <typename MakeFields, typename... Parts>
+static void log_fields(LogLevel level, MakeFields&& make_fields, const Parts&... parts) {
+    if (!g_log.enabled(level)) return;
+    std::ostringstream message;
+    (message << ... << parts);
+    g_log.push(level, std::move(message).str(),
+               g_log.structured() ? nlohmann::ordered_json(make_fields()) : nlohmann::ordered_json());
+}
+
+// ---------- Phase metrics ----------
+// With --metrics-file=PREFIX every timed phase of a run feeds a histogram keyed by phase
+// and detail: dictionary load per file, index build, each WebDriver endpoint, board read,
+// solve, payload build and submission. The histograms are log-linear, HDR style: 32
+// sub-buckets per power of two of nanoseconds keep any value within about 3% of its
+// bucket at a fixed 10 KiB per histogram, and recording is a few relaxed atomic adds.
+// PREFIX.prom (Prometheus text format) and PREFIX.json are written on exit and whenever
+// the process receives SIGUSR1. Without the flag the timers do nothing.
+static std::atomic<bool> g_phase_metrics_enabled{false};
+
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 5;
+    static constexpr unsigned kMaxMsb = 44;   // ~4.9 hours; longer values land in the last bucket
+    static constexpr size_t kBuckets = ((kMaxMsb - kSubBucketBits) << kSubBucketBits) + (2u << kSubBucketBits);
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum_ns = 0;
+        uint64_t min_ns = 0;
+        uint64_t max_ns = 0;
+        std::vector<uint64_t> buckets;
+
+        // The highest value equivalent to the q-quantile's bucket, capped at the maximum.
+        uint64_t percentile(double q) const {
+            if (count == 0) return 0;
+            const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < buckets.size(); ++i) {
+                seen += buckets[i];
+                if (seen >= rank) return std::min(bucket_high(i), max_ns);
+            }
+            return max_ns;
+        }
+        // Values whose whole bucket lies at or below `ns`.
+        uint64_t count_at_most(uint64_t ns) const {
+            uint64_t n = 0;
+            for (size_t i = 0; i < buckets.size() && bucket_high(i) <= ns; ++i) n += buckets[i];
+            return n;
+        }
+    };
+
+    void record(uint64_t ns) {
+        buckets_[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t seen = min_ns_.load(std::memory_order_relaxed);
+        while (ns < seen && !min_ns_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+        }
+        seen = max_ns_.load(std::memory_order_relaxed);
+        while (ns > seen && !max_ns_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.count = count_.load(std::memory_order_relaxed);
+        s.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+        s.min_ns = s.count ? min_ns_.load(std::memory_order_relaxed) : 0;
+        s.max_ns = max_ns_.load(std::memory_order_relaxed);
+        s.buckets.resize(kBuckets);
+        for (size_t i = 0; i < kBuckets; ++i) s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        return s;
+    }
+
+    static size_t bucket_index(uint64_t ns) {
+        if (ns < (2u << kSubBucketBits)) return static_cast<size_t>(ns);
+        const unsigned msb = static_cast<unsigned>(std::bit_width(ns)) - 1;
+        if (msb > kMaxMsb) return kBuckets - 1;
+        const unsigned shift = msb - kSubBucketBits;
+        return (static_cast<size_t>(shift) << kSubBucketBits) + static_cast<size_t>(ns >> shift);
+    }
+    static uint64_t bucket_high(size_t index) {
+        if (index < (2u << kSubBucketBits)) return index;
+        const unsigned shift = static_cast<unsigned>(index >> kSubBucketBits) - 1;
+        const uint64_t top = (index & ((1u << kSubBucketBits) - 1)) + (1u << kSubBucketBits);
+        return ((top + 1) << shift) - 1;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> min_ns_{UINT64_MAX};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+class PhaseMetrics {
+public:
+    // Histograms are never removed, so the reference stays valid.
+    LatencyHistogram& histogram(const std::string& phase, const std::string& detail) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = histograms_[{phase, detail}];
+        if (!slot) slot = std::make_unique<LatencyHistogram>();
+        return *slot;
+    }
+
+    json summary_json() const {
+        json phases = json::array();
+        for (const auto& [key, snap] : snapshots()) {
+            auto ms = [](uint64_t ns) { return ns / 1e6; };
+            phases.push_back({{"phase", key.first}, {"detail", key.second}, {"count", snap.count},
+                              {"sum_ms", ms(snap.sum_ns)}, {"min_ms", ms(snap.min_ns)},
+                              {"mean_ms", snap.count ? ms(snap.sum_ns) / snap.count : 0.0},
+                              {"p50_ms", ms(snap.percentile(0.5))}, {"p90_ms", ms(snap.percentile(0.9))},
+                              {"p99_ms", ms(snap.percentile(0.99))}, {"p999_ms", ms(snap.percentile(0.999))},
+                              {"max_ms", ms(snap.max_ns)}});
+        }
+        json result = {{"unit", "ms"}, {"phases", phases}};
+        if (kAllocPhasesBuilt) {
+            json allocations = json::array();
+            for (const auto& [phase, count, bytes] : alloc_phase_totals()) {
+                allocations.push_back({{"phase", phase}, {"count", count}, {"bytes", bytes}});
+            }
+            result["allocations"] = std::move(allocations);
+        }
+        return result;
+    }
+
+    // One histogram family plus quantile gauges, in seconds as Prometheus expects.
+    std::string prometheus_text() const {
+        static constexpr double kBounds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                                             0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 300};
+        static constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+        const auto snaps = snapshots();
+        std::ostringstream out;
+        out << std::setprecision(9);
+        out << "# HELP spellingbee_phase_duration_seconds Time spent in each phase of a run.\n"
+            << "# TYPE spellingbee_phase_duration_seconds histogram\n";
+        for (const auto& [key, snap] : snaps) {
+            const std::string labels = prometheus_labels(key);
+            for (double bound : kBounds) {
+                out << "spellingbee_phase_duration_seconds_bucket{" << labels << ",le=\"" << bound << "\"} "
+                    << snap.count_at_most(static_cast<uint64_t>(bound * 1e9)) << "\n";
+            }
+            out << "spellingbee_phase_duration_seconds_bucket{" << labels << ",le=\"+Inf\"} " << snap.count << "\n"
+                << "spellingbee_phase_duration_seconds_sum{" << labels << "} " << snap.sum_ns / 1e9 << "\n"
+                << "spellingbee_phase_duration_seconds_count{" << labels << "} " << snap.count << "\n";
+        }
+        out << "# HELP spellingbee_phase_duration_quantile_seconds Quantiles of the phase durations.\n"
+            << "# TYPE spellingbee_phase_duration_quantile_seconds gauge\n";
+        for (const auto& [key, snap] : snaps) {
+            for (double q : kQuantiles) {
+                out << "spellingbee_phase_duration_quantile_seconds{" << prometheus_labels(key) << ",quantile=\"" << q
+                    << "\"} " << snap.percentile(q) / 1e9 << "\n";
+            }
+        }
+        if (kAllocPhasesBuilt) {
+            const auto totals = alloc_phase_totals();
+            out << "# HELP spellingbee_phase_allocations_total Heap allocations made in each phase.\n"
+                << "# TYPE spellingbee_phase_allocations_total counter\n";
+            for (const auto& [phase, count, bytes] : totals) {
+                out << "spellingbee_phase_allocations_total{phase=\"" << phase << "\"} " << count << "\n";
+            }
+            out << "# HELP spellingbee_phase_allocated_bytes_total Heap bytes allocated in each phase.\n"
+                << "# TYPE spellingbee_phase_allocated_bytes_total counter\n";
+            for (const auto& [phase, count, bytes] : totals) {
+                out << "spellingbee_phase_allocated_bytes_total{phase=\"" << phase << "\"} " << bytes << "\n";
+            }
+        }
+        return out.str();
+    }
+
+    // Each file is written beside its final name and renamed over it, so a scraper never
+    // reads half a file. Serialized, since SIGUSR1 can arrive while exiting.
+    void write_files(const fs::path& prefix) const {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        const std::pair<std::string, std::string> files[] = {
+            {prefix.string() + ".prom", prometheus_text()},
+            {prefix.string() + ".json", summary_json().dump(2) + "\n"},
+        };
+        for (const auto& [path, text] : files) {
+            const std::string tmp = path + ".tmp";
+            std::ofstream out(tmp, std::ios::trunc);
+            out << text;
+            out.close();
+            std::error_code ec;
+            if (out) fs::rename(tmp, path, ec);
+            if (!out || ec) log_at(LogLevel::Warn, "Could not write metrics to ", path);
+        }
+    }
+
+private:
+    using Key = std::pair<std::string, std::string>;
+
+    std::vector<std::pair<Key, LatencyHistogram::Snapshot>> snapshots() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::pair<Key, LatencyHistogram::Snapshot>> out;
+        for (const auto& [key, histogram] : histograms_) out.emplace_back(key, histogram->snapshot());
+        return out;
+    }
+
+    static std::string prometheus_labels(const Key& key) {
+        auto escape = [](const std::string& value) {
+            std::string out;
+            for (char c : value) {
+                if (c == '\\' || c == '"') out += '\\';
+                out += c == '\n' ? 'n' : c;
+            }
+            return out;
+        };
+        return "phase=\"" + escape(key.first) + "\",detail=\"" + escape(key.second) + "\"";
+    }
+
+    mutable std::mutex mutex_;
+    mutable std::mutex write_mutex_;
+    std::map<Key, std::unique_ptr<LatencyHistogram>> histograms_;
+};
+
+static PhaseMetrics g_phase_metrics;
+
+static void record_phase(std::string_view phase, std::string_view detail, uint64_t ns) {
+    if (!g_phase_metrics_enabled.load(std::memory_order_relaxed)) return;
+    g_phase_metrics.histogram(std::string(phase), std::string(detail)).record(ns);
+}
+
+// Records the time from construction to destruction as one sample of `phase`.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(const char* phase, const char* detail = "")
+        : phase_(phase), detail_(detail), start_(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        record_phase(phase_, detail_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    const char* phase_;
+    const char* detail_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Writes the metrics files whenever SIGUSR1 arrives. Called before any thread but the log
+// writer starts, so the rest inherit the blocked mask; the writer blocks the signal itself
+// (Logger::start). Only this thread takes it.
+static void start_metrics_signal_thread(const fs::path& prefix) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+    std::thread([set, prefix] {
+        for (;;) {
+            int sig = 0;
+            if (sigwait(&set, &sig) == 0 && sig == SIGUSR1) g_phase_metrics.write_files(prefix);
+        }
+    }).detach();
+}
+
+// ---------- Trace timeline ----------
+// With --trace=FILE a run is also written as Chrome trace-event JSON, for chrome://tracing
+// or Perfetto. The "run" track nests each run_attempt, its steps, every retry_with_pause
+// attempt and backoff, and the HTTP requests each attempt made; solving, which can overlap
+// those steps, gets a track of its own, and concurrent --async-webdriver requests show as
+// async spans. Waits at a prompt are in the "human" category, so time spent on the person
+// at the keyboard stands apart from machine time. Without the flag spans cost one load.
+class TraceLog {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr uint32_t kRunTrack = 1;
+    static constexpr uint32_t kSolveTrack = 2;
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void enable() {
+        origin_ = Clock::now();
+        enabled_ = true;
+    }
+
+    // A span on `track` that started and ended on one thread; spans on a track must nest.
+    void complete(uint32_t track, std::string name, const char* category, Clock::time_point start,
+                  Clock::time_point end, json args = {}) {
+        json event = {{"name", std::move(name)}, {"cat", category}, {"ph", "X"}, {"ts", micros(start)},
+                      {"dur", std::chrono::duration<double, std::micro>(end - start).count()},
+                      {"pid", pid_}, {"tid", track}};
+        if (!args.is_null()) event["args"] = std::move(args);
+        push(std::move(event));
+    }
+
+    // One half of a span that may overlap its siblings; `id` pairs the begin with its end.
+    void async_edge(bool begin, uint64_t id, const std::string& name, const char* category, Clock::time_point at,
+                    json args = {}) {
+        json event = {{"name", name}, {"cat", category}, {"ph", begin ? "b" : "e"}, {"id", id},
+                      {"ts", micros(at)}, {"pid", pid_}, {"tid", kRunTrack}};
+        if (!args.is_null()) event["args"] = std::move(args);
+        push(std::move(event));
+    }
+
+    uint64_t next_async_id() { return next_async_id_.fetch_add(1, std::memory_order_relaxed); }
+
+    // Written beside the final name and renamed over it, like the metrics files.
+    void write(const fs::path& path) const {
+        json events = json::array();
+        events.push_back(metadata("process_name", 0, "spellingbee"));
+        events.push_back(metadata("thread_name", kRunTrack, "run"));
+        events.push_back(metadata("thread_name", kSolveTrack, "solve"));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& e : events_) events.push_back(e);
+        }
+        const std::string tmp = path.string() + ".tmp";
+        std::ofstream out(tmp, std::ios::trunc);
+        out << json{{"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"}}.dump() << "\n";
+        out.close();
+        std::error_code ec;
+        if (out) fs::rename(tmp, path, ec);
+        if (!out || ec) log_at(LogLevel::Warn, "Could not write the trace to ", path.string());
+    }
+
+private:
+    double micros(Clock::time_point at) const { return std::chrono::duration<double, std::micro>(at - origin_).count(); }
+
+    json metadata(const char* what, uint32_t track, const char* name) const {
+        return {{"name", what}, {"ph", "M"}, {"pid", pid_}, {"tid", track}, {"args", {{"name", name}}}};
+    }
+
+    void push(json event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.push_back(std::move(event));
+    }
+
+    std::atomic<bool> enabled_{false};
+    Clock::time_point origin_;
+    const long pid_ = static_cast<long>(getpid());
+    std::atomic<uint64_t> next_async_id_{1};
+    mutable std::mutex mutex_;
+    std::vector<json> events_;
+};
+
+static TraceLog g_trace;
+// The track spans started on this thread go to; worker threads inherit the run track.
+static thread_local uint32_t t_trace_track = TraceLog::kRunTrack;
+
+// A span from construction to destruction on the current thread's track. args() may add
+// to the arguments shown for it until then.
+class TraceSpan {
+public:
+    TraceSpan(std::string name, const char* category, json args = {}) {
+        if (!g_trace.enabled()) return;
+        active_ = true;
+        name_ = std::move(name);
+        category_ = category;
+        args_ = std::move(args);
+        track_ = t_trace_track;
+        start_ = TraceLog::Clock::now();
+    }
+    ~TraceSpan() {
+        if (active_) g_trace.complete(track_, std::move(name_), category_, start_, TraceLog::Clock::now(), std::move(args_));
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    json* args() { return active_ ? &args_ : nullptr; }
+
+private:
+    bool active_ = false;
+    std::string name_;
+    const char* category_ = "";
+    json args_;
+    uint32_t track_ = TraceLog::kRunTrack;
+    TraceLog::Clock::time_point start_;
+};
+
+// ---------- Cancellation & deadlines ----------
+// Ctrl-C during a workflow sets g_cancel_requested instead of killing the process; every
+// in-flight transfer is then aborted from curl's progress callback, which also enforces the
+// deadline of the step it was issued from. Outside a workflow Ctrl-C keeps its default
+// behaviour. Chrome runs detached either way, so it survives.
+static std::atomic<bool> g_cancel_requested{false};
+static volatile std::sig_atomic_t g_workflow_active = 0;
+
+static void handle_interrupt(int) {
+    if (!g_workflow_active) {
+        std::signal(SIGINT, SIG_DFL);
+        std::raise(SIGINT);
+        return;
+    }
+    g_cancel_requested.store(true);
+}
+
+static void install_interrupt_handler() {
+    struct sigaction sa {};
+    sa.sa_handler = handle_interrupt;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;   // no SA_RESTART: a blocked prompt read returns so the workflow can unwind
+    sigaction(SIGINT, &sa, nullptr);
+}
+
+// Helper threads call this first so SIGINT is always delivered to the main thread, whose
+// prompt reads it has to interrupt.
+static void block_interrupt_signal() {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+}
+
+struct StepBudget {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    static StepBudget after(std::chrono::milliseconds limit) {
+        StepBudget budget;
+        if (limit.count() > 0) budget.deadline = std::chrono::steady_clock::now() + limit;
+        return budget;
+    }
+    bool expired() const { return std::chrono::steady_clock::now() > deadline; }
+};
+
+// Budget of the workflow step running on this thread, if any.
+static thread_local const StepBudget* t_step_budget = nullptr;
+
+struct StepInterrupted : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// A transfer that failed below HTTP (refused, reset, timed out); `code` drives retry decisions.
+struct TransportError : std::runtime_error {
+    CURLcode code;
+    TransportError(CURLcode c, const std::string& what) : std::runtime_error(what), code(c) {}
+};
+
+static int abort_interrupted_transfer(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    if (g_cancel_requested.load(std::memory_order_relaxed)) return 1;
+    const auto* budget = static_cast<const StepBudget*>(clientp);
+    return budget && budget->expired() ? 1 : 0;
+}
+
+static std::exception_ptr curl_failure(CURLcode code) {
+    if (code == CURLE_ABORTED_BY_CALLBACK) {
+        return std::make_exception_ptr(
+            StepInterrupted(g_cancel_requested ? "cancelled by user" : "step deadline exceeded"));
+    }
+    std::ostringstream oss; oss << "CURL error: " << curl_easy_strerror(code);
+    return std::make_exception_ptr(TransportError(code, oss.str()));
+}
+
+// ---------- Transport tuning ----------
+// Per-request timeouts: reads fail fast so a retry can start, navigation and new sessions
+// get the time Chrome needs, and typing or script calls may run long. The step deadline
+// bounds every one of them as well.
+static constexpr std::chrono::seconds kReadTimeout{10};
+static constexpr std::chrono::seconds kCommandTimeout{30};
+static constexpr std::chrono::seconds kNavigationTimeout{60};
+static constexpr std::chrono::seconds kInputTimeout{120};
+
+static std::chrono::milliseconds request_timeout(const std::string& method, const std::string& url) {
+    auto ends_with = [&](std::string_view suffix) {
+        return url.size() >= suffix.size() && url.compare(url.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    if (ends_with("/actions") || ends_with("/execute/sync") || ends_with("/value")) return kInputTimeout;
+    if (method == "POST" && (ends_with("/session") || ends_with("/url"))) return kNavigationTimeout;
+    if (method == "GET") return kReadTimeout;
+    return kCommandTimeout;
+}
+
+// "POST /session/{id}/element/{id}/click" for a request URL: the path with session and
+// element ids masked, so calls to the same endpoint aggregate.
+static std::string endpoint_label(const std::string& method, const std::string& url) {
+    const auto scheme = url.find("://");
+    const auto path_start = url.find('/', scheme == std::string::npos ? 0 : scheme + 3);
+    std::string label = method + " ";
+    if (path_start == std::string::npos) return label + "/";
+    std::istringstream path(url.substr(path_start + 1));
+    bool mask_next = false;
+    for (std::string segment; std::getline(path, segment, '/');) {
+        label += "/";
+        label += mask_next ? "{id}" : segment;
+        mask_next = !mask_next && (segment == "session" || segment == "element");
+    }
+    return label;
+}
+
+// Per-endpoint call counts and timings, from curl's own transfer measurements.
+struct TransportStats {
+    struct Endpoint {
+        size_t calls = 0;
+        size_t failures = 0;
+        double total_ms = 0;
+        double max_ms = 0;
+        double connect_ms = 0;       // summed; non-zero only for calls that opened a connection
+        double first_byte_ms = 0;    // summed time to the first response byte
+        curl_off_t bytes_sent = 0;
+        curl_off_t bytes_received = 0;
+    };
+    std::map<std::string, Endpoint> endpoints;
+
+    void record(CURL* curl, const std::string& method, const std::string& url, bool ok) {
+        const std::string label = endpoint_label(method, url);
+        auto& e = endpoints[label];
+        curl_off_t total_us = 0, connect_us = 0, first_byte_us = 0, sent = 0, received = 0;
+        curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total_us);
+        record_phase("webdriver", label, static_cast<uint64_t>(total_us) * 1000);
+        curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect_us);
+        curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &first_byte_us);
+        curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &sent);
+        curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &received);
+        ++e.calls;
+        if (!ok) ++e.failures;
+        e.total_ms += total_us / 1000.0;
+        e.max_ms = std::max(e.max_ms, total_us / 1000.0);
+        e.connect_ms += connect_us / 1000.0;
+        e.first_byte_ms += first_byte_us / 1000.0;
+        e.bytes_sent += sent;
+        e.bytes_received += received;
+    }
+
+    void merge(const TransportStats& other) {
+        for (const auto& [label, o] : other.endpoints) {
+            auto& e = endpoints[label];
+            e.calls += o.calls;
+            e.failures += o.failures;
+            e.total_ms += o.total_ms;
+            e.max_ms = std::max(e.max_ms, o.max_ms);
+            e.connect_ms += o.connect_ms;
+            e.first_byte_ms += o.first_byte_ms;
+            e.bytes_sent += o.bytes_sent;
+            e.bytes_received += o.bytes_received;
+        }
+    }
+
+    void print(std::ostream& out) const {
+        if (endpoints.empty()) return;
+        out << "Transport (calls, failures, mean/max ms, mean first byte ms, connect ms, bytes out/in):\n";
+        for (const auto& [label, e] : endpoints) {
+            out << "  " << std::left << std::setw(52) << label << std::right << std::fixed << std::setprecision(1)
+                << std::setw(6) << e.calls << std::setw(4) << e.failures
+                << std::setw(9) << e.total_ms / e.calls << std::setw(9) << e.max_ms
+                << std::setw(9) << e.first_byte_ms / e.calls << std::setw(9) << e.connect_ms
+                << std::setw(10) << e.bytes_sent << std::setw(10) << e.bytes_received << "\n";
+        }
+        out << std::defaultfloat;
+    }
+};
+
+// ---------- Traffic recording ----------
+// --record=FILE writes one JSON line per WebDriver request: when it started (ms since the
+// recording began), method, URL, payload, status, latency and the raw response body.
+// tools/replay_webdriver.py serves a recording back with the same timings, so request
+// counts and wall time can be compared between builds on the traffic of a real run.
+class TrafficRecorder {
+public:
+    explicit TrafficRecorder(const fs::path& path) : out_(path, std::ios::trunc), start_(std::chrono::steady_clock::now()) {
+        if (!out_) throw std::runtime_error("cannot write recording to " + path.string());
+    }
+
+    // `status` is 0 when the transfer failed below HTTP; `code` then says why.
+    void record(CURL* curl, const std::string& method, const std::string& url, const std::string& payload,
+                CURLcode code, const std::string& response) {
+        curl_off_t total_us = 0;
+        long status = 0;
+        curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total_us);
+        if (code == CURLE_OK) curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+        const auto finished = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_);
+        json line = {
+            {"t_ms", finished.count() - total_us / 1000.0},
+            {"method", method},
+            {"url", url},
+            {"request_bytes", payload.size()},
+            {"payload", payload},
+            {"status", status},
+            {"latency_ms", total_us / 1000.0},
+            {"response", response},
+        };
+        if (code != CURLE_OK) line["error"] = curl_easy_strerror(code);
+        const std::string text = line.dump(-1, ' ', false, json::error_handler_t::replace);
+        std::lock_guard<std::mutex> lock(mutex_);
+        out_ << text << '\n';
+    }
+
+private:
+    std::ofstream out_;
+    std::chrono::steady_clock::time_point start_;
+    std::mutex mutex_;   // the blocking and the async client may both record
+};
+
+// Shared per-request setup for the blocking and the multi-handle clients. `payload` must
+// stay alive until the transfer completes (curl does not copy POSTFIELDS).
+static void configure_request(CURL* curl, const std::string& method, const std::string& url,
+                              const std::string& payload, std::string* body_out, const StepBudget* budget) {
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, static_cast<long>(request_timeout(method, url).count()));
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, budget);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, body_out);
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 0L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, nullptr);
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, nullptr);
+
+    if (method == "GET") {
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    } else if (method == "POST") {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "POST");
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
+    } else if (method == "DELETE") {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+        if (!payload.empty()) curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
+        else curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "");
+    } else {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
+    }
+}
+
+static void configure_handle_defaults(CURL* curl, struct curl_slist* headers) {
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, 30L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, 15L);
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, abort_interrupted_transfer);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+}
+
+// ---------- Response decoding ----------
+// Most WebDriver replies are read for one field: value, value.<element key>,
+// value.sessionId. JsonScan walks the reply text to that field without building a tree;
+// only the field itself is copied out, with escapes decoded. Replies whose whole value we
+// need (execute_script) still go through json::parse.
+using JsonPath = std::initializer_list<std::string_view>;
+
+struct JsonScan {
+    static constexpr int kMaxDepth = 64;
+    const char* p;
+    const char* end;
+
+    explicit JsonScan(std::string_view text) : p(text.data()), end(text.data() + text.size()) {}
+
+    void skip_ws() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    }
+    // At '"': moves past the closing quote.
+    bool skip_string() {
+        if (p >= end || *p != '"') return false;
+        for (++p; p < end; ++p) {
+            if (*p == '\\') ++p;
+            else if (*p == '"') { ++p; return true; }
+        }
+        return false;
+    }
+    bool skip_value(int depth = 0) {
+        skip_ws();
+        if (p >= end || depth > kMaxDepth) return false;
+        if (*p == '"') return skip_string();
+        if (*p == '{' || *p == '[') {
+            const char close = *p == '{' ? '}' : ']';
+            ++p;
+            skip_ws();
+            if (p < end && *p == close) { ++p; return true; }
+            for (;;) {
+                if (close == '}') {
+                    skip_ws();
+                    if (!skip_string()) return false;
+                    skip_ws();
+                    if (p >= end || *p != ':') return false;
+                    ++p;
+                }
+                if (!skip_value(depth + 1)) return false;
+                skip_ws();
+                if (p < end && *p == ',') { ++p; continue; }
+                if (p < end && *p == close) { ++p; return true; }
+                return false;
+            }
+        }
+        // number, true, false, null
+        const char* start = p;
+        while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') ++p;
+        return p > start;
+    }
+    // At '{': leaves p at the value of member `key`, or returns false.
+    bool enter_member(std::string_view key);
+};
+
+// Decodes the inside of a JSON string literal (escapes, \uXXXX and surrogate pairs) into `out`.
+static bool json_unescape(std::string_view raw, std::string& out) {
+    out.clear();
+    out.reserve(raw.size());
+    auto hex4 = [&](size_t at, uint32_t& cp) {
+        if (at + 4 > raw.size()) return false;
+        cp = 0;
+        for (size_t k = at; k < at + 4; ++k) {
+            const char c = raw[k];
+            cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= static_cast<uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') cp |= static_cast<uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') cp |= static_cast<uint32_t>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    };
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\\') { out += raw[i]; continue; }
+        if (++i >= raw.size()) return false;
+        switch (raw[i]) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t cp = 0;
+                if (!hex4(i + 1, cp)) return false;
+                i += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    uint32_t low = 0;
+                    if (i + 2 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u' && hex4(i + 3, low) &&
+                        low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                if (cp < 0x80) {
+                    out += static_cast<char>(cp);
+                } else if (cp < 0x800) {
+                    out += static_cast<char>(0xC0 | (cp >> 6));
+                    out += static_cast<char>(0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    out += static_cast<char>(0xE0 | (cp >> 12));
+                    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (cp & 0x3F));
+                } else {
+                    out += static_cast<char>(0xF0 | (cp >> 18));
+                    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default: return false;
+        }
+    }
+    return true;
+}
+
+bool JsonScan::enter_member(std::string_view key) {
+    if (p >= end || *p != '{') return false;
+    ++p;
+    std::string decoded;
+    for (;;) {
+        skip_ws();
+        if (p < end && *p == '}') return false;
+        const char* key_start = p + 1;
+        if (!skip_string()) return false;
+        const std::string_view raw(key_start, static_cast<size_t>(p - 1 - key_start));
+        const bool match = raw.find('\\') == std::string_view::npos ? raw == key
+                                                                       : json_unescape(raw, decoded) && decoded == key;
+        skip_ws();
+        if (p >= end || *p != ':') return false;
+        ++p;
+        skip_ws();
+        if (match) return true;
+        if (!skip_value(1)) return false;
+        skip_ws();
+        if (p < end && *p == ',') { ++p; continue; }
+        return false;
+    }
+}
+
+// The raw text of the value at `path` (object keys from the root), quotes included for strings.
+static std::optional<std::string_view> json_value_at(std::string_view doc, const std::string_view* first,
+                                                     const std::string_view* last) {
+    JsonScan scan(doc);
+    scan.skip_ws();
+    for (; first != last; ++first) {
+        if (!scan.enter_member(*first)) return std::nullopt;
+    }
+    const char* start = scan.p;
+    if (!scan.skip_value()) return std::nullopt;
+    return std::string_view(start, static_cast<size_t>(scan.p - start));
+}
+
+static std::optional<std::string_view> json_value_at(std::string_view doc, JsonPath path) {
+    return json_value_at(doc, path.begin(), path.end());
+}
+
+// The string at `path`, decoded; nullopt when it is missing or not a string.
+static std::optional<std::string> json_string_at(std::string_view doc, JsonPath path) {
+    const auto raw = json_value_at(doc, path);
+    std::string out;
+    if (!raw || raw->size() < 2 || raw->front() != '"' || !json_unescape(raw->substr(1, raw->size() - 2), out)) {
+        return std::nullopt;
+    }
+    return out;
+}
+
+// Non-2xx WebDriver reply. `error` is the W3C error code from the body ("stale element
+// reference", "invalid session id", ...), empty when the body carried none.
+struct WebDriverError : std::runtime_error {
+    long status;
+    std::string error;
+    WebDriverError(long s, std::string e, const std::string& what)
+        : std::runtime_error(what), status(s), error(std::move(e)) {}
+};
+
+// The headers every WebDriver request carries. The empty Expect: stops curl from sending
+// "Expect: 100-continue" on large POST bodies (the /actions payload) and then waiting up to
+// a second for a 100 response chromedriver never sends.
+static struct curl_slist* make_common_headers() {
+    struct curl_slist* headers = curl_slist_append(nullptr, "Content-Type: application/json");
+    return curl_slist_append(headers, "Expect:");
+}
+
+static void check_wd_status(const HttpResponse& resp, const std::string& url) {
+    if (resp.status < 200 || resp.status >= 300) {
+        AllocPhaseScope alloc_phase(AllocPhase::Response);
+        std::string error = json_string_at(resp.body, {"value", "error"}).value_or("");
+        std::ostringstream oss; oss << "HTTP " << resp.status << " from " << url << " body: " << resp.body;
+        throw WebDriverError(resp.status, std::move(error), oss.str());
+    }
+}
+
+static json parse_wd_response(const HttpResponse& resp, const std::string& url) {
+    AllocPhaseScope alloc_phase(AllocPhase::Response);
+    check_wd_status(resp, url);
+    return resp.body.empty() ? json() : json::parse(resp.body);
+}
+
+// The string at `path` of a successful reply; a null there reads as "".
+static std::string reply_string(const HttpResponse& resp, const std::string& url,
+                                const std::string_view* first, const std::string_view* last) {
+    AllocPhaseScope alloc_phase(AllocPhase::Response);
+    check_wd_status(resp, url);
+    const auto raw = json_value_at(resp.body, first, last);
+    std::string out;
+    if (raw && *raw == "null") return out;
+    if (raw && raw->size() >= 2 && raw->front() == '"' && json_unescape(raw->substr(1, raw->size() - 2), out)) {
+        return out;
+    }
+    throw std::runtime_error("unexpected reply from " + url + ": " + resp.body);
+}
+
+static std::string reply_string(const HttpResponse& resp, const std::string& url, JsonPath path) {
+    return reply_string(resp, url, path.begin(), path.end());
+}
+
 struct CurlSession {
     CURL* curl = nullptr;
     struct curl_slist* common_headers = nullptr;
+    size_t request_count = 0;
+    size_t connections_opened = 0;
+    TransportStats stats;
+    TrafficRecorder* recorder = nullptr;
+    HttpResponse response;   // reused, so the body keeps its capacity from one request to the next
+    std::string payload;     // the request body; request_ok_with bodies reuse its capacity
     CurlSession() {
         curl = curl_easy_init();
         if (!curl) throw std::runtime_error("curl_easy_init failed");
-        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
-        curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, 30L);
-        curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, 15L);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 60L);
-        common_headers = curl_slist_append(common_headers, "Content-Type: application/json");
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, common_headers);
+        common_headers = make_common_headers();
+        configure_handle_defaults(curl, common_headers);
     }
     ~CurlSession() {
         if (common_headers) curl_slist_free_all(common_headers);
         if (curl) curl_easy_cleanup(curl);
     }
-    HttpResponse request(const std::string& method, const std::string& url, const std::string& payload = "") {
-        HttpResponse resp; resp.body.clear();
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &resp.body);
-        curl_easy_setopt(curl, CURLOPT_HTTPGET, 0L);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, nullptr);
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, nullptr);
-
-        if (method == "GET") {
-            curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
-        } else if (method == "POST") {
-            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "POST");
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
-        } else if (method == "DELETE") {
-            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-            if (!payload.empty()) curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
-            else curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "");
-        } else {
-            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
+    CurlSession(const CurlSession&) = delete;
+    CurlSession& operator=(const CurlSession&) = delete;
+
+    // The reply stays valid until the next request.
+    const HttpResponse& request(const std::string& method, const std::string& url, const std::string& body = "") {
+        TraceSpan span(g_trace.enabled() ? endpoint_label(method, url) : std::string(), "http");
+        AllocPhaseScope alloc_phase(AllocPhase::Response);
+        response.status = 0;
+        response.body.clear();
+        configure_request(curl, method, url, body, &response.body, t_step_budget);
+        CURLcode code = curl_easy_perform(curl);
+        ++request_count;
+        stats.record(curl, method, url, code == CURLE_OK);
+        if (recorder) recorder->record(curl, method, url, body, code, response.body);
+        if (code != CURLE_OK) {
+            if (json* args = span.args()) (*args)["error"] = curl_easy_strerror(code);
+            std::rethrow_exception(curl_failure(code));
+        }
+        long new_connections = 0;
+        curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &new_connections);
+        connections_opened += static_cast<size_t>(new_connections);
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+        if (json* args = span.args()) {
+            *args = {{"status", response.status}, {"bytes_out", body.size()}, {"bytes_in", response.body.size()},
+                     {"new_connection", new_connections > 0}};
+        }
+        return response;
+    }
+    json request_json(const std::string& method, const std::string& url, const json& body = {}) {
+        return parse_wd_response(send(method, url, body), url);
+    }
+    // For commands whose reply we ignore: the status is checked, the body only read on error.
+    void request_ok(const std::string& method, const std::string& url, const json& body = {}) {
+        check_wd_status(send(method, url, body), url);
+    }
+    // For bodies written as text rather than built as a json tree: `write` appends the body
+    // to the reused payload buffer.
+    template <typename Write>
+    void request_ok_with(const std::string& method, const std::string& url, Write&& write) {
+        payload.clear();
+        {
+            AllocPhaseScope alloc_phase(AllocPhase::Payload);
+            write(payload);
+        }
+        check_wd_status(request(method, url, payload), url);
+    }
+    const HttpResponse& request_checked(const std::string& method, const std::string& url, const json& body = {}) {
+        const HttpResponse& resp = send(method, url, body);
+        check_wd_status(resp, url);
+        return resp;
+    }
+    // One string field of the reply, scanned for rather than parsed into a tree.
+    std::string request_string(const std::string& method, const std::string& url, JsonPath path, const json& body = {}) {
+        return reply_string(send(method, url, body), url, path);
+    }
+
+private:
+    const HttpResponse& send(const std::string& method, const std::string& url, const json& body) {
+        payload.clear();
+        if (!body.is_null()) {
+            AllocPhaseScope alloc_phase(AllocPhase::Payload);
+            payload = body.dump();
+        }
+        return request(method, url, payload);
+    }
+};
+
+// Non-blocking client: one curl_multi handle driven by its own event-loop thread. Requests
+// return futures immediately, so independent WebDriver calls can be in flight together.
+// All transfers share the multi handle's connection cache; connections_opened versus
+// request_count shows whether keep-alive connections are actually being reused.
+struct AsyncCurlClient {
+    struct Pending {
+        std::string method;
+        std::string url;
+        std::string payload;
+        StepBudget budget;   // copied from the submitting thread
+        uint64_t trace_id = 0;   // async span id while tracing
+        HttpResponse resp;
+        std::promise<HttpResponse> promise;
+    };
+
+    CURLM* multi = nullptr;
+    struct curl_slist* common_headers = nullptr;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Pending>> submitted;   // guarded by mutex
+    std::vector<CURL*> idle_handles;                    // event-loop thread only
+    std::vector<CURL*> in_flight;                       // event-loop thread only
+    std::atomic<bool> stopping{false};
+    std::atomic<size_t> request_count{0};
+    std::atomic<size_t> connections_opened{0};
+    std::mutex stats_mutex;
+    TransportStats stats;                               // guarded by stats_mutex
+    TrafficRecorder* recorder = nullptr;                // set before the first request
+    std::vector<std::string> spare_bodies;              // response buffers to reuse; guarded by mutex
+    std::thread loop;
+
+    explicit AsyncCurlClient(long max_host_connections = 8) {
+        multi = curl_multi_init();
+        if (!multi) throw std::runtime_error("curl_multi_init failed");
+        curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+        curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, max_host_connections);
+        curl_multi_setopt(multi, CURLMOPT_PIPELINING, static_cast<long>(CURLPIPE_MULTIPLEX));
+        common_headers = make_common_headers();
+        loop = std::thread([this] {
+            block_interrupt_signal();
+            AllocPhaseScope alloc_phase(AllocPhase::Response);   // the loop only moves requests and replies
+            run_loop();
+        });
+    }
+    ~AsyncCurlClient() {
+        stopping = true;
+        curl_multi_wakeup(multi);
+        if (loop.joinable()) loop.join();
+        for (CURL* h : idle_handles) curl_easy_cleanup(h);
+        curl_multi_cleanup(multi);
+        if (common_headers) curl_slist_free_all(common_headers);
+    }
+    AsyncCurlClient(const AsyncCurlClient&) = delete;
+    AsyncCurlClient& operator=(const AsyncCurlClient&) = delete;
+
+    std::future<HttpResponse> request(const std::string& method, const std::string& url, const std::string& payload = "") {
+        auto pending = std::make_unique<Pending>();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!spare_bodies.empty()) {
+                pending->resp.body = std::move(spare_bodies.back());
+                spare_bodies.pop_back();
+            }
+        }
+        pending->method = method;
+        pending->url = url;
+        pending->payload = payload;
+        if (t_step_budget) pending->budget = *t_step_budget;
+        auto fut = pending->promise.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            submitted.push_back(std::move(pending));
+        }
+        curl_multi_wakeup(multi);
+        return fut;
+    }
+
+    // One string field of the reply. The returned future extracts it lazily, on get(), in
+    // the caller's thread, then hands the response buffer back for a later request. `path`
+    // must name string literals or other storage outliving the future.
+    std::future<std::string> request_string(const std::string& method, const std::string& url, JsonPath path,
+                                            const json& payload = {}) {
+        auto resp = request(method, url, payload.is_null() ? "" : payload.dump());
+        return std::async(std::launch::deferred, [this, resp = std::move(resp), url,
+                                                  keys = std::vector<std::string_view>(path)]() mutable {
+            HttpResponse r = resp.get();
+            std::string value = reply_string(r, url, keys.data(), keys.data() + keys.size());
+            recycle_body(std::move(r.body));
+            return value;
+        });
+    }
+
+    TransportStats stats_snapshot() {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        return stats;
+    }
+
+private:
+    static constexpr size_t kMaxSpareBodies = 16;
+
+    void recycle_body(std::string body) {
+        body.clear();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (spare_bodies.size() < kMaxSpareBodies) spare_bodies.push_back(std::move(body));
+    }
+
+    void start_pending(std::unique_ptr<Pending> pending) {
+        CURL* easy = nullptr;
+        if (!idle_handles.empty()) {
+            easy = idle_handles.back();
+            idle_handles.pop_back();
+        } else {
+            easy = curl_easy_init();
+            if (!easy) {
+                pending->promise.set_exception(std::make_exception_ptr(std::runtime_error("curl_easy_init failed")));
+                return;
+            }
+            configure_handle_defaults(easy, common_headers);
+        }
+        configure_request(easy, pending->method, pending->url, pending->payload, &pending->resp.body, &pending->budget);
+        if (g_trace.enabled()) {
+            pending->trace_id = g_trace.next_async_id();
+            g_trace.async_edge(true, pending->trace_id, endpoint_label(pending->method, pending->url), "http",
+                               TraceLog::Clock::now());
+        }
+        curl_easy_setopt(easy, CURLOPT_PRIVATE, pending.release());
+        curl_multi_add_handle(multi, easy);
+        in_flight.push_back(easy);
+    }
+
+    void finish(CURL* easy, CURLcode code) {
+        char* priv = nullptr;
+        curl_easy_getinfo(easy, CURLINFO_PRIVATE, &priv);
+        std::unique_ptr<Pending> pending(reinterpret_cast<Pending*>(priv));
+        curl_multi_remove_handle(multi, easy);
+        in_flight.erase(std::find(in_flight.begin(), in_flight.end(), easy));
+        ++request_count;
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            stats.record(easy, pending->method, pending->url, code == CURLE_OK);
+        }
+        if (recorder) recorder->record(easy, pending->method, pending->url, pending->payload, code, pending->resp.body);
+        if (pending->trace_id) {
+            long status = 0;
+            curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+            g_trace.async_edge(false, pending->trace_id, endpoint_label(pending->method, pending->url), "http",
+                               TraceLog::Clock::now(),
+                               code == CURLE_OK ? json{{"status", status}} : json{{"error", curl_easy_strerror(code)}});
+        }
+        if (code != CURLE_OK) {
+            pending->promise.set_exception(curl_failure(code));
+        } else {
+            long new_connections = 0;
+            curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &new_connections);
+            connections_opened += static_cast<size_t>(new_connections);
+            curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &pending->resp.status);
+            pending->promise.set_value(std::move(pending->resp));
+        }
+        idle_handles.push_back(easy);
+    }
+
+    void run_loop() {
+        int running = 0;
+        while (!stopping) {
+            std::vector<std::unique_ptr<Pending>> batch;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                batch.swap(submitted);
+            }
+            for (auto& pending : batch) start_pending(std::move(pending));
+            curl_multi_perform(multi, &running);
+            int queued = 0;
+            while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+                if (msg->msg == CURLMSG_DONE) finish(msg->easy_handle, msg->data.result);
+            }
+            curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+        }
+        // Fail whatever is still queued or in flight so no caller blocks forever.
+        const auto abandoned = std::make_exception_ptr(std::runtime_error("async curl client shut down"));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& pending : submitted) pending->promise.set_exception(abandoned);
+            submitted.clear();
+        }
+        for (CURL* easy : in_flight) {
+            char* priv = nullptr;
+            curl_easy_getinfo(easy, CURLINFO_PRIVATE, &priv);
+            std::unique_ptr<Pending> pending(reinterpret_cast<Pending*>(priv));
+            curl_multi_remove_handle(multi, easy);
+            pending->promise.set_exception(abandoned);
+            idle_handles.push_back(easy);
+        }
+        in_flight.clear();
+    }
+};
+
+// Appends `c` as the body of a JSON string, escaped as json::dump() would.
+static void append_json_char(std::string& out, char c) {
+    switch (c) {
+        case '"': out += "\\\""; return;
+        case '\\': out += "\\\\"; return;
+        case '\b': out += "\\b"; return;
+        case '\f': out += "\\f"; return;
+        case '\n': out += "\\n"; return;
+        case '\r': out += "\\r"; return;
+        case '\t': out += "\\t"; return;
+    }
+    if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[8];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+        out += escaped;
+    } else {
+        out += c;
+    }
+}
+
+// Appends the W3C actions body typing [first, last), each word followed by Enter, with a
+// `pause_ms` pause action between consecutive words. The text is written straight into
+// `out`, byte for byte what dumping the equivalent json tree gives (members in key order),
+// so the only allocations are `out` growing: none per key.
+template <typename It>
+static void append_actions_payload(std::string& out, It first, It last, int pause_ms = 0) {
+    auto key = [&out](const char* type, auto&& write_value) {
+        out += R"({"type":")";
+        out += type;
+        out += R"(","value":")";
+        write_value();
+        out += "\"},";
+    };
+    out += R"({"actions":[{"actions":[)";
+    const size_t empty = out.size();
+    for (bool first_word = true; first != last; ++first, first_word = false) {
+        if (pause_ms > 0 && !first_word) {
+            out += R"({"duration":)";
+            out += std::to_string(pause_ms);
+            out += R"(,"type":"pause"},)";
+        }
+        for (char c : *first) {
+            const char up = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            key("keyDown", [&] { append_json_char(out, up); });
+            key("keyUp", [&] { append_json_char(out, up); });
+        }
+        key("keyDown", [&] { out += "\uE007"; });
+        key("keyUp", [&] { out += "\uE007"; });
+    }
+    if (out.size() > empty) out.pop_back();   // the last event's comma
+    out += R"(],"id":"keyboard","type":"key"}]})";
+}
+
+struct WD {
+    std::string base = "http://localhost:9515";
+    std::string sessionId;
+    std::string debugger_address;   // host:port of Chrome's DevTools endpoint, if reported
+    CurlSession* cs = nullptr;
+    static constexpr const char* kElemKey = "element-6066-11e4-a52e-4f735466cecf";
+    explicit WD(CurlSession& s) : cs(&s) {}
+
+    void new_session() {
+        // Always windowed + keep Chrome open when we exit (detach)
+        json args = {"--disable-features=PaintHolding",
+                     "--disable-extensions",
+                     "--mute-audio",
+                     "--remote-allow-origins=*"}; // Needed for ChromeDriver 111+ handshake
+        json chromeOptions = {{"args", args}, {"detach", true}};
+        json caps = {{"capabilities", {{"alwaysMatch", {{"browserName","chrome"},{"goog:chromeOptions",chromeOptions}}}}}};
+        const std::string url = base + "/session";
+        const HttpResponse& reply = cs->request_checked("POST", url, caps);   // valid until the next request
+        sessionId = reply_string(reply, url, {"value", "sessionId"});
+        debugger_address = json_string_at(reply.body, {"value", "capabilities", "goog:chromeOptions", "debuggerAddress"})
+                               .value_or("");
+    }
+    void delete_session() {
+        if (!sessionId.empty()) {
+            cs->request_ok("DELETE", base + "/session/" + sessionId);
+            sessionId.clear();
+        }
+    }
+    void navigate(const std::string& url) {
+        cs->request_ok("POST", base + "/session/" + sessionId + "/url", json{{"url", url}});
+    }
+    std::string current_url() {
+        return cs->request_string("GET", base + "/session/" + sessionId + "/url", {"value"});
+    }
+    void set_window_size(int w, int h) {
+        cs->request_ok("POST", base + "/session/" + sessionId + "/window/rect", json{{"width", w},{"height", h}});
+    }
+    std::string find_element_id_css(const std::string& css) {
+        return cs->request_string("POST", base + "/session/" + sessionId + "/element", {"value", kElemKey},
+                                  json{{"using","css selector"},{"value",css}});
+    }
+    std::string get_element_text(const std::string& elemId) {
+        return cs->request_string("GET", base + "/session/" + sessionId + "/element/" + elemId + "/text", {"value"});
+    }
+    std::string get_element_attribute(const std::string& elemId, const std::string& attribute) {
+        return cs->request_string("GET", base + "/session/" + sessionId + "/element/" + elemId + "/attribute/" + attribute,
+                                  {"value"});
+    }
+    json execute_script(const std::string& script, json args = json::array()) {
+        auto j = cs->request_json("POST", base + "/session/" + sessionId + "/execute/sync",
+                                  json{{"script", script},{"args", std::move(args)}});
+        return j.at("value");
+    }
+    void click_element(const std::string& elemId) {
+        cs->request_ok("POST", base + "/session/" + sessionId + "/element/" + elemId + "/click", json::object());
+    }
+    void send_keys_to_element(const std::string& elemId, const std::string& text) {
+        cs->request_ok("POST", base + "/session/" + sessionId + "/element/" + elemId + "/value", json{{"text", text}});
+    }
+    void send_all_words_as_keys(const std::vector<std::string>& words_upper) {
+        send_words_as_keys(words_upper.begin(), words_upper.end());
+    }
+    // One W3C actions request typing [first, last); see append_actions_payload.
+    template <typename It>
+    void send_words_as_keys(It first, It last, int pause_ms = 0) {
+        cs->request_ok_with("POST", base + "/session/" + sessionId + "/actions", [&](std::string& body) {
+            PhaseTimer timer("payload_build", "actions");
+            append_actions_payload(body, first, last, pause_ms);
+        });
+    }
+};
+
+// Future-returning mirror of the read-only WD calls, sharing the session of a blocking WD.
+struct AsyncWD {
+    const WD* wd = nullptr;
+    AsyncCurlClient* client = nullptr;
+    AsyncWD(const WD& w, AsyncCurlClient& c) : wd(&w), client(&c) {}
+
+    std::string session_url() const { return wd->base + "/session/" + wd->sessionId; }
+
+    std::future<std::string> find_element_id_css(const std::string& css) {
+        return client->request_string("POST", session_url() + "/element", {"value", WD::kElemKey},
+                                      json{{"using","css selector"},{"value",css}});
+    }
+    std::future<std::string> get_element_text(const std::string& elemId) {
+        return client->request_string("GET", session_url() + "/element/" + elemId + "/text", {"value"});
+    }
+    std::future<std::string> get_element_attribute(const std::string& elemId, const std::string& attribute) {
+        return client->request_string("GET", session_url() + "/element/" + elemId + "/attribute/" + attribute, {"value"});
+    }
+};
+
+// ---------- DevTools input ----------
+// Alternative to W3C /actions for typing the word list: a Chrome DevTools Protocol
+// WebSocket straight to the page, found through the debuggerAddress chromedriver reports
+// in goog:chromeOptions. Commands are pipelined, so chromedriver drops out of the loop
+// and Chrome sees one small message per key event instead of one giant actions chain.
+
+struct CdpError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// curl_ws_recv's frame out-parameter is `struct curl_ws_frame**` in the libcurl releases
+// that introduced it and `const struct curl_ws_frame**` in later ones; `Frame` takes
+// whichever the installed header declares, so both build.
+template <typename Frame>
+static CURLcode ws_recv(CURLcode (*recv)(CURL*, void*, size_t, size_t*, Frame**), CURL* curl, void* buffer,
+                        size_t buflen, size_t* received, const struct curl_ws_frame** meta) {
+    Frame* frame = nullptr;
+    const CURLcode code = recv(curl, buffer, buflen, received, &frame);
+    *meta = frame;
+    return code;
+}
+
+struct CdpClient {
+    CURL* curl = nullptr;
+    curl_socket_t socket = CURL_SOCKET_BAD;
+    int next_id = 1;
+    size_t messages_sent = 0;
+
+    explicit CdpClient(const std::string& ws_url) {
+        curl = curl_easy_init();
+        if (!curl) throw std::runtime_error("curl_easy_init failed");
+        curl_easy_setopt(curl, CURLOPT_URL, ws_url.c_str());
+        curl_easy_setopt(curl, CURLOPT_CONNECT_ONLY, 2L);   // 2: WebSocket upgrade, then hand over
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, abort_interrupted_transfer);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, t_step_budget);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        const CURLcode code = curl_easy_perform(curl);
+        if (code != CURLE_OK) {
+            curl_easy_cleanup(curl);
+            std::rethrow_exception(curl_failure(code));
+        }
+        curl_easy_getinfo(curl, CURLINFO_ACTIVESOCKET, &socket);
+    }
+    CdpClient(const CdpClient&) = delete;
+    CdpClient& operator=(const CdpClient&) = delete;
+    ~CdpClient() {
+        size_t sent = 0;
+        curl_ws_send(curl, "", 0, &sent, 0, CURLWS_CLOSE);
+        curl_easy_cleanup(curl);
+    }
+
+    int send(const std::string& method, const json& params) {
+        const int id = next_id++;
+        const std::string text = json{{"id", id}, {"method", method}, {"params", params}}.dump();
+        size_t offset = 0;
+        while (offset < text.size()) {
+            size_t sent = 0;
+            const CURLcode code = curl_ws_send(curl, text.data() + offset, text.size() - offset, &sent, 0, CURLWS_TEXT);
+            offset += sent;
+            if (code == CURLE_AGAIN) {
+                wait_socket(POLLOUT);
+            } else if (code != CURLE_OK) {
+                std::rethrow_exception(curl_failure(code));
+            }
+        }
+        ++messages_sent;
+        return id;
+    }
+
+    // Next command reply; events in between are skipped. Protocol errors are thrown.
+    json await_reply() {
+        for (;;) {
+            json message = receive();
+            if (!message.contains("id")) continue;
+            if (message.contains("error")) {
+                throw CdpError("DevTools command " + message["id"].dump() + " failed: " + message["error"].dump());
+            }
+            return message;
+        }
+    }
+
+    json call(const std::string& method, const json& params) {
+        const int id = send(method, params);
+        for (;;) {
+            json reply = await_reply();
+            if (reply.value("id", 0) == id) return reply.value("result", json::object());
+        }
+    }
+
+    // Types each word (key events per letter, or one insertText) and presses Enter, keeping
+    // up to kMaxInFlight commands outstanding so neither side's socket buffer fills up.
+    void type_words(const std::vector<std::string>& words_upper, bool insert_text) {
+        constexpr size_t kMaxInFlight = 256;
+        size_t outstanding = 0;
+        auto issue = [&](const char* method, json params) {
+            send(method, params);
+            if (++outstanding >= kMaxInFlight) {
+                for (; outstanding > kMaxInFlight / 2; --outstanding) await_reply();
+            }
+        };
+        auto press = [&](const std::string& key, const std::string& code, int vk, const std::string& text) {
+            issue("Input.dispatchKeyEvent", json{{"type", "keyDown"}, {"key", key}, {"code", code},
+                                                 {"windowsVirtualKeyCode", vk}, {"text", text}});
+            issue("Input.dispatchKeyEvent", json{{"type", "keyUp"}, {"key", key}, {"code", code},
+                                                 {"windowsVirtualKeyCode", vk}});
+        };
+        for (const auto& word : words_upper) {
+            if (insert_text) {
+                issue("Input.insertText", json{{"text", word}});
+            } else {
+                for (char c : word) {
+                    const char up = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                    press(std::string(1, up), std::string("Key") + up, up, std::string(1, up));
+                }
+            }
+            press("Enter", "Enter", 13, "\r");
+        }
+        for (; outstanding > 0; --outstanding) await_reply();
+    }
+
+private:
+    json receive() {
+        std::string message;
+        char buffer[16384];
+        for (;;) {
+            size_t received = 0;
+            const struct curl_ws_frame* meta = nullptr;
+            const CURLcode code = ws_recv(curl_ws_recv, curl, buffer, sizeof(buffer), &received, &meta);
+            if (code == CURLE_AGAIN) {
+                wait_socket(POLLIN);
+                continue;
+            }
+            if (code != CURLE_OK) std::rethrow_exception(curl_failure(code));
+            if (meta->flags & CURLWS_CLOSE) throw CdpError("DevTools connection closed by the browser");
+            if (meta->flags & CURLWS_PING) continue;   // libcurl answers pings itself
+            message.append(buffer, received);
+            if (meta->bytesleft == 0 && !(meta->flags & CURLWS_CONT)) return json::parse(message);
+        }
+    }
+
+    // Waits in short slices so step deadlines and Ctrl-C still apply to the raw socket.
+    void wait_socket(short events) {
+        for (;;) {
+            if (g_cancel_requested || (t_step_budget && t_step_budget->expired())) {
+                std::rethrow_exception(curl_failure(CURLE_ABORTED_BY_CALLBACK));
+            }
+            struct pollfd pfd {socket, events, 0};
+            const int ready = poll(&pfd, 1, 100);
+            if (ready > 0) return;
+            if (ready < 0 && errno != EINTR) throw CdpError("poll on DevTools socket failed");
+        }
+    }
+};
+
+// WebSocket URL of the tab the WebDriver session is showing (first page as a fallback).
+static std::string cdp_page_websocket_url(WD& wd) {
+    if (wd.debugger_address.empty()) {
+        throw CdpError("chromedriver did not report goog:chromeOptions.debuggerAddress for this session");
+    }
+    const std::string current = wd.current_url();
+    const json targets = wd.cs->request_json("GET", "http://" + wd.debugger_address + "/json/list");
+    std::string fallback;
+    for (const auto& target : targets) {
+        if (target.value("type", std::string()) != "page" || !target.contains("webSocketDebuggerUrl")) continue;
+        const auto url = target["webSocketDebuggerUrl"].get<std::string>();
+        if (target.value("url", std::string()) == current) return url;
+        if (fallback.empty()) fallback = url;
+    }
+    if (fallback.empty()) throw CdpError("no page target at DevTools endpoint " + wd.debugger_address);
+    return fallback;
+}
+
+// ---------- Word submission ----------
+// Strategies for typing the solved list into the page. Each types every word followed by
+// Enter and reports how many protocol messages (HTTP requests or DevTools commands) that
+// took; --calibrate-submit measures them against each other.
+struct WordSubmitter {
+    virtual ~WordSubmitter() = default;
+    virtual std::string name() const = 0;
+    virtual size_t submit(WD& wd, const std::vector<std::string>& words_upper) = 0;
+    // Outcome of the last submit(), for strategies that check it.
+    virtual void report(std::ostream&) const {}
+};
+
+// The whole list as one W3C actions chain, or chains of `batch_words` words each.
+struct ActionsSubmitter : WordSubmitter {
+    size_t batch_words;
+    explicit ActionsSubmitter(size_t batch = 0) : batch_words(batch) {}
+    std::string name() const override { return batch_words ? "batched:" + std::to_string(batch_words) : "actions"; }
+    size_t submit(WD& wd, const std::vector<std::string>& words_upper) override {
+        const size_t step = batch_words ? batch_words : std::max<size_t>(words_upper.size(), 1);
+        size_t requests = 0;
+        for (size_t begin = 0; begin < words_upper.size(); begin += step) {
+            const size_t end = std::min(words_upper.size(), begin + step);
+            wd.send_words_as_keys(words_upper.begin() + static_cast<std::ptrdiff_t>(begin),
+                                  words_upper.begin() + static_cast<std::ptrdiff_t>(end));
+            ++requests;
+        }
+        return requests;
+    }
+};
+
+// Element Send Keys on <body>, one request per word; chromedriver types into the focused page.
+struct ElementValueSubmitter : WordSubmitter {
+    std::string name() const override { return "element-value"; }
+    size_t submit(WD& wd, const std::vector<std::string>& words_upper) override {
+        const auto body = wd.find_element_id_css("body");
+        for (const auto& word : words_upper) wd.send_keys_to_element(body, word + "\uE007");
+        return words_upper.size() + 1;
+    }
+};
+
+// Synthetic keydown/keyup events dispatched from page script, kScriptChunk words per call.
+// The events are untrusted (isTrusted false), which pages are free to ignore.
+static constexpr const char* kTypeWordsScript = R"JS(
+const target = document.activeElement || document.body;
+const fire = (type, key) => target.dispatchEvent(
+  new KeyboardEvent(type, {key: key, code: key === 'Enter' ? 'Enter' : 'Key' + key, bubbles: true, cancelable: true}));
+for (const word of arguments[0]) {
+  for (const ch of word) { fire('keydown', ch); fire('keyup', ch); }
+  fire('keydown', 'Enter'); fire('keyup', 'Enter');
+}
+return arguments[0].length;
+)JS";
+
+struct ScriptSubmitter : WordSubmitter {
+    static constexpr size_t kScriptChunk = 500;
+    std::string name() const override { return "script"; }
+    size_t submit(WD& wd, const std::vector<std::string>& words_upper) override {
+        size_t requests = 0;
+        for (size_t begin = 0; begin < words_upper.size(); begin += kScriptChunk) {
+            const size_t end = std::min(words_upper.size(), begin + kScriptChunk);
+            json chunk = json::array();
+            for (size_t i = begin; i < end; ++i) chunk.push_back(words_upper[i]);
+            wd.execute_script(kTypeWordsScript, json::array({std::move(chunk)}));
+            ++requests;
+        }
+        return requests;
+    }
+};
+
+struct DevToolsSubmitter : WordSubmitter {
+    bool insert_text;
+    explicit DevToolsSubmitter(bool text) : insert_text(text) {}
+    std::string name() const override { return insert_text ? "cdp-text" : "cdp-keys"; }
+    size_t submit(WD& wd, const std::vector<std::string>& words_upper) override {
+        CdpClient cdp(cdp_page_websocket_url(wd));
+        cdp.type_words(words_upper, insert_text);
+        return cdp.messages_sent;
+    }
+};
+
+// The words of arguments[0] the page has not accepted, space-separated: those missing from
+// the puzzle's found-word list. Null without a list.
+static constexpr const char* kMissingWordsScript = R"JS(
+const list = document.querySelector('.sb-wordlist-items-pag, .sb-wordlist-box');
+if (!list) return null;
+const found = new Set(Array.from(list.querySelectorAll('.sb-anagram'), el => el.textContent.trim().toUpperCase()));
+return arguments[0].filter(word => !found.has(word)).join(' ');
+)JS";
+
+static std::optional<std::vector<std::string>> missing_words(WD& wd, const std::vector<std::string>& words_upper) {
+    const json missing = wd.execute_script(kMissingWordsScript, json::array({words_upper}));
+    if (!missing.is_string()) return std::nullopt;
+    std::vector<std::string> out;
+    std::istringstream in(missing.get<std::string>());
+    for (std::string word; in >> word;) out.push_back(std::move(word));
+    return out;
+}
+
+// W3C actions in batches of kBatchWords with a pause between words, tuned from what the page
+// accepts. Most words missing from the found-word list were rejected by the game, so only
+// the first kProbeWords of a batch's missing words are typed again at a safer pace. If one
+// of them goes through, keystrokes are being dropped: the batch's other missing words are
+// typed again too and the pause doubles; otherwise the pause shortens by a quarter. Batches
+// are checked less often while no drops turn up (every batch, then every 2nd, 4th, up to
+// kMaxCheckInterval), so a page that rejects most words costs few extra requests.
+struct PacedActionsSubmitter : WordSubmitter {
+    static constexpr size_t kBatchWords = 25;
+    static constexpr size_t kProbeWords = 3;
+    static constexpr size_t kMaxCheckInterval = 8;
+    static constexpr int kMaxPauseMs = 250;
+    static constexpr int kSafePauseMs = 20;
+    static constexpr std::chrono::milliseconds kSettle{60};
+
+    struct Outcome {
+        bool feedback = false;        // the page showed a found-word list to check against
+        size_t submitted = 0;
+        size_t accepted = 0;
+        size_t dropped = 0;           // words that only went through when typed again
+        double seconds = 0;
+        int pause_ms = 0;
+    };
+
+    int pause_ms;
+    Outcome last;
+    explicit PacedActionsSubmitter(int initial_pause_ms) : pause_ms(initial_pause_ms) {}
+
+    std::string name() const override { return "paced"; }
+
+    size_t submit(WD& wd, const std::vector<std::string>& words_upper) override {
+        const auto start = std::chrono::steady_clock::now();
+        last = Outcome{};
+        last.submitted = words_upper.size();
+        size_t requests = 1;
+        // Words the page already lists (a rerun, or a retry of this step) are skipped.
+        auto pending = missing_words(wd, words_upper);
+        last.feedback = pending.has_value();
+        if (!pending) pending = words_upper;
+
+        size_t check_interval = 1;
+        size_t until_check = 0;
+        for (size_t begin = 0; begin < pending->size(); begin += kBatchWords) {
+            const std::vector<std::string> batch(pending->begin() + static_cast<std::ptrdiff_t>(begin),
+                                                 pending->begin() + static_cast<std::ptrdiff_t>(std::min(pending->size(), begin + kBatchWords)));
+            wd.send_words_as_keys(batch.begin(), batch.end(), pause_ms);
+            ++requests;
+            if (!last.feedback) continue;
+            if (until_check > 0) {
+                --until_check;
+                continue;
+            }
+
+            std::this_thread::sleep_for(kSettle);
+            auto missing = missing_words(wd, batch);
+            ++requests;
+            size_t recovered = 0;
+            if (missing && !missing->empty()) {
+                const int safe_pause = std::max(2 * pause_ms, kSafePauseMs);
+                const auto probe_end = missing->begin() + static_cast<std::ptrdiff_t>(std::min(missing->size(), kProbeWords));
+                const std::vector<std::string> probe(missing->begin(), probe_end);
+                wd.send_words_as_keys(probe.begin(), probe.end(), safe_pause);
+                std::this_thread::sleep_for(kSettle);
+                const auto probe_missing = missing_words(wd, probe);
+                requests += 2;
+                recovered = probe.size() - (probe_missing ? probe_missing->size() : probe.size());
+                if (recovered && probe_end != missing->end()) {
+                    const std::vector<std::string> rest(probe_end, missing->end());
+                    wd.send_words_as_keys(rest.begin(), rest.end(), safe_pause);
+                    std::this_thread::sleep_for(kSettle);
+                    const auto rest_missing = missing_words(wd, rest);
+                    requests += 2;
+                    recovered += rest.size() - (rest_missing ? rest_missing->size() : rest.size());
+                }
+            }
+            last.dropped += recovered;
+            pause_ms = recovered ? std::min(kMaxPauseMs, std::max(2 * pause_ms, 4)) : pause_ms * 3 / 4;
+            check_interval = recovered ? 1 : std::min(kMaxCheckInterval, 2 * check_interval);
+            until_check = check_interval - 1;
+        }
+
+        if (last.feedback) {
+            const auto missing = missing_words(wd, words_upper);
+            ++requests;
+            last.accepted = words_upper.size() - (missing ? missing->size() : 0);
+        }
+        last.pause_ms = pause_ms;
+        last.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return requests;
+    }
+
+    void report(std::ostream& out) const override {
+        if (!last.feedback) {
+            out << "No found-word list on the page; typed " << last.submitted << " words with a "
+                << last.pause_ms << " ms pause.\n";
+            return;
+        }
+        const double rate = last.seconds > 0 ? last.accepted / last.seconds : 0.0;
+        out << "Accepted " << last.accepted << " of " << last.submitted << " words in " << std::fixed
+            << std::setprecision(1) << last.seconds << "s (" << rate << " accepted words/s); pause settled at "
+            << last.pause_ms << " ms, " << last.dropped << " dropped word(s) typed again.\n";
+        out << std::defaultfloat;
+    }
+};
+
+// Strategies --calibrate-submit compares, in the order they are tried.
+static const char* const kSubmitStrategies[] = {
+    "actions", "batched:50", "paced", "element-value", "script", "cdp-keys", "cdp-text",
+};
+
+static bool is_devtools_strategy(std::string_view spec) { return spec == "cdp-keys" || spec == "cdp-text"; }
+
+// The cdp strategies talk to DevTools over a WebSocket, which needs a libcurl built with ws
+// support (7.86 or later, with WebSockets enabled); many distribution builds lack it.
+static bool curl_supports_websockets() {
+    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+    for (const char* const* protocol = info->protocols; protocol && *protocol; ++protocol) {
+        if (std::strcmp(*protocol, "ws") == 0) return true;
+    }
+    return false;
+}
+
+// nullptr for an unknown spec.
+static std::unique_ptr<WordSubmitter> make_word_submitter(const std::string& spec) {
+    if (spec == "actions") return std::make_unique<ActionsSubmitter>();
+    if (spec.rfind("batched:", 0) == 0) {
+        const std::string count = spec.substr(8);
+        if (count.empty() || count.size() > 6 || !std::all_of(count.begin(), count.end(), ::isdigit)) return nullptr;
+        const size_t batch = std::stoul(count);
+        return batch ? std::make_unique<ActionsSubmitter>(batch) : nullptr;
+    }
+    if (spec == "paced" || spec.rfind("paced:", 0) == 0) {
+        const std::string ms = spec.size() > 5 ? spec.substr(6) : "10";
+        if (ms.empty() || ms.size() > 3 || !std::all_of(ms.begin(), ms.end(), ::isdigit)) return nullptr;
+        return std::make_unique<PacedActionsSubmitter>(std::min(std::stoi(ms), PacedActionsSubmitter::kMaxPauseMs));
+    }
+    if (spec == "element-value") return std::make_unique<ElementValueSubmitter>();
+    if (spec == "script") return std::make_unique<ScriptSubmitter>();
+    if (spec == "cdp-keys") return std::make_unique<DevToolsSubmitter>(false);
+    if (spec == "cdp-text") return std::make_unique<DevToolsSubmitter>(true);
+    return nullptr;
+}
+
+// ---------- Workflow scheduler ----------
+// run_attempt is a chain of Task coroutines resumed by a single-threaded Scheduler. Each
+// blocking call (WebDriver round trips, solving) runs as a BackgroundStep on its own worker
+// thread under a StepBudget and resumes its coroutine on the scheduler thread when done.
+// Steps that don't depend on each other are started first and awaited later, so they
+// overlap; human prompts run on the scheduler thread itself.
+template <typename T>
+struct Task;
+
+struct Scheduler {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::coroutine_handle<>> ready;
+
+    void post(std::coroutine_handle<> h) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(h);
+        }
+        cv.notify_one();
+    }
+
+    std::coroutine_handle<> next() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return !ready.empty(); });
+        auto h = ready.front();
+        ready.pop_front();
+        return h;
+    }
+
+    template <typename Fn>
+    auto start(std::chrono::milliseconds limit, Fn fn);
+
+    template <typename T>
+    T run(Task<T>& root);
+};
+
+template <typename T>
+struct Task {
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+        bool done = false;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                h.promise().done = true;
+                auto next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_value(T v) { value = std::move(v); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { if (handle) handle.destroy(); }
+
+    bool done() const { return handle.promise().done; }
+    T result() {
+        if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+        return std::move(*handle.promise().value);
+    }
+
+    bool await_ready() const { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    T await_resume() { return result(); }
+};
+
+template <typename T>
+T Scheduler::run(Task<T>& root) {
+    post(root.handle);
+    while (!root.done()) next().resume();
+    return root.result();
+}
+
+// Runs `fn` on a worker thread as soon as it is constructed; co_await collects the result
+// (or rethrows). The destructor joins, so an un-awaited step never outlives its frame.
+template <typename T>
+struct BackgroundStep {
+    struct State {
+        std::mutex mutex;
+        bool done = false;
+        std::coroutine_handle<> waiter;
+        std::optional<T> value;
+        std::exception_ptr error;
+    };
+
+    std::shared_ptr<State> state = std::make_shared<State>();
+    Scheduler* scheduler = nullptr;
+    std::thread worker;
+
+    template <typename Fn>
+    BackgroundStep(Scheduler& sched, StepBudget budget, Fn fn) : scheduler(&sched) {
+        worker = std::thread([state = state, sched = scheduler, budget, fn = std::move(fn)]() mutable {
+            block_interrupt_signal();
+            t_step_budget = &budget;
+            try {
+                state->value.emplace(fn());
+            } catch (...) {
+                state->error = std::current_exception();
+            }
+            t_step_budget = nullptr;
+            std::coroutine_handle<> waiter;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done = true;
+                waiter = state->waiter;
+            }
+            if (waiter) sched->post(waiter);
+        });
+    }
+    BackgroundStep(BackgroundStep&&) = default;
+    ~BackgroundStep() { if (worker.joinable()) worker.join(); }
+
+    bool await_ready() {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->done;
+    }
+    bool await_suspend(std::coroutine_handle<> h) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->done) return false;
+        state->waiter = h;
+        return true;
+    }
+    T await_resume() {
+        if (worker.joinable()) worker.join();
+        if (state->error) std::rethrow_exception(state->error);
+        return std::move(*state->value);
+    }
+};
+
+template <typename Fn>
+auto Scheduler::start(std::chrono::milliseconds limit, Fn fn) {
+    return BackgroundStep<std::invoke_result_t<Fn>>(*this, StepBudget::after(limit), std::move(fn));
+}
+
+// Per-step deadline (0 means unbounded) and how many transient failures are retried
+// automatically before the step falls back to the pause prompt.
+struct StepPolicy {
+    std::chrono::milliseconds deadline;
+    int retries;
+};
+
+struct StepPolicies {
+    StepPolicy session{60s, 2};
+    StepPolicy navigate{45s, 3};
+    StepPolicy resize{10s, 3};
+    StepPolicy focus{10s, 4};
+    StepPolicy read_letters{20s, 4};
+    std::chrono::milliseconds solve{0};
+    std::chrono::milliseconds ready_slack{5s};   // on top of --ready-timeout, for the last probe
+    StepPolicy send_words{120s, 1};   // a resend retypes every word, so retry it sparingly
+};
+
+// ---------- Pause/Retry Utilities ----------
+enum class StepResult { OK, SKIP, QUIT, CANCELLED };
+
+static std::string prompt_line(const std::string& prompt) {
+    const auto text_start = prompt.find_first_not_of(" \n");
+    TraceSpan span("waiting for input", "human",
+                   {{"prompt", text_start == std::string::npos ? prompt : prompt.substr(text_start)}});
+    g_log.flush();
+    std::cout << prompt << std::flush;
+    std::string s;
+    if (!std::getline(std::cin, s)) {
+        // EOF, or a read interrupted by Ctrl-C; leave the stream usable for the next prompt.
+        std::cin.clear();
+        clearerr(stdin);
+    }
+    return s;
+}
+
+static void pause_banner(const std::string& reason) {
+    g_log.flush();
+    std::cout << "\n=== PAUSED ======================================\n"
+              << reason << "\n"
+              << "Fix the browser if needed, then:\n"
+              << "  [Enter] retry  |  'skip' to skip  |  'quit' to stop workflow\n"
+              << "=================================================\n";
+}
+
+// ---------- Retry policy ----------
+// Transient errors are retried automatically; permanent ones (dead session, bad selector)
+// and anything unrecognised go straight to the pause prompt.
+enum class ErrorClass { Transient, Permanent, Unknown };
+
+struct ClassifiedError {
+    ErrorClass kind = ErrorClass::Unknown;
+    std::string reason;
+};
+
+static ClassifiedError classify_error(const std::exception_ptr& error) {
+    static const char* const kTransientCodes[] = {
+        "stale element reference", "no such element", "element click intercepted",
+        "element not interactable", "timeout", "script timeout",
+    };
+    static const char* const kPermanentCodes[] = {
+        "invalid session id", "session not created", "no such window", "invalid argument",
+        "invalid selector", "unknown command", "unknown method",
+    };
+    try {
+        std::rethrow_exception(error);
+    } catch (const StepInterrupted& e) {
+        return {ErrorClass::Transient, e.what()};
+    } catch (const TransportError& e) {
+        switch (e.code) {
+            case CURLE_COULDNT_CONNECT:
+            case CURLE_SEND_ERROR:
+            case CURLE_RECV_ERROR:
+            case CURLE_GOT_NOTHING:
+            case CURLE_PARTIAL_FILE:
+            case CURLE_OPERATION_TIMEDOUT:
+                return {ErrorClass::Transient, curl_easy_strerror(e.code)};
+            default:
+                return {ErrorClass::Unknown, curl_easy_strerror(e.code)};
+        }
+    } catch (const WebDriverError& e) {
+        for (const char* code : kTransientCodes) {
+            if (e.error == code) return {ErrorClass::Transient, e.error};
+        }
+        for (const char* code : kPermanentCodes) {
+            if (e.error == code) return {ErrorClass::Permanent, e.error};
+        }
+        if (e.status >= 500) {
+            return {ErrorClass::Transient, "HTTP " + std::to_string(e.status) + (e.error.empty() ? "" : " " + e.error)};
+        }
+        return {ErrorClass::Unknown, "HTTP " + std::to_string(e.status)};
+    } catch (...) {
+    }
+    return {};
+}
+
+// Exponential backoff with "equal jitter": half the capped delay is fixed, the other half
+// random, so concurrent retries spread out without ever retrying immediately.
+static std::chrono::milliseconds backoff_delay(int attempt) {
+    constexpr std::chrono::milliseconds kBase{250};
+    constexpr std::chrono::milliseconds kCap{4s};
+    static thread_local std::mt19937 rng{std::random_device{}()};
+    const auto exp = kBase * (1LL << std::min(attempt - 1, 10));
+    const auto capped = std::min<std::chrono::milliseconds>(exp, kCap);
+    std::uniform_int_distribution<long long> jitter(0, capped.count() / 2);
+    return std::chrono::milliseconds(capped.count() - capped.count() / 2 + jitter(rng));
+}
+
+// Sleeps in short slices so Ctrl-C is noticed promptly; false if the run was cancelled.
+static bool sleep_unless_cancelled(std::chrono::milliseconds delay) {
+    const auto until = std::chrono::steady_clock::now() + delay;
+    while (std::chrono::steady_clock::now() < until) {
+        if (g_cancel_requested) return false;
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(50ms, until - std::chrono::steady_clock::now()));
+    }
+    return !g_cancel_requested;
+}
+
+template <typename Fn>
+Task<StepResult> retry_with_pause(Scheduler& sched, const char* what, const StepPolicy& policy, Fn fn) {
+    TraceSpan step_span(what, "step");
+    int auto_retries = 0;
+    int attempts = 0;
+    for (;;) {
+        ++attempts;
+        std::exception_ptr error = co_await sched.start(policy.deadline, [&fn, what, attempts]() -> std::exception_ptr {
+            TraceSpan span(std::string(what) + " attempt " + std::to_string(attempts), "attempt");
+            try {
+                fn();
+                return nullptr;
+            } catch (const std::exception& e) {
+                if (json* args = span.args()) (*args)["error"] = e.what();
+                return std::current_exception();
+            } catch (...) {
+                if (json* args = span.args()) (*args)["error"] = "unknown error";
+                return std::current_exception();
+            }
+        });
+        if (!error) co_return StepResult::OK;
+        if (g_cancel_requested) co_return StepResult::CANCELLED;
+
+        const ClassifiedError failure = classify_error(error);
+        if (failure.kind == ErrorClass::Transient && auto_retries < policy.retries) {
+            ++auto_retries;
+            const auto delay = backoff_delay(auto_retries);
+            log_fields(LogLevel::Warn,
+                       [&] {
+                           return nlohmann::ordered_json{{"step", what}, {"reason", failure.reason},
+                                                         {"retry", auto_retries}, {"retries", policy.retries},
+                                                         {"delay_ms", delay.count()}};
+                       },
+                       what, " failed (transient: ", failure.reason, "); retry ", auto_retries, "/", policy.retries,
+                       " in ", delay.count(), " ms");
+            const bool slept = co_await sched.start(0ms, [delay] {
+                TraceSpan span("backoff", "retry", {{"delay_ms", delay.count()}});
+                return sleep_unless_cancelled(delay);
+            });
+            if (!slept) co_return StepResult::CANCELLED;
+            continue;
+        }
+
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            log_at(LogLevel::Warn, what, " failed: ", e.what());
+        } catch (...) {
+            log_at(LogLevel::Warn, what, " failed with unknown error.");
+        }
+        std::string reason = std::string("Step: ") + what;
+        switch (failure.kind) {
+            case ErrorClass::Transient:
+                reason += " (still failing after " + std::to_string(auto_retries) + " automatic retries)";
+                break;
+            case ErrorClass::Permanent:
+                reason += " (" + failure.reason + ")";
+                break;
+            case ErrorClass::Unknown:
+                break;
+        }
+        pause_banner(reason);
+        auto cmd = prompt_line("> ");
+        if (g_cancel_requested) co_return StepResult::CANCELLED;
+        if (cmd == "quit" || cmd == "q") co_return StepResult::QUIT;
+        if (cmd == "skip" || cmd == "s")  co_return StepResult::SKIP;
+        // else retry, with a fresh automatic budget
+        auto_retries = 0;
+    }
+}
+
+static inline void to_upper_inplace(std::string& s) {
+    for (auto& c : s) c = std::toupper(static_cast<unsigned char>(c));
+}
+
+static inline std::string to_lower_copy(std::string s) {
+    for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+static inline std::string trim_copy(const std::string& s) {
+    const auto not_space = [](unsigned char ch) { return !std::isspace(ch); };
+    auto begin = std::find_if(s.begin(), s.end(), not_space);
+    auto end = std::find_if(s.rbegin(), s.rend(), not_space).base();
+    if (begin >= end) return std::string();
+    return std::string(begin, end);
+}
+
+static bool has_class_token(const std::string& classes_lower, const std::string& token) {
+    std::istringstream iss(classes_lower);
+    std::string part;
+    while (iss >> part) {
+        if (part == token) return true;
+    }
+    return false;
+}
+
+static std::string normalize_letters(const std::string& raw) {
+    std::string result;
+    result.reserve(raw.size());
+    for (char ch : raw) {
+        if (std::isspace(static_cast<unsigned char>(ch))) continue;
+        if (!std::isalpha(static_cast<unsigned char>(ch))) {
+            std::ostringstream oss;
+            oss << "letters may only contain alphabetic characters (got '" << ch << "')";
+            throw std::runtime_error(oss.str());
+        }
+        result.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(ch))));
+    }
+    return result;
+}
+
+struct WordDictionaries {
+    std::set<std::string> short_words;
+    std::set<std::string> medium_words;
+    std::set<std::string> extended_words;
+    std::set<std::string> massive_words;
+};
+
+static const std::set<std::string>& dictionary_tier(const WordDictionaries& dictionaries, const std::string& name) {
+    if (name == "short") return dictionaries.short_words;
+    if (name == "medium") return dictionaries.medium_words;
+    if (name == "extended") return dictionaries.extended_words;
+    if (name == "massive") return dictionaries.massive_words;
+    throw std::runtime_error("unknown dictionary tier '" + name + "' (expected short, medium, extended or massive)");
+}
+
+static void load_word_file(const fs::path& file, std::set<std::string>& out) {
+    std::ifstream in(file);
+    if (!in) {
+        std::ostringstream oss;
+        oss << "failed to open dictionary file: " << file.string();
+        throw std::runtime_error(oss.str());
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        auto trimmed = trim_copy(line);
+        if (trimmed.empty()) continue;
+        out.insert(to_lower_copy(trimmed));
+    }
+}
+
+static WordDictionaries load_word_dictionaries(const fs::path& base_dir) {
+    AllocPhaseScope alloc_phase(AllocPhase::Load);
+    WordDictionaries dictionaries;
+    auto load = [&](const char* name, std::set<std::string>& out) {
+        PhaseTimer timer("dictionary_load", name);
+        load_word_file(base_dir / name, out);
+    };
+    load("wordlist.txt", dictionaries.short_words);
+    load("wiki-100k.txt", dictionaries.medium_words);
+    load("words.txt", dictionaries.extended_words);
+    load("words400k.txt", dictionaries.extended_words);
+    load("wlist_match1.txt", dictionaries.massive_words);
+    return dictionaries;
+}
+
+// ---------- Synthetic dictionaries ----------
+// English-looking words for benchmarks and stress runs: by default lengths 3-14 peaking at
+// 6-7 and letters drawn with English text frequencies. The generator is a seeded xorshift64*
+// so every platform, and the C port, produces the same lists for the same spec.
+static constexpr size_t kMaxSyntheticLength = 32;
+static constexpr uint64_t kSyntheticSeed = 0x5eed5b1e5eed5b1eULL;
+static constexpr const char* kListFiles[] = {"wordlist.txt", "wiki-100k.txt", "words.txt", "words400k.txt",
+                                             "wlist_match1.txt"};
+static constexpr int kListFilePercent[] = {5, 20, 40, 60, 100};   // share of the generated words per file
+
+struct SyntheticSpec {
+    std::array<uint32_t, 26> letter_weights = {82, 15, 28, 43, 127, 22, 20, 61, 70, 2, 8, 40, 24,
+                                               67, 75, 19, 1,  60, 63, 91, 28, 10, 24, 2, 20, 1};
+    std::array<uint32_t, kMaxSyntheticLength + 1> length_weights = {0, 0, 0, 4, 8, 12, 14, 14, 13, 11, 9, 7, 5, 4, 3};
+    uint64_t seed = kSyntheticSeed;
+};
+
+// Applies "key:weight,..." overrides, e.g. "e:150,z:0" for letters or "3:0,15:2" for
+// lengths; entries not named keep their weight.
+static void parse_synthetic_weights(const std::string& spec, bool letters, SyntheticSpec& out) {
+    const char* what = letters ? "--letter-weights" : "--word-lengths";
+    std::istringstream terms(spec);
+    std::string term;
+    while (std::getline(terms, term, ',')) {
+        const auto colon = term.find(':');
+        if (colon == std::string::npos) throw std::runtime_error(std::string(what) + ": expected key:weight, got '" + term + "'");
+        const std::string key = trim_copy(term.substr(0, colon));
+        unsigned long weight = 0;
+        try {
+            size_t used = 0;
+            weight = std::stoul(term.substr(colon + 1), &used);
+            if (colon + 1 + used != term.size()) throw std::invalid_argument(term);
+        } catch (const std::exception&) {
+            throw std::runtime_error(std::string(what) + ": bad weight in '" + term + "'");
+        }
+        if (weight > 1000000) throw std::runtime_error(std::string(what) + ": weight above 1000000 in '" + term + "'");
+        if (letters) {
+            if (key.size() != 1 || !std::isalpha(static_cast<unsigned char>(key[0]))) {
+                throw std::runtime_error("--letter-weights: '" + key + "' is not a letter");
+            }
+            out.letter_weights[std::tolower(static_cast<unsigned char>(key[0])) - 'a'] = static_cast<uint32_t>(weight);
+        } else {
+            size_t length = 0;
+            try {
+                length = std::stoul(key);
+            } catch (const std::exception&) {
+            }
+            if (length < 1 || length > kMaxSyntheticLength) {
+                throw std::runtime_error("--word-lengths: length '" + key + "' is not between 1 and " +
+                                         std::to_string(kMaxSyntheticLength));
+            }
+            out.length_weights[length] = static_cast<uint32_t>(weight);
+        }
+    }
+    auto zero = [](uint32_t w) { return w == 0; };
+    if (letters ? std::all_of(out.letter_weights.begin(), out.letter_weights.end(), zero)
+                : std::all_of(out.length_weights.begin(), out.length_weights.end(), zero)) {
+        throw std::runtime_error(std::string(what) + " leaves every weight at zero");
+    }
+}
+
+// "250000", "1M", "2.5k": word counts with an optional k, M or G multiplier.
+static uint64_t parse_word_count(const std::string& text) {
+    size_t used = 0;
+    double value = 0;
+    try {
+        value = std::stod(text, &used);
+    } catch (const std::exception&) {
+        throw std::runtime_error("bad word count '" + text + "'");
+    }
+    const std::string suffix = text.substr(used);
+    if (suffix == "k" || suffix == "K") value *= 1e3;
+    else if (suffix == "m" || suffix == "M") value *= 1e6;
+    else if (suffix == "g" || suffix == "G") value *= 1e9;
+    else if (!suffix.empty()) throw std::runtime_error("bad word count '" + text + "'");
+    if (!(value >= 1 && value <= 1e10)) throw std::runtime_error("word count '" + text + "' out of range");
+    return static_cast<uint64_t>(value);
+}
+
+struct SyntheticWords {
+    const SyntheticSpec& spec;
+    uint64_t state;
+    uint32_t letter_total = 0;
+    uint32_t length_total = 0;
+    std::string word;
+
+    explicit SyntheticWords(const SyntheticSpec& s) : spec(s), state(s.seed ? s.seed : kSyntheticSeed) {
+        for (uint32_t w : spec.letter_weights) letter_total += w;
+        for (uint32_t w : spec.length_weights) length_total += w;
+    }
+
+    uint64_t next_random() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    template <size_t N>
+    size_t pick(const std::array<uint32_t, N>& weights, uint32_t total) {
+        uint32_t roll = static_cast<uint32_t>((next_random() >> 32) % total);
+        size_t i = 0;
+        while (roll >= weights[i]) roll -= weights[i++];
+        return i;
+    }
+
+    // The next word; the reference stays valid until the following call.
+    const std::string& next() {
+        word.resize(pick(spec.length_weights, length_total));
+        for (char& c : word) c = static_cast<char>('a' + pick(spec.letter_weights, letter_total));
+        return word;
+    }
+};
+
+// Streams `count` words into the five files load_word_dictionaries reads. Word i goes to
+// every file whose share covers it, so each tier is a leading share of the massive list and
+// no more than one word is held in memory. Returns the bytes written.
+static uint64_t write_synthetic_dictionaries(const fs::path& dir, uint64_t count, const SyntheticSpec& spec) {
+    std::array<std::ofstream, std::size(kListFiles)> files;
+    std::array<uint64_t, std::size(kListFiles)> limits{};
+    for (size_t f = 0; f < files.size(); ++f) {
+        files[f].open(dir / kListFiles[f]);
+        if (!files[f]) throw std::runtime_error("failed to write " + (dir / kListFiles[f]).string());
+        limits[f] = count * kListFilePercent[f] / 100;
+    }
+    SyntheticWords words(spec);
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        const std::string& word = words.next();
+        for (size_t f = 0; f < files.size(); ++f) {
+            if (i >= limits[f]) continue;
+            files[f].write(word.data(), static_cast<std::streamsize>(word.size())).put('\n');
+            bytes += word.size() + 1;
+        }
+    }
+    for (size_t f = 0; f < files.size(); ++f) {
+        files[f].close();
+        if (!files[f]) throw std::runtime_error("failed to write " + (dir / kListFiles[f]).string());
+    }
+    return bytes;
+}
+
+// A fresh directory under the system temp dir, removed with everything in it on scope exit.
+struct ScratchDir {
+    fs::path path;
+
+    explicit ScratchDir(const std::string& prefix)
+        : path(fs::temp_directory_path() /
+               (prefix + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()))) {
+        fs::create_directories(path);
+    }
+    ScratchDir(const ScratchDir&) = delete;
+    ScratchDir& operator=(const ScratchDir&) = delete;
+    ~ScratchDir() {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+};
+
+
+// ---------- Word index ----------
+// Every word is reduced once at load time to a 26-bit letter mask plus its length so the
+// solver, scorer and hint builders never have to walk the characters again.
+static constexpr uint32_t kNonLetterBit = 1u << 26;
+
+static constexpr uint32_t letter_bit(char lower) {
+    return 1u << static_cast<unsigned>(lower - 'a');
+}
+
+static constexpr uint32_t kVowelMask = letter_bit('a') | letter_bit('e') | letter_bit('i') |
+                                       letter_bit('o') | letter_bit('u') | letter_bit('y');
+
+static uint32_t letter_mask(const std::string& word) {
+    uint32_t mask = 0;
+    for (char c : word) {
+        char lower = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        mask |= (lower >= 'a' && lower <= 'z') ? letter_bit(lower) : kNonLetterBit;
+    }
+    return mask;
+}
+
+struct WordIndex {
+    std::vector<std::string> words;   // lowercase, in dictionary order
+    std::vector<uint32_t> masks;
+    std::vector<uint32_t> lengths;
+
+    size_t size() const { return words.size(); }
+    const std::string& word(uint32_t id) const { return words[id]; }
+    uint32_t mask(uint32_t id) const { return masks[id]; }
+    uint32_t length(uint32_t id) const { return lengths[id]; }
+
+    void push_back(const std::string& word) {
+        words.push_back(word);
+        masks.push_back(letter_mask(word));
+        lengths.push_back(static_cast<uint32_t>(word.size()));
+    }
+};
+
+static WordIndex build_word_index(const std::set<std::string>& dictionary) {
+    PhaseTimer timer("index_build");
+    AllocPhaseScope alloc_phase(AllocPhase::Load);
+    WordIndex index;
+    index.words.reserve(dictionary.size());
+    index.masks.reserve(dictionary.size());
+    index.lengths.reserve(dictionary.size());
+    for (const auto& word : dictionary) index.push_back(word);
+    return index;
+}
+
+// The solver's index: a base plus the changes of the delta segments, merged at query time.
+// Ids below base->size() are base words and the rest index `added`; removed base words
+// (tombstones) are skipped. Snapshots share the base, so applying segments costs time in
+// proportion to the changes rather than to the word lists.
+struct LayeredWordIndex {
+    std::shared_ptr<const WordIndex> base;
+    WordIndex added;                 // sorted, none of them in the base
+    std::vector<uint32_t> removed;   // ascending base ids
+
+    size_t changes() const { return added.size() + removed.size(); }
+    const std::string& word(uint32_t id) const {
+        return id < base->size() ? base->words[id] : added.words[id - base->size()];
+    }
+    uint32_t mask(uint32_t id) const { return id < base->size() ? base->masks[id] : added.masks[id - base->size()]; }
+    uint32_t length(uint32_t id) const {
+        return id < base->size() ? base->lengths[id] : added.lengths[id - base->size()];
+    }
+};
+
+// Maps each word a delta segment touches to whether it ends up in the list.
+using WordChanges = std::map<std::string, bool>;
+
+// The changes `layered` makes to its base: its added words and its tombstones.
+static WordChanges layered_word_changes(const LayeredWordIndex& layered) {
+    WordChanges changes;
+    for (const auto& word : layered.added.words) changes.emplace(word, true);
+    for (uint32_t id : layered.removed) changes.emplace(layered.base->words[id], false);
+    return changes;
+}
+
+static LayeredWordIndex layer_word_changes(std::shared_ptr<const WordIndex> base, const WordChanges& changes) {
+    LayeredWordIndex layered;
+    for (const auto& [word, present] : changes) {
+        const auto it = std::lower_bound(base->words.begin(), base->words.end(), word);
+        const bool in_base = it != base->words.end() && *it == word;
+        if (present && !in_base) {
+            layered.added.push_back(word);
+        } else if (!present && in_base) {
+            // Ascending, since `changes` and the base are both in word order.
+            layered.removed.push_back(static_cast<uint32_t>(it - base->words.begin()));
+        }
+    }
+    layered.base = std::move(base);
+    return layered;
+}
+
+// Folds the changes into a new base with nothing layered on it. Base and added words are
+// both sorted, so this is a single merge pass.
+static LayeredWordIndex compact_word_index(const LayeredWordIndex& index) {
+    if (index.changes() == 0) return index;
+    PhaseTimer timer("index_compact");
+    AllocPhaseScope alloc_phase(AllocPhase::Load);
+    const WordIndex& base = *index.base;
+    auto merged = std::make_shared<WordIndex>();
+    const size_t total = base.size() + index.added.size() - index.removed.size();
+    merged->words.reserve(total);
+    merged->masks.reserve(total);
+    merged->lengths.reserve(total);
+    auto removed = index.removed.begin();
+    size_t b = 0;
+    size_t a = 0;
+    while (b < base.size() || a < index.added.size()) {
+        if (b < base.size() && removed != index.removed.end() && *removed == b) {
+            ++removed;
+            ++b;
+        } else if (a == index.added.size() || (b < base.size() && base.words[b] < index.added.words[a])) {
+            merged->words.push_back(base.words[b]);
+            merged->masks.push_back(base.masks[b]);
+            merged->lengths.push_back(base.lengths[b]);
+            ++b;
+        } else {
+            merged->words.push_back(index.added.words[a]);
+            merged->masks.push_back(index.added.masks[a]);
+            merged->lengths.push_back(index.added.lengths[a]);
+            ++a;
+        }
+    }
+    LayeredWordIndex compacted;
+    compacted.base = std::move(merged);
+    return compacted;
+}
+
+struct HiveFilter {
+    uint32_t allowed = 0;
+    uint32_t required = 0;
+
+    bool accepts(uint32_t mask, uint32_t length) const {
+        return length >= 4 && !(mask & ~allowed) && (mask & required) && (mask & kVowelMask);
+    }
+};
+
+static HiveFilter make_hive_filter(const std::string& letters) {
+    if (letters.size() < 1) {
+        throw std::runtime_error("letters input is empty");
+    }
+    return HiveFilter{letter_mask(letters), letter_mask(std::string(1, letters.back()))};
+}
+
+static std::vector<uint32_t> find_valid_words(const WordIndex& index, const std::string& letters) {
+    const HiveFilter filter = make_hive_filter(letters);
+    std::vector<uint32_t> results;
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (filter.accepts(index.masks[i], index.lengths[i])) {
+            results.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    return results;
+}
+
+// Only base words the filter accepts are looked up in `removed`, so the base scan costs
+// what it does without layers.
+static std::vector<uint32_t> find_valid_words(const LayeredWordIndex& index, const std::string& letters) {
+    const HiveFilter filter = make_hive_filter(letters);
+    const WordIndex& base = *index.base;
+    std::vector<uint32_t> results;
+    auto removed = index.removed.begin();
+    for (size_t i = 0; i < base.size(); ++i) {
+        if (!filter.accepts(base.masks[i], base.lengths[i])) continue;
+        removed = std::lower_bound(removed, index.removed.end(), static_cast<uint32_t>(i));
+        if (removed != index.removed.end() && *removed == i) continue;
+        results.push_back(static_cast<uint32_t>(i));
+    }
+    const auto first_added = static_cast<uint32_t>(base.size());
+    for (size_t i = 0; i < index.added.size(); ++i) {
+        if (filter.accepts(index.added.masks[i], index.added.lengths[i])) {
+            results.push_back(first_added + static_cast<uint32_t>(i));
+        }
+    }
+    return results;
+}
+
+// ---------- Scoring ----------
+static constexpr uint32_t kPangramBonus = 7;
+
+static uint32_t word_points(uint32_t length, bool pangram) {
+    uint32_t points = length == 4 ? 1 : length;
+    return pangram ? points + kPangramBonus : points;
+}
+
+struct ScoreSummary {
+    uint32_t max_score = 0;
+    std::vector<uint32_t> pangram_ids;   // indices into the WordIndex
+};
+
+// Candidates are already known to use only hive letters, so a pangram is simply a word
+// whose mask covers the whole hive.
+template <typename Index>
+static ScoreSummary score_candidates(const Index& index,
+                                     const std::vector<uint32_t>& ids,
+                                     uint32_t hive_mask) {
+    ScoreSummary summary;
+    for (uint32_t id : ids) {
+        const bool pangram = index.mask(id) == hive_mask;
+        summary.max_score += word_points(index.length(id), pangram);
+        if (pangram) summary.pangram_ids.push_back(id);
+    }
+    return summary;
+}
+
+struct HiveSolution {
+    std::string letters;             // outer six then center, lowercase
+    uint32_t hive_mask = 0;
+    std::vector<uint32_t> word_ids;  // indices into the WordIndex, dictionary order (added words last)
+    ScoreSummary score;
+};
+
+template <typename Index>
+static HiveSolution solve_hive(const Index& index, const std::string& letters) {
+    PhaseTimer timer("solve");
+    AllocPhaseScope alloc_phase(AllocPhase::Solve);
+    HiveSolution solution;
+    solution.letters = letters;
+    solution.hive_mask = letter_mask(letters);
+    solution.word_ids = find_valid_words(index, letters);
+    solution.score = score_candidates(index, solution.word_ids, solution.hive_mask);
+    return solution;
+}
+
+// ---------- Word queries ----------
+// A query combines optional prefix, suffix, length bounds, a wildcard pattern ('?', '.' or
+// '_' match any single character) and the hive-letter constraint. Specs use the form
+// "prefix=ta,suffix=ing,len=6,pattern=a?e??,letters=abcdefg" so the same parser can serve
+// any front end, not just the command line.
+struct WordQuery {
+    std::string prefix;
+    std::string suffix;
+    std::string pattern;
+    std::string letters;          // empty = no hive constraint
+    uint32_t min_length = 0;
+    uint32_t max_length = UINT32_MAX;
+    std::string tier = "massive";
+    size_t limit = 0;             // 0 = unlimited
+};
+
+static bool is_wildcard(char c) { return c == '?' || c == '.' || c == '_'; }
+
+static uint32_t parse_query_number(const std::string& key, const std::string& value) {
+    if (value.empty() || !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        throw std::runtime_error("query " + key + " must be a non-negative integer (got '" + value + "')");
+    }
+    return static_cast<uint32_t>(std::stoul(value));
+}
+
+static WordQuery parse_query_spec(const std::string& spec) {
+    WordQuery query;
+    std::istringstream iss(spec);
+    std::string term;
+    while (std::getline(iss, term, ',')) {
+        term = trim_copy(term);
+        if (term.empty()) continue;
+        const auto eq = term.find('=');
+        if (eq == std::string::npos) {
+            throw std::runtime_error("query term '" + term + "' is not key=value");
+        }
+        const std::string key = to_lower_copy(trim_copy(term.substr(0, eq)));
+        const std::string value = to_lower_copy(trim_copy(term.substr(eq + 1)));
+        if (key == "prefix") query.prefix = value;
+        else if (key == "suffix") query.suffix = value;
+        else if (key == "pattern") query.pattern = value;
+        else if (key == "letters") query.letters = normalize_letters(value);
+        else if (key == "tier") query.tier = value;
+        else if (key == "len" || key == "length") query.min_length = query.max_length = parse_query_number(key, value);
+        else if (key == "min") query.min_length = parse_query_number(key, value);
+        else if (key == "max") query.max_length = parse_query_number(key, value);
+        else if (key == "limit") query.limit = parse_query_number(key, value);
+        else throw std::runtime_error("unknown query key '" + key + "'");
+    }
+    if (!query.letters.empty() && query.letters.size() != 7) {
+        throw std::runtime_error("query letters must contain exactly 7 alphabetic characters");
+    }
+    return query;
+}
+
+static bool matches_pattern(const std::string& word, const std::string& pattern) {
+    if (word.size() != pattern.size()) return false;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        if (!is_wildcard(pattern[i]) && pattern[i] != word[i]) return false;
+    }
+    return true;
+}
+
+static bool ends_with(const std::string& word, const std::string& suffix) {
+    return word.size() >= suffix.size() &&
+           word.compare(word.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static bool reversed_less(const std::string& a, const std::string& b) {
+    return std::lexicographical_compare(a.rbegin(), a.rend(), b.rbegin(), b.rend());
+}
+
+// Answers queries over one WordIndex. The index is already sorted, so prefixes (including
+// the literal head of a pattern) resolve to a contiguous range by binary search; suffixes
+// use a second id ordering sorted by reversed spelling, built the first time it is needed.
+struct WordQueryEngine {
+    const WordIndex* index = nullptr;
+    std::vector<uint32_t> suffix_order;
+
+    explicit WordQueryEngine(const WordIndex& idx) : index(&idx) {}
+
+    std::pair<uint32_t, uint32_t> prefix_range(const std::string& prefix) const {
+        const auto& words = index->words;
+        auto lo = std::lower_bound(words.begin(), words.end(), prefix);
+        auto hi = std::partition_point(lo, words.end(), [&](const std::string& w) {
+            return w.compare(0, prefix.size(), prefix) == 0;
+        });
+        return {static_cast<uint32_t>(lo - words.begin()), static_cast<uint32_t>(hi - words.begin())};
+    }
+
+    const std::vector<uint32_t>& suffix_ids() {
+        if (suffix_order.size() != index->size()) {
+            suffix_order.resize(index->size());
+            for (uint32_t i = 0; i < suffix_order.size(); ++i) suffix_order[i] = i;
+            std::sort(suffix_order.begin(), suffix_order.end(), [&](uint32_t a, uint32_t b) {
+                return reversed_less(index->words[a], index->words[b]);
+            });
+        }
+        return suffix_order;
+    }
+
+    std::vector<uint32_t> run(const WordQuery& query) {
+        // The pattern's literal head is an implicit prefix; pick the longer of the two.
+        std::string prefix = query.prefix;
+        if (!query.pattern.empty()) {
+            size_t head = 0;
+            while (head < query.pattern.size() && !is_wildcard(query.pattern[head])) ++head;
+            if (head > prefix.size()) prefix = query.pattern.substr(0, head);
+        }
+        uint32_t min_length = query.min_length;
+        uint32_t max_length = query.max_length;
+        if (!query.pattern.empty()) {
+            min_length = std::max(min_length, static_cast<uint32_t>(query.pattern.size()));
+            max_length = std::min(max_length, static_cast<uint32_t>(query.pattern.size()));
+        }
+        std::optional<HiveFilter> hive;
+        if (!query.letters.empty()) hive = make_hive_filter(query.letters);
+
+        auto accept = [&](uint32_t id) {
+            const uint32_t length = index->lengths[id];
+            if (length < min_length || length > max_length) return false;
+            if (hive && !hive->accepts(index->masks[id], length)) return false;
+            const auto& word = index->words[id];
+            if (!query.prefix.empty() && word.compare(0, query.prefix.size(), query.prefix) != 0) return false;
+            if (!query.suffix.empty() && !ends_with(word, query.suffix)) return false;
+            if (!query.pattern.empty() && !matches_pattern(word, query.pattern)) return false;
+            return true;
+        };
+
+        std::vector<uint32_t> results;
+        if (!query.suffix.empty() && query.suffix.size() > prefix.size()) {
+            const auto& order = suffix_ids();
+            auto lo = std::lower_bound(order.begin(), order.end(), query.suffix, [&](uint32_t id, const std::string& sfx) {
+                return reversed_less(index->words[id], sfx);
+            });
+            for (auto it = lo; it != order.end() && ends_with(index->words[*it], query.suffix); ++it) {
+                if (accept(*it)) results.push_back(*it);
+            }
+            std::sort(results.begin(), results.end());
+        } else {
+            const auto [lo, hi] = prefix_range(prefix);
+            for (uint32_t id = lo; id < hi; ++id) {
+                if (accept(id)) results.push_back(id);
+            }
+        }
+        if (query.limit > 0 && results.size() > query.limit) results.resize(query.limit);
+        return results;
+    }
+};
+
+// ---------- Hints ----------
+struct HintGrid {
+    std::string letters;
+    uint32_t word_count = 0;
+    uint32_t points = 0;
+    uint32_t pangram_count = 0;
+    uint32_t perfect_pangram_count = 0;
+    uint32_t max_length = 0;
+    std::array<std::vector<uint32_t>, 26> by_first_and_length;   // [first letter][length]
+    std::array<uint32_t, 26 * 26> two_letter_starts{};
+};
+
+// One pass over the solved ids; only the first two characters of each word are read.
+static HintGrid build_hint_grid(const WordIndex& index, const HiveSolution& solution) {
+    HintGrid grid;
+    grid.letters = solution.letters;
+    grid.word_count = static_cast<uint32_t>(solution.word_ids.size());
+    grid.points = solution.score.max_score;
+    grid.pangram_count = static_cast<uint32_t>(solution.score.pangram_ids.size());
+    for (uint32_t id : solution.word_ids) {
+        const auto& word = index.words[id];
+        const uint32_t length = index.lengths[id];
+        const int first = word[0] - 'a';
+        const int second = word[1] - 'a';
+        auto& row = grid.by_first_and_length[first];
+        if (row.size() <= length) row.resize(length + 1, 0);
+        ++row[length];
+        ++grid.two_letter_starts[first * 26 + second];
+        grid.max_length = std::max(grid.max_length, length);
+        if (length == 7 && index.masks[id] == solution.hive_mask) ++grid.perfect_pangram_count;
+    }
+    return grid;
+}
+
+static uint32_t hint_cell(const HintGrid& grid, int first, uint32_t length) {
+    const auto& row = grid.by_first_and_length[first];
+    return length < row.size() ? row[length] : 0;
+}
+
+static void print_hint_table(const HintGrid& grid, std::ostream& out) {
+    std::string letters_upper = grid.letters;
+    to_upper_inplace(letters_upper);
+    out << "Letters: " << letters_upper.substr(0, 6) << " (center " << letters_upper.back() << ")\n"
+        << "WORDS: " << grid.word_count << ", POINTS: " << grid.points
+        << ", PANGRAMS: " << grid.pangram_count;
+    if (grid.perfect_pangram_count > 0) out << " (" << grid.perfect_pangram_count << " Perfect)";
+    out << "\n\n";
+    if (grid.word_count == 0) return;
+
+    std::vector<uint32_t> column_totals(grid.max_length + 1, 0);
+    out << "   ";
+    for (uint32_t len = 4; len <= grid.max_length; ++len) out << std::setw(4) << len;
+    out << "  Sum\n";
+    for (int first = 0; first < 26; ++first) {
+        if (grid.by_first_and_length[first].empty()) continue;
+        uint32_t row_total = 0;
+        out << static_cast<char>('A' + first) << ": ";
+        for (uint32_t len = 4; len <= grid.max_length; ++len) {
+            const uint32_t n = hint_cell(grid, first, len);
+            row_total += n;
+            column_totals[len] += n;
+            if (n == 0) out << "   -";
+            else out << std::setw(4) << n;
+        }
+        out << std::setw(5) << row_total << "\n";
+    }
+    out << "Sum";
+    for (uint32_t len = 4; len <= grid.max_length; ++len) out << std::setw(4) << column_totals[len];
+    out << std::setw(5) << grid.word_count << "\n\nTwo letter list:\n";
+    for (int first = 0; first < 26; ++first) {
+        bool any = false;
+        for (int second = 0; second < 26; ++second) {
+            const uint32_t n = grid.two_letter_starts[first * 26 + second];
+            if (n == 0) continue;
+            out << (any ? " " : "") << static_cast<char>('A' + first) << static_cast<char>('A' + second)
+                << '-' << n;
+            any = true;
+        }
+        if (any) out << "\n";
+    }
+}
+
+static json hint_grid_json(const HintGrid& grid) {
+    json by_letter = json::object();
+    for (int first = 0; first < 26; ++first) {
+        const auto& row = grid.by_first_and_length[first];
+        if (row.empty()) continue;
+        json lengths = json::object();
+        for (uint32_t len = 4; len < row.size(); ++len) {
+            if (row[len] > 0) lengths[std::to_string(len)] = row[len];
+        }
+        by_letter[std::string(1, static_cast<char>('a' + first))] = std::move(lengths);
+    }
+    json two_letter = json::object();
+    for (int i = 0; i < 26 * 26; ++i) {
+        if (grid.two_letter_starts[i] == 0) continue;
+        std::string key = {static_cast<char>('a' + i / 26), static_cast<char>('a' + i % 26)};
+        two_letter[key] = grid.two_letter_starts[i];
+    }
+    return json{{"letters", grid.letters},
+                {"center", std::string(1, grid.letters.back())},
+                {"words", grid.word_count},
+                {"points", grid.points},
+                {"pangrams", grid.pangram_count},
+                {"perfect_pangrams", grid.perfect_pangram_count},
+                {"grid", std::move(by_letter)},
+                {"two_letter", std::move(two_letter)}};
+}
+
+// ---------- Membership ----------
+enum TierBit : uint8_t {
+    kTierShort = 1 << 0,
+    kTierMedium = 1 << 1,
+    kTierExtended = 1 << 2,
+    kTierMassive = 1 << 3,
+    kHiveLegal = 1 << 4,
+};
+
+static uint64_t hash_word(std::string_view word) {
+    uint64_t h = 14695981039346656037ull;   // FNV-1a
+    for (char c : word) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Flat open-addressing table (linear probing, load factor <= 0.5) mapping every word of
+// every tier to the bitmask of tiers containing it. Keys are views into the source sets,
+// so the table must not outlive the WordDictionaries it was built from.
+struct MembershipTable {
+    struct Slot {
+        uint64_t hash = 0;
+        std::string_view word;
+        uint8_t tiers = 0;   // 0 marks an empty slot
+    };
+    std::vector<Slot> slots;
+    size_t slot_mask = 0;
+    size_t count = 0;
+
+    explicit MembershipTable(const WordDictionaries& dictionaries) {
+        const size_t total = dictionaries.short_words.size() + dictionaries.medium_words.size() +
+                             dictionaries.extended_words.size() + dictionaries.massive_words.size();
+        size_t capacity = 16;
+        while (capacity < total * 2) capacity <<= 1;
+        slots.resize(capacity);
+        slot_mask = capacity - 1;
+        add_tier(dictionaries.short_words, kTierShort);
+        add_tier(dictionaries.medium_words, kTierMedium);
+        add_tier(dictionaries.extended_words, kTierExtended);
+        add_tier(dictionaries.massive_words, kTierMassive);
+    }
+
+    void add_tier(const std::set<std::string>& words, uint8_t tier) {
+        for (const auto& word : words) {
+            const uint64_t h = hash_word(word);
+            for (size_t i = h & slot_mask;; i = (i + 1) & slot_mask) {
+                Slot& slot = slots[i];
+                if (slot.tiers == 0) {
+                    slot = Slot{h, word, tier};
+                    ++count;
+                    break;
+                }
+                if (slot.hash == h && slot.word == word) {
+                    slot.tiers |= tier;
+                    break;
+                }
+            }
+        }
+    }
+
+    uint8_t probe(uint64_t h, std::string_view word) const {
+        for (size_t i = h & slot_mask;; i = (i + 1) & slot_mask) {
+            const Slot& slot = slots[i];
+            if (slot.tiers == 0) return 0;
+            if (slot.hash == h && slot.word == word) return slot.tiers;
+        }
+    }
+
+    uint8_t lookup(std::string_view word) const { return probe(hash_word(word), word); }
+
+    // Batch lookup: hashes a block of words and prefetches their home slots before probing,
+    // so the cache misses of a block overlap instead of being paid one at a time. Words are
+    // expected lowercase; kHiveLegal is set when `hive` is given and the word passes it.
+    std::vector<uint8_t> lookup_batch(const std::vector<std::string>& words,
+                                      const std::optional<HiveFilter>& hive = std::nullopt) const {
+        constexpr size_t kBlock = 16;
+        std::vector<uint8_t> out(words.size(), 0);
+        std::array<uint64_t, kBlock> hashes{};
+        for (size_t base = 0; base < words.size(); base += kBlock) {
+            const size_t n = std::min(kBlock, words.size() - base);
+            for (size_t j = 0; j < n; ++j) {
+                hashes[j] = hash_word(words[base + j]);
+                __builtin_prefetch(&slots[hashes[j] & slot_mask]);
+            }
+            for (size_t j = 0; j < n; ++j) {
+                const auto& word = words[base + j];
+                uint8_t bits = probe(hashes[j], word);
+                if (hive && hive->accepts(letter_mask(word), static_cast<uint32_t>(word.size()))) bits |= kHiveLegal;
+                out[base + j] = bits;
+            }
+        }
+        return out;
+    }
+};
+
+static std::string describe_tiers(uint8_t bits) {
+    static const std::array<std::pair<uint8_t, const char*>, 5> kNames = {{
+        {kTierShort, "short"}, {kTierMedium, "medium"}, {kTierExtended, "extended"},
+        {kTierMassive, "massive"}, {kHiveLegal, "hive"}}};
+    std::string out;
+    for (const auto& [bit, name] : kNames) {
+        if (!(bits & bit)) continue;
+        if (!out.empty()) out += ',';
+        out += name;
+    }
+    return out.empty() ? "-" : out;
+}
+
+static fs::path find_default_dictionary_dir() {
+    const std::array<fs::path, 3> candidates = {
+        fs::path("WordListerApp/target/classes/com/uestechnology"),
+        fs::path("WordListerApp/src/main/resources/com/uestechnology"),
+        fs::path("WordListerApp/extracted/com/uestechnology")
+    };
+    for (const auto& candidate : candidates) {
+        if (fs::exists(candidate) && fs::is_directory(candidate)) {
+            return candidate;
+        }
+    }
+    return {};
+}
+
+using HiveCellInfo = std::tuple<char, bool, std::string, std::string>;
+
+static void dump_cell_debug(const std::vector<HiveCellInfo>& cells) {
+    if (!g_log.enabled(LogLevel::Debug)) return;
+    for (size_t idx = 0; idx < cells.size(); ++idx) {
+        const auto& [letter, is_center, classes, aria] = cells[idx];
+        log_fields(LogLevel::Debug,
+                   [&] {
+                       return nlohmann::ordered_json{{"cell", idx + 1}, {"letter", std::string(1, letter)},
+                                                     {"center", is_center}, {"classes", classes}, {"aria", aria}};
+                   },
+                   "Hive cell #", idx + 1, ": letter='", letter, "' center=", is_center ? "true" : "false",
+                   " classes='", classes, "' aria='", aria, "'");
+    }
+}
+
+static HiveCellInfo make_hive_cell(int idx, const std::string& raw_text, std::string classes, std::string aria) {
+    auto text = trim_copy(raw_text);
+    if (text.empty()) {
+        std::ostringstream oss;
+        oss << "no letter found for hive cell " << idx;
+        throw std::runtime_error(oss.str());
+    }
+    char letter = text.front();
+    if (!std::isalpha(static_cast<unsigned char>(letter))) {
+        std::ostringstream oss;
+        oss << "unexpected hive character '" << letter << "' at cell " << idx;
+        throw std::runtime_error(oss.str());
+    }
+    char normalized = static_cast<char>(std::tolower(static_cast<unsigned char>(letter)));
+    classes = to_lower_copy(std::move(classes));
+    aria = to_lower_copy(std::move(aria));
+
+    bool is_center = false;
+    if (!classes.empty()) {
+        if (has_class_token(classes, "hive-cell--center") ||
+            has_class_token(classes, "hive-cell_center") ||
+            has_class_token(classes, "is-center") ||
+            (has_class_token(classes, "center") && !has_class_token(classes, "outer"))) {
+            is_center = true;
+        }
+    }
+    if (!is_center && !aria.empty()) {
+        if (aria.find("center letter") != std::string::npos || aria == "center") {
+            is_center = true;
+        }
+    }
+    return HiveCellInfo(normalized, is_center, std::move(classes), std::move(aria));
+}
+
+static std::string letters_from_hive_cells(std::vector<HiveCellInfo>& cells) {
+    if (cells.size() != 7) {
+        std::ostringstream oss;
+        oss << "expected 7 hive cells but collected " << cells.size();
+        throw std::runtime_error(oss.str());
+    }
+
+    std::size_t center_count = 0;
+    for (const auto& cell : cells) {
+        if (std::get<1>(cell)) ++center_count;
+    }
+    if (center_count == 0) {
+        log_at(LogLevel::Warn, "No center marker found in hive; falling back to nth-child(4)");
+        dump_cell_debug(cells);
+        std::get<1>(cells.at(3)) = true;
+        center_count = 1;
+    }
+    if (center_count > 1) {
+        dump_cell_debug(cells);
+        throw std::runtime_error("multiple hive cells reported as center");
+    }
+
+    char center_letter = '\0';
+    std::string letters;
+    letters.reserve(7);
+    for (const auto& cell : cells) {
+        char c = std::get<0>(cell);
+        if (std::get<1>(cell)) {
+            if (center_letter != '\0' && center_letter != c) {
+                dump_cell_debug(cells);
+                std::ostringstream oss;
+                oss << "multiple differing center letters detected (" << center_letter << " vs " << c << ")";
+                throw std::runtime_error(oss.str());
+            }
+            center_letter = c;
+        } else {
+            letters.push_back(c);
+        }
+    }
+    if (center_letter == '\0') {
+        dump_cell_debug(cells);
+        throw std::runtime_error("could not determine center hive letter after processing");
+    }
+    if (letters.size() != 6) {
+        dump_cell_debug(cells);
+        std::ostringstream oss;
+        oss << "expected 6 outer hive letters but collected " << letters.size();
+        throw std::runtime_error(oss.str());
+    }
+    letters.push_back(center_letter);
+    return letters;
+}
+
+static std::string hive_cell_selector(int idx) {
+    std::ostringstream css;
+    css << ".hive-cell:nth-child(" << idx << ")";
+    return css.str();
+}
+
+// 21 sequential round trips: find, text, class and aria-label for each of the 7 cells.
+static std::string read_letters_from_board(WD& wd) {
+    std::vector<HiveCellInfo> cells;
+    cells.reserve(7);
+    for (int idx = 1; idx <= 7; ++idx) {
+        const auto cell_id = wd.find_element_id_css(hive_cell_selector(idx));
+        auto text = wd.get_element_text(cell_id);
+        auto classes = wd.get_element_attribute(cell_id, "class");
+        auto aria = wd.get_element_attribute(cell_id, "aria-label");
+        cells.push_back(make_hive_cell(idx, text, std::move(classes), std::move(aria)));
+    }
+    return letters_from_hive_cells(cells);
+}
+
+// Same reads in two waves: all 7 element lookups in flight together, then all 21
+// text/attribute fetches together.
+static std::string read_letters_from_board(AsyncWD& wd) {
+    std::vector<std::future<std::string>> ids;
+    for (int idx = 1; idx <= 7; ++idx) ids.push_back(wd.find_element_id_css(hive_cell_selector(idx)));
+    std::vector<std::array<std::future<std::string>, 3>> fetches;
+    for (auto& id_future : ids) {
+        const auto cell_id = id_future.get();
+        fetches.push_back({wd.get_element_text(cell_id),
+                           wd.get_element_attribute(cell_id, "class"),
+                           wd.get_element_attribute(cell_id, "aria-label")});
+    }
+    std::vector<HiveCellInfo> cells;
+    cells.reserve(7);
+    for (int idx = 1; idx <= 7; ++idx) {
+        auto& f = fetches[idx - 1];
+        auto text = f[0].get();
+        cells.push_back(make_hive_cell(idx, text, f[1].get(), f[2].get()));
+    }
+    return letters_from_hive_cells(cells);
+}
+
+// ---------- Page readiness ----------
+// One execute/sync round-trip per poll: click away the overlays the puzzle page is known
+// to show (splash "Play", welcome/stats modals, consent banners), then report whether all
+// seven hive cells carry a letter and nothing still covers the board.
+static constexpr const char* kReadinessProbeScript = R"JS(
+const visible = el => !!(el && el.getClientRects().length);
+const dismissSelectors = ['.pz-moment__button.primary', '.sb-modal-close', '.pz-modal__close',
+                          '.fides-accept-all-button', '.purr-blocker-card__button'];
+const dismissed = [];
+for (const sel of dismissSelectors) {
+  const el = document.querySelector(sel);
+  if (visible(el)) { el.click(); dismissed.push(sel); }
+}
+const cells = Array.from(document.querySelectorAll('.hive-cell'));
+const lettered = cells.filter(c => /^[A-Za-z]$/.test((c.textContent || '').trim())).length;
+const modal = Array.from(document.querySelectorAll('.sb-modal-wrapper, .pz-moment, .pz-modal, #fides-banner'))
+  .some(visible);
+return {cells: cells.length, lettered: lettered, modal: modal, dismissed: dismissed.join(' ')};
+)JS";
+
+struct ReadinessProbe {
+    int lettered_cells = 0;
+    bool modal_open = false;
+    std::string dismissed;   // space-separated selectors clicked this round
+
+    // Something dismissed this round may have uncovered another overlay; poll once more.
+    bool ready() const { return lettered_cells >= 7 && !modal_open && dismissed.empty(); }
+};
+
+static ReadinessProbe probe_board_readiness(WD& wd) {
+    const json v = wd.execute_script(kReadinessProbeScript);
+    ReadinessProbe probe;
+    probe.lettered_cells = v.value("lettered", 0);
+    probe.modal_open = v.value("modal", false);
+    probe.dismissed = v.value("dismissed", std::string());
+    return probe;
+}
+
+// Polls until the board is ready or `timeout` passes. Probe failures (page mid-load,
+// script errors) just count as "not ready yet". False on timeout or Ctrl-C.
+static bool wait_for_board_ready(WD& wd, std::chrono::milliseconds timeout) {
+    const auto start = std::chrono::steady_clock::now();
+    std::string dismissed;
+    while (!g_cancel_requested) {
+        try {
+            auto probe = probe_board_readiness(wd);
+            if (probe.ready()) {
+                const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+                std::cout << "Board ready after " << waited.count() << " ms";
+                if (!dismissed.empty()) std::cout << " (dismissed: " << dismissed << ")";
+                std::cout << ".\n";
+                return true;
+            }
+            if (!probe.dismissed.empty()) dismissed += (dismissed.empty() ? "" : " ") + probe.dismissed;
+        } catch (const StepInterrupted&) {
+            return false;
+        } catch (const std::exception&) {
+        }
+        if (std::chrono::steady_clock::now() - start >= timeout) return false;
+        std::this_thread::sleep_for(250ms);
+    }
+    return false;
+}
+
+// ---------- Session persistence ----------
+// A session kept open at exit (detach: true leaves Chrome running) is recorded so the next
+// run can reattach instead of paying for Chrome startup, navigation and resizing again.
+static fs::path default_state_dir() {
+    if (const char* state = std::getenv("XDG_STATE_HOME"); state && *state) {
+        return fs::path(state) / "spellingbee";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return fs::path(home) / ".local" / "state" / "spellingbee";
+    }
+    return ".spellingbee";
+}
+
+static void save_session_state(const fs::path& path, const WD& wd) {
+    std::error_code ec;
+    if (path.has_parent_path()) fs::create_directories(path.parent_path(), ec);
+    const fs::path tmp = path.string() + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) {
+            log_at(LogLevel::Warn, "Could not save session state to ", path);
+            return;
+        }
+        out << json{{"base", wd.base}, {"session_id", wd.sessionId}, {"debugger_address", wd.debugger_address}}.dump() << "\n";
+    }
+    fs::rename(tmp, path, ec);
+    if (ec) log_at(LogLevel::Warn, "Could not save session state to ", path, ": ", ec.message());
+}
+
+static void clear_session_state(const fs::path& path) {
+    std::error_code ec;
+    fs::remove(path, ec);
+}
+
+// Adopts the saved session if it belongs to this WebDriver endpoint and still answers.
+// Returns the page it is showing; on failure the stale record is dropped.
+static std::optional<std::string> reattach_saved_session(WD& wd, const fs::path& path) {
+    std::ifstream in(path);
+    if (!in) return std::nullopt;
+    const json saved = json::parse(in, nullptr, false);
+    if (!saved.is_object() || saved.value("base", std::string()) != wd.base) return std::nullopt;
+    const auto session_id = saved.value("session_id", std::string());
+    if (session_id.empty()) return std::nullopt;
+
+    wd.sessionId = session_id;
+    wd.debugger_address = saved.value("debugger_address", std::string());
+    const StepBudget budget = StepBudget::after(5s);
+    t_step_budget = &budget;
+    std::optional<std::string> url;
+    try {
+        url = wd.current_url();
+    } catch (const std::exception& e) {
+        log_at(LogLevel::Warn, "Saved session ", session_id, " is gone (", e.what(), "); starting a new one.");
+        wd.sessionId.clear();
+        wd.debugger_address.clear();
+        clear_session_state(path);
+    }
+    t_step_budget = nullptr;
+    return url;
+}
+
+enum class StopAction { Prompt, Keep, Rerun };
+enum class HintsFormat { None, Table, Json };
+
+struct Config {
+    StopAction stop_action = StopAction::Rerun;
+    std::string letters_cli;
+    fs::path dictionary_dir;
+    HintsFormat hints = HintsFormat::None;
+    std::optional<WordQuery> query;
+    std::string check_words_file;   // "-" reads stdin
+    bool async_webdriver = false;
+    bool transport_stats = false;
+    fs::path record_file;   // empty: no recording
+    fs::path metrics_prefix;   // empty: no phase metrics
+    fs::path trace_file;   // empty: no trace
+    LogLevel log_level = LogLevel::Info;
+    LogFormat log_format = LogFormat::Text;
+    std::vector<std::pair<std::string, bool>> word_changes;   // --add-words (true) / --remove-words (false), in order
+    bool compact_dictionaries = false;
+    int bench_webdriver_iterations = 0;
+    int bench_decode_iterations = 0;
+    bool bench = false;
+    uint64_t bench_words = 0;   // 0: the real lists when present, else kDefaultBenchWords synthetic
+    SyntheticSpec synthetic;
+    fs::path generate_dir;      // empty: do not generate
+    uint64_t synthetic_words = 1000000;
+    std::vector<uint64_t> stress_sizes;   // empty: no stress run
+    std::string submit_strategy;   // empty: the calibrated choice, else "actions"
+    fs::path submit_calibration_file;
+    int calibrate_submit_words = 0;
+    std::chrono::milliseconds ready_timeout{15s};   // 0 always asks
+    fs::path session_file;
+    bool reuse_session = true;
+
+    bool has_cli_letters() const { return !letters_cli.empty(); }
+};
+
+static void print_usage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "Options:\n"
+              << "  --stop-action=prompt|keep|rerun  Control what happens after the run stops.\n"
+              << "  --keep-open-on-stop              Shortcut for --stop-action=keep.\n"
+              << "  --rerun-on-stop                  Shortcut for --stop-action=rerun.\n"
+              << "  --letters=ABCDEFg                Supply hive letters (center letter last).\n"
+              << "  --dictionary-dir=PATH           Override word list directory. Changes to the lists are\n"
+              << "                                   picked up while the solver runs, without a restart.\n"
+              << "  --add-words=W,W,...              Write a delta segment adding the words to the massive list\n"
+              << "                                   and exit; a running solver picks it up within milliseconds.\n"
+              << "  --remove-words=W,W,...           Likewise, removing the words.\n"
+              << "  --compact-dictionaries           Fold the delta segments into wlist_match1.txt, delete them\n"
+              << "                                   and exit (after writing any --add-words/--remove-words).\n"
+              << "                                   A running solver does this itself past 1024 changes.\n"
+              << "  --hints[=table|json]             Print the hint grid for --letters and exit.\n"
+              << "  --query=SPEC                     Print matching words and exit, e.g.\n"
+              << "                                   prefix=ta,suffix=ing,len=6,pattern=a?e??,tier=extended\n"
+              << "                                   (hive-constrained when --letters is given).\n"
+              << "  --check-words=FILE|-             Print the tier bitmask of each listed word and exit\n"
+              << "                                   (1 short, 2 medium, 4 extended, 8 massive, 16 hive-legal).\n"
+              << "  --async-webdriver                Issue independent WebDriver reads concurrently (curl_multi).\n"
+              << "  --transport-stats                Print per-endpoint WebDriver call counts and timings on exit.\n"
+              << "  --record=FILE                    Log every WebDriver request and reply to FILE (JSON lines)\n"
+              << "                                   for tools/replay_webdriver.py.\n"
+              << "  --metrics-file=PREFIX            Time every phase (loads, index, WebDriver calls, board read,\n"
+              << "                                   solve, payload, submit) into histograms and write\n"
+              << "                                   PREFIX.prom and PREFIX.json on exit and on SIGUSR1.\n"
+              << "  --trace=FILE                     Write a Chrome trace (chrome://tracing, Perfetto) of each run:\n"
+              << "                                   steps, retries, WebDriver requests and prompt waits.\n"
+              << "  --log-level=LEVEL                Least severe diagnostics shown: debug, info (default), warn,\n"
+              << "                                   error, fatal or off. debug adds the hive cell attributes\n"
+              << "                                   when the board read goes wrong.\n"
+              << "  --log-format=text|json           Write diagnostics as [WARN] lines (default) or as JSON lines\n"
+              << "                                   with ts, level, thread, msg and per-record fields.\n"
+              << "  --ready-timeout=SECONDS          Wait up to SECONDS for the board to load (dismissing\n"
+              << "                                   known modals) before asking; 0 always asks (default 15).\n"
+              << "  --session-file=PATH              Where a kept browser session is recorded for reuse\n"
+              << "                                   (default $XDG_STATE_HOME/spellingbee/session.json).\n"
+              << "  --new-session                    Ignore any saved session and start a fresh browser.\n"
+              << "  --submit-strategy=NAME           How words are typed: actions (one W3C actions request),\n"
+              << "                                   batched:N, paced[:MS], element-value, script, cdp-keys\n"
+              << "                                   or cdp-text. paced types batches with a pause between\n"
+              << "                                   words (initially MS, default 10), lengthening it when\n"
+              << "                                   retyped words show dropped keys. cdp-keys and cdp-text need libcurl built with\n"
+              << "                                   WebSocket support (7.86+, ws enabled) and are skipped by\n"
+              << "                                   --calibrate-submit without it. Defaults to the last\n"
+              << "                                   --calibrate-submit winner, else actions.\n"
+              << "  --bench                          Run the loader, solver and payload micro-benchmarks, print\n"
+              << "                                   JSON (time and allocations per op) and exit. Uses synthetic\n"
+              << "                                   word lists unless all five are in the dictionary directory.\n"
+              << "                                   Exits 1 if loading, solving, the payload or reply decoding\n"
+              << "                                   goes over its allocation budget.\n"
+              << "  --bench-words=N                  Benchmark against N synthetic words even if real lists exist.\n"
+              << "  --generate-dictionaries=DIR      Write the five word lists, filled with synthetic English-like\n"
+              << "                                   words, to DIR and exit.\n"
+              << "  --synthetic-words=N              Words to generate (default 1M; k, M and G suffixes work).\n"
+              << "  --word-lengths=LEN:W,...         Override the weight of word lengths, e.g. 3:0,15:2.\n"
+              << "  --letter-weights=L:W,...         Override letter frequencies (per mille), e.g. e:150,z:0.\n"
+              << "  --synthetic-seed=N               Seed of the synthetic word generator.\n"
+              << "  --stress[=N,N,...]               Generate, load, index and solve synthetic dictionaries of\n"
+              << "                                   each size (default 1M,3M,10M), print load time, RSS and\n"
+              << "                                   solve latency per size as JSON, and exit. Larger sizes,\n"
+              << "                                   e.g. --stress=30M,100M, need tens of GB of RAM and a few\n"
+              << "                                   GB of $TMPDIR.\n"
+              << "  --bench-decode=N                 Time N decodes of typical chromedriver replies, json::parse\n"
+              << "                                   against the field scanner, and exit.\n"
+              << "  --bench-webdriver=N              Time N blocking vs. concurrent board reads against\n"
+              << "                                   WEBDRIVER_URL (e.g. a mock chromedriver) and exit.\n"
+              << "  --calibrate-submit[=N]           Type N (default 500) words through every strategy on a\n"
+              << "                                   recording page, report speed and dropped keystrokes,\n"
+              << "                                   save the fastest reliable one, and exit.\n"
+              << "  -h, --help                       Show this help message.\n";
+}
+
+static Config parse_args(int argc, char** argv) {
+    Config cfg;
+    cfg.dictionary_dir = find_default_dictionary_dir();
+    cfg.session_file = default_state_dir() / "session.json";
+    cfg.submit_calibration_file = default_state_dir() / "submit-strategy.json";
+    const std::string stop_prefix = "--stop-action=";
+    const std::string letters_prefix = "--letters=";
+    const std::string dict_prefix = "--dictionary-dir=";
+    const std::string query_prefix = "--query=";
+    const std::string check_prefix = "--check-words=";
+    const std::string bench_wd_prefix = "--bench-webdriver=";
+    const std::string bench_decode_prefix = "--bench-decode=";
+    const std::string bench_words_prefix = "--bench-words=";
+    const std::string generate_prefix = "--generate-dictionaries=";
+    const std::string synthetic_words_prefix = "--synthetic-words=";
+    const std::string word_lengths_prefix = "--word-lengths=";
+    const std::string letter_weights_prefix = "--letter-weights=";
+    const std::string synthetic_seed_prefix = "--synthetic-seed=";
+    const std::string stress_prefix = "--stress=";
+    const std::string ready_prefix = "--ready-timeout=";
+    const std::string session_file_prefix = "--session-file=";
+    const std::string submit_prefix = "--submit-strategy=";
+    const std::string calibrate_prefix = "--calibrate-submit=";
+    const std::string record_prefix = "--record=";
+    const std::string metrics_prefix = "--metrics-file=";
+    const std::string trace_prefix = "--trace=";
+    const std::string add_words_prefix = "--add-words=";
+    const std::string remove_words_prefix = "--remove-words=";
+    const std::string log_level_prefix = "--log-level=";
+    const std::string log_format_prefix = "--log-format=";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            std::exit(0);
+        }
+
+        if (arg.rfind(stop_prefix, 0) == 0) {
+            std::string value = arg.substr(stop_prefix.size());
+            if (value == "prompt") {
+                cfg.stop_action = StopAction::Prompt;
+            } else if (value == "keep") {
+                cfg.stop_action = StopAction::Keep;
+            } else if (value == "rerun") {
+                cfg.stop_action = StopAction::Rerun;
+            } else {
+                std::cerr << "Unknown stop action: " << value << "\n";
+                print_usage(argv[0]);
+                std::exit(1);
+            }
+            continue;
+        }
+
+        if (arg == "--keep-open-on-stop") {
+            cfg.stop_action = StopAction::Keep;
+            continue;
+        }
+        if (arg == "--rerun-on-stop") {
+            cfg.stop_action = StopAction::Rerun;
+            continue;
+        }
+
+        if (arg == "--letters") {
+            if (i + 1 >= argc) {
+                std::cerr << "--letters requires a value\n";
+                print_usage(argv[0]);
+                std::exit(1);
+            }
+            cfg.letters_cli = normalize_letters(argv[++i]);
+            continue;
+        }
+        if (arg.rfind(letters_prefix, 0) == 0) {
+            cfg.letters_cli = normalize_letters(arg.substr(letters_prefix.size()));
+            continue;
+        }
+
+        if (arg == "--dictionary-dir") {
+            if (i + 1 >= argc) {
+                std::cerr << "--dictionary-dir requires a path\n";
+                print_usage(argv[0]);
+                std::exit(1);
+            }
+            cfg.dictionary_dir = fs::path(argv[++i]);
+            continue;
+        }
+        if (arg.rfind(dict_prefix, 0) == 0) {
+            cfg.dictionary_dir = fs::path(arg.substr(dict_prefix.size()));
+            continue;
+        }
+
+        if (arg == "--query" || arg.rfind(query_prefix, 0) == 0) {
+            std::string spec;
+            if (arg == "--query") {
+                if (i + 1 >= argc) {
+                    std::cerr << "--query requires a value\n";
+                    print_usage(argv[0]);
+                    std::exit(1);
+                }
+                spec = argv[++i];
+            } else {
+                spec = arg.substr(query_prefix.size());
+            }
+            try {
+                cfg.query = parse_query_spec(spec);
+            } catch (const std::exception& e) {
+                std::cerr << "Invalid query: " << e.what() << "\n";
+                std::exit(1);
+            }
+            continue;
+        }
+
+        if (arg == "--check-words") {
+            if (i + 1 >= argc) {
+                std::cerr << "--check-words requires a path\n";
+                print_usage(argv[0]);
+                std::exit(1);
+            }
+            cfg.check_words_file = argv[++i];
+            continue;
+        }
+        if (arg.rfind(check_prefix, 0) == 0) {
+            cfg.check_words_file = arg.substr(check_prefix.size());
+            continue;
+        }
+
+        if (arg == "--transport-stats") {
+            cfg.transport_stats = true;
+            continue;
+        }
+        if (arg.rfind(metrics_prefix, 0) == 0) {
+            cfg.metrics_prefix = arg.substr(metrics_prefix.size());
+            if (cfg.metrics_prefix.empty()) {
+                std::cerr << "--metrics-file requires a path prefix\n";
+                std::exit(1);
+            }
+            continue;
+        }
+        if (arg.rfind(trace_prefix, 0) == 0) {
+            cfg.trace_file = arg.substr(trace_prefix.size());
+            if (cfg.trace_file.empty()) {
+                std::cerr << "--trace requires a path\n";
+                std::exit(1);
+            }
+            continue;
+        }
+        if (arg.rfind(add_words_prefix, 0) == 0 || arg.rfind(remove_words_prefix, 0) == 0) {
+            const bool add = arg.rfind(add_words_prefix, 0) == 0;
+            std::istringstream words(arg.substr((add ? add_words_prefix : remove_words_prefix).size()));
+            const size_t listed = cfg.word_changes.size();
+            for (std::string word; std::getline(words, word, ',');) {
+                word = to_lower_copy(trim_copy(word));
+                if (!word.empty()) cfg.word_changes.emplace_back(word, add);
+            }
+            if (cfg.word_changes.size() == listed) {
+                std::cerr << (add ? "--add-words" : "--remove-words") << " requires a comma-separated word list\n";
+                std::exit(1);
+            }
+            continue;
+        }
+        if (arg == "--compact-dictionaries") {
+            cfg.compact_dictionaries = true;
+            continue;
+        }
+        if (arg.rfind(log_level_prefix, 0) == 0) {
+            const auto level = parse_log_level(arg.substr(log_level_prefix.size()));
+            if (!level) {
+                std::cerr << "Invalid --log-level value: " << arg.substr(log_level_prefix.size()) << "\n";
+                std::exit(1);
+            }
+            cfg.log_level = *level;
+            continue;
+        }
+        if (arg.rfind(log_format_prefix, 0) == 0) {
+            const std::string value = arg.substr(log_format_prefix.size());
+            if (value == "text") {
+                cfg.log_format = LogFormat::Text;
+            } else if (value == "json") {
+                cfg.log_format = LogFormat::Json;
+            } else {
+                std::cerr << "Invalid --log-format value: " << value << "\n";
+                std::exit(1);
+            }
+            continue;
+        }
+        if (arg.rfind(record_prefix, 0) == 0) {
+            cfg.record_file = arg.substr(record_prefix.size());
+            if (cfg.record_file.empty()) {
+                std::cerr << "--record requires a path\n";
+                std::exit(1);
+            }
+            continue;
+        }
+        if (arg == "--async-webdriver") {
+            cfg.async_webdriver = true;
+            continue;
+        }
+        if (arg.rfind(bench_wd_prefix, 0) == 0) {
+            try {
+                cfg.bench_webdriver_iterations = std::stoi(arg.substr(bench_wd_prefix.size()));
+            } catch (const std::exception&) {
+                cfg.bench_webdriver_iterations = 0;
+            }
+            if (cfg.bench_webdriver_iterations <= 0) {
+                std::cerr << "--bench-webdriver requires a positive iteration count\n";
+                std::exit(1);
+            }
+            continue;
+        }
+        if (arg == "--bench") {
+            cfg.bench = true;
+            continue;
+        }
+        if (arg.rfind(bench_words_prefix, 0) == 0 || arg.rfind(synthetic_words_prefix, 0) == 0 ||
+            arg.rfind(word_lengths_prefix, 0) == 0 || arg.rfind(letter_weights_prefix, 0) == 0 ||
+            arg.rfind(synthetic_seed_prefix, 0) == 0 || arg.rfind(stress_prefix, 0) == 0 || arg == "--stress") {
+            const std::string value = arg.substr(arg.find('=') + 1);
+            try {
+                if (arg.rfind(bench_words_prefix, 0) == 0) {
+                    cfg.bench = true;
+                    cfg.bench_words = parse_word_count(value);
+                } else if (arg.rfind(synthetic_words_prefix, 0) == 0) {
+                    cfg.synthetic_words = parse_word_count(value);
+                } else if (arg.rfind(word_lengths_prefix, 0) == 0) {
+                    parse_synthetic_weights(value, false, cfg.synthetic);
+                } else if (arg.rfind(letter_weights_prefix, 0) == 0) {
+                    parse_synthetic_weights(value, true, cfg.synthetic);
+                } else if (arg.rfind(synthetic_seed_prefix, 0) == 0) {
+                    cfg.synthetic.seed = std::stoull(value);
+                } else if (arg == "--stress") {
+                    cfg.stress_sizes = {1000000, 3000000, 10000000};
+                } else {
+                    cfg.stress_sizes.clear();
+                    std::istringstream sizes(value);
+                    for (std::string size; std::getline(sizes, size, ',');) cfg.stress_sizes.push_back(parse_word_count(size));
+                    if (cfg.stress_sizes.empty()) throw std::runtime_error("--stress needs at least one size");
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Invalid " << arg << ": " << e.what() << "\n";
+                std::exit(1);
+            }
+            continue;
+        }
+        if (arg.rfind(generate_prefix, 0) == 0) {
+            cfg.generate_dir = arg.substr(generate_prefix.size());
+            if (cfg.generate_dir.empty()) {
+                std::cerr << "--generate-dictionaries requires a directory\n";
+                std::exit(1);
+            }
+            continue;
+        }
+        if (arg.rfind(bench_decode_prefix, 0) == 0) {
+            try {
+                cfg.bench_decode_iterations = std::stoi(arg.substr(bench_decode_prefix.size()));
+            } catch (const std::exception&) {
+                cfg.bench_decode_iterations = 0;
+            }
+            if (cfg.bench_decode_iterations <= 0) {
+                std::cerr << "--bench-decode requires a positive iteration count\n";
+                std::exit(1);
+            }
+            continue;
         }
-        CURLcode code = curl_easy_perform(curl);
-        if (code != CURLE_OK) {
-            std::ostringstream oss; oss << "CURL error: " << curl_easy_strerror(code);
-            throw std::runtime_error(oss.str());
+
+        if (arg.rfind(session_file_prefix, 0) == 0) {
+            cfg.session_file = arg.substr(session_file_prefix.size());
+            if (cfg.session_file.empty()) {
+                std::cerr << "--session-file requires a path\n";
+                std::exit(1);
+            }
+            continue;
         }
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &resp.status);
-        return resp;
-    }
-    json request_json(const std::string& method, const std::string& url, const json& payload = {}) {
-        auto resp = request(method, url, payload.is_null() ? "" : payload.dump());
-        if (resp.status < 200 || resp.status >= 300) {
-            std::ostringstream oss; oss << "HTTP " << resp.status << " from " << url << " body: " << resp.body;
-            throw std::runtime_error(oss.str());
+        if (arg.rfind(submit_prefix, 0) == 0) {
+            cfg.submit_strategy = arg.substr(submit_prefix.size());
+            if (!make_word_submitter(cfg.submit_strategy)) {
+                std::cerr << "Invalid --submit-strategy value: " << cfg.submit_strategy
+                          << " (expected actions, batched:N, element-value, script, cdp-keys or cdp-text)\n";
+                std::exit(1);
+            }
+            if (is_devtools_strategy(cfg.submit_strategy) && !curl_supports_websockets()) {
+                std::cerr << "--submit-strategy=" << cfg.submit_strategy << " needs libcurl with WebSocket support, "
+                          << "but libcurl " << curl_version_info(CURLVERSION_NOW)->version
+                          << " has none; use actions, batched:N, element-value or script\n";
+                std::exit(1);
+            }
+            continue;
+        }
+        if (arg == "--calibrate-submit") {
+            cfg.calibrate_submit_words = 500;
+            continue;
+        }
+        if (arg.rfind(calibrate_prefix, 0) == 0) {
+            try {
+                cfg.calibrate_submit_words = std::stoi(arg.substr(calibrate_prefix.size()));
+            } catch (const std::exception&) {
+                cfg.calibrate_submit_words = 0;
+            }
+            if (cfg.calibrate_submit_words <= 0) {
+                std::cerr << "--calibrate-submit requires a positive word count\n";
+                std::exit(1);
+            }
+            continue;
+        }
+        if (arg == "--new-session") {
+            cfg.reuse_session = false;
+            continue;
         }
-        return resp.body.empty() ? json() : json::parse(resp.body);
-    }
-};
 
-struct WD {
-    std::string base = "http://localhost:9515";
-    std::string sessionId;
-    CurlSession* cs = nullptr;
-    static constexpr const char* kElemKey = "element-6066-11e4-a52e-4f735466cecf";
-    explicit WD(CurlSession& s) : cs(&s) {}
+        if (arg.rfind(ready_prefix, 0) == 0) {
+            int seconds = -1;
+            try {
+                seconds = std::stoi(arg.substr(ready_prefix.size()));
+            } catch (const std::exception&) {
+            }
+            if (seconds < 0) {
+                std::cerr << "--ready-timeout requires a non-negative number of seconds\n";
+                std::exit(1);
+            }
+            cfg.ready_timeout = std::chrono::seconds(seconds);
+            continue;
+        }
 
-    json new_session() {
-        // Always windowed + keep Chrome open when we exit (detach)
-        json args = {"--disable-features=PaintHolding",
-                     "--disable-extensions",
-                     "--mute-audio",
-                     "--remote-allow-origins=*"}; // Needed for ChromeDriver 111+ handshake
-        json chromeOptions = {{"args", args}, {"detach", true}};
-        json caps = {{"capabilities", {{"alwaysMatch", {{"browserName","chrome"},{"goog:chromeOptions",chromeOptions}}}}}};
-        auto j = cs->request_json("POST", base + "/session", caps);
-        sessionId = j.at("value").at("sessionId").get<std::string>();
-        return j;
-    }
-    void delete_session() {
-        if (!sessionId.empty()) {
-            cs->request_json("DELETE", base + "/session/" + sessionId);
-            sessionId.clear();
+        if (arg == "--hints" || arg == "--hints=table") {
+            cfg.hints = HintsFormat::Table;
+            continue;
+        }
+        if (arg == "--hints=json") {
+            cfg.hints = HintsFormat::Json;
+            continue;
         }
+
+        std::cerr << "Unknown argument: " << arg << "\n";
+        print_usage(argv[0]);
+        std::exit(1);
     }
-    void navigate(const std::string& url) {
-        cs->request_json("POST", base + "/session/" + sessionId + "/url", json{{"url", url}});
+
+    if (!cfg.letters_cli.empty() && cfg.letters_cli.size() != 7) {
+        std::cerr << "letters must contain exactly 7 alphabetic characters (center letter last)\n";
+        std::exit(1);
     }
-    void set_window_size(int w, int h) {
-        cs->request_json("POST", base + "/session/" + sessionId + "/window/rect", json{{"width", w},{"height", h}});
+    if (cfg.hints != HintsFormat::None && cfg.letters_cli.empty()) {
+        std::cerr << "--hints requires --letters\n";
+        std::exit(1);
     }
-    std::string find_element_id_css(const std::string& css) {
-        auto j = cs->request_json("POST", base + "/session/" + sessionId + "/element",
-                                  json{{"using","css selector"},{"value",css}});
-        return j.at("value").at(kElemKey).get<std::string>();
+    if (cfg.query && cfg.query->letters.empty()) {
+        cfg.query->letters = cfg.letters_cli;
     }
-    std::string get_element_text(const std::string& elemId) {
-        auto j = cs->request_json("GET", base + "/session/" + sessionId + "/element/" + elemId + "/text");
-        return j.at("value").is_null() ? std::string() : j.at("value").get<std::string>();
+
+    return cfg;
+}
+
+// `massive_changes` are the delta segments' changes to the massive list, as the solver
+// sees them: they override the massive tier bit of the words they name.
+static int run_membership_check(const Config& config, const WordDictionaries& dictionaries,
+                                const WordChanges& massive_changes) {
+    std::ifstream file;
+    if (config.check_words_file != "-") {
+        file.open(config.check_words_file);
+        if (!file) throw std::runtime_error("failed to open word list: " + config.check_words_file);
     }
-    std::string get_element_attribute(const std::string& elemId, const std::string& attribute) {
-        auto j = cs->request_json("GET", base + "/session/" + sessionId + "/element/" + elemId + "/attribute/" + attribute);
-        return j.at("value").is_null() ? std::string() : j.at("value").get<std::string>();
+    std::istream& in = config.check_words_file == "-" ? std::cin : file;
+    std::vector<std::string> words;
+    std::string line;
+    while (std::getline(in, line)) {
+        auto trimmed = trim_copy(line);
+        if (!trimmed.empty()) words.push_back(to_lower_copy(std::move(trimmed)));
     }
-    void click_element(const std::string& elemId) {
-        cs->request_json("POST", base + "/session/" + sessionId + "/element/" + elemId + "/click", json::object());
+
+    const MembershipTable table(dictionaries);
+    std::optional<HiveFilter> hive;
+    if (config.has_cli_letters()) hive = make_hive_filter(config.letters_cli);
+    auto bits = table.lookup_batch(words, hive);
+    for (size_t i = 0; i < words.size(); ++i) {
+        const auto change = massive_changes.find(words[i]);
+        if (change == massive_changes.end()) continue;
+        if (change->second) bits[i] |= kTierMassive;
+        else bits[i] &= static_cast<uint8_t>(~kTierMassive);
     }
-    void send_all_words_as_keys(const std::vector<std::string>& words_upper) {
-        json actions = json::array();
-        json keyActions = {{"type","key"},{"id","keyboard"},{"actions", json::array()}};
-        auto& seq = keyActions["actions"];
-        for (const auto& w : words_upper) {
-            for (char c : w) {
-                char up = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
-                std::string s(1, up);
-                seq.push_back({{"type","keyDown"},{"value",s}});
-                seq.push_back({{"type","keyUp"},{"value",s}});
-            }
-            seq.push_back({{"type","keyDown"},{"value","\uE007"}});
-            seq.push_back({{"type","keyUp"},{"value","\uE007"}});
-        }
-        actions.push_back(keyActions);
-        cs->request_json("POST", base + "/session/" + sessionId + "/actions", json{{"actions", actions}});
+
+    std::string out;
+    for (size_t i = 0; i < words.size(); ++i) {
+        out += words[i];
+        out += '\t';
+        out += std::to_string(bits[i]);
+        out += '\t';
+        out += describe_tiers(bits[i]);
+        out += '\n';
     }
-};
+    std::cout << out << std::flush;
+    std::cerr << words.size() << " words checked against " << table.count << " dictionary entries." << std::endl;
+    return 0;
+}
 
-// ---------- Pause/Retry Utilities ----------
-enum class StepResult { OK, SKIP, QUIT };
+// ---------- Dictionary loading ----------
+// Delta segments are files named delta-*.txt beside the word lists. Each line is "+word",
+// adding a word to the massive list, or "-word", a tombstone removing one. Segments apply in
+// file name order on top of wlist_match1.txt, so the last line about a word wins, and are
+// merged at query time (LayeredWordIndex) instead of rebuilding the index. --add-words and
+// --remove-words write a segment; --compact-dictionaries folds them into wlist_match1.txt.
+constexpr std::string_view kDeltaSegmentPrefix = "delta-";
+constexpr std::string_view kDeltaSegmentSuffix = ".txt";
+// Past this many layered changes, a load folds them into a new base index, and a running
+// solver's DictionaryWatcher folds the segments into wlist_match1.txt on disk.
+constexpr size_t kCompactAfterChanges = 1024;
 
-static std::string prompt_line(const std::string& prompt) {
-    std::cout << prompt << std::flush;
-    std::string s; std::getline(std::cin, s); return s;
+static bool is_delta_segment(std::string_view name) {
+    return name.size() > kDeltaSegmentPrefix.size() + kDeltaSegmentSuffix.size() &&
+           name.starts_with(kDeltaSegmentPrefix) && name.ends_with(kDeltaSegmentSuffix);
 }
 
-static void pause_banner(const std::string& reason) {
-    std::cout << "\n=== PAUSED ======================================\n"
-              << reason << "\n"
-              << "Fix the browser if needed, then:\n"
-              << "  [Enter] retry  |  'skip' to skip  |  'quit' to stop workflow\n"
-              << "=================================================\n";
+static std::vector<fs::path> list_delta_segments(const fs::path& dir) {
+    std::vector<fs::path> segments;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        if (entry.is_regular_file() && is_delta_segment(entry.path().filename().string())) {
+            segments.push_back(entry.path());
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
 }
 
-template <typename Fn>
-StepResult retry_with_pause(const char* what, Fn fn) {
-    for (;;) {
-        try {
-            fn();
-            return StepResult::OK;
-        } catch (const std::exception& e) {
-            std::cerr << "[WARN] " << what << " failed: " << e.what() << "\n";
-            pause_banner(std::string("Step: ") + what);
-            auto cmd = prompt_line("> ");
-            if (cmd == "quit" || cmd == "q") return StepResult::QUIT;
-            if (cmd == "skip" || cmd == "s")  return StepResult::SKIP;
-            // else retry
-        } catch (...) {
-            std::cerr << "[WARN] " << what << " failed with unknown error.\n";
-            pause_banner(std::string("Step: ") + what);
-            auto cmd = prompt_line("> ");
-            if (cmd == "quit" || cmd == "q") return StepResult::QUIT;
-            if (cmd == "skip" || cmd == "s")  return StepResult::SKIP;
+static WordChanges read_word_changes(const std::vector<fs::path>& segments) {
+    WordChanges changes;
+    for (const auto& segment : segments) {
+        std::ifstream in(segment);
+        if (!in) throw std::runtime_error("failed to open delta segment: " + segment.string());
+        std::string line;
+        while (std::getline(in, line)) {
+            const auto trimmed = trim_copy(line);
+            if (trimmed.size() < 2 || (trimmed[0] != '+' && trimmed[0] != '-')) continue;
+            const auto word = to_lower_copy(trim_copy(trimmed.substr(1)));
+            if (!word.empty()) changes[word] = trimmed[0] == '+';
         }
     }
+    return changes;
 }
 
-static inline void to_upper_inplace(std::string& s) {
-    for (auto& c : s) c = std::toupper(static_cast<unsigned char>(c));
+// Writes `changes` as a new segment named after the current time, so it sorts after the
+// existing ones. It is renamed into place, so a watcher never reads it half-written.
+static fs::path write_delta_segment(const fs::path& dir, const std::vector<std::pair<std::string, bool>>& changes) {
+    const auto stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    char name[64];
+    std::snprintf(name, sizeof(name), "%.*s%020lld%.*s", static_cast<int>(kDeltaSegmentPrefix.size()),
+                  kDeltaSegmentPrefix.data(), static_cast<long long>(stamp),
+                  static_cast<int>(kDeltaSegmentSuffix.size()), kDeltaSegmentSuffix.data());
+    const fs::path path = dir / name;
+    const fs::path tmp = dir / ("." + std::string(name) + ".tmp");
+    {
+        std::ofstream out(tmp);
+        for (const auto& [word, present] : changes) out << (present ? '+' : '-') << word << '\n';
+        if (!out.flush()) throw std::runtime_error("cannot write " + tmp.string());
+    }
+    fs::rename(tmp, path);
+    return path;
 }
 
-static inline std::string to_lower_copy(std::string s) {
-    for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-    return s;
+// An exclusive flock on <dir>/.compact.lock, taken around folding the segments so that a
+// solver's watcher and --compact-dictionaries never fold the same segments at once.
+// held() is false when `wait` is off and another process has it.
+class CompactionLock {
+public:
+    CompactionLock(const fs::path& dir, bool wait) {
+        const fs::path path = dir / ".compact.lock";
+        fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) throw std::runtime_error("cannot open " + path.string() + ": " + std::strerror(errno));
+        while (flock(fd_, LOCK_EX | (wait ? 0 : LOCK_NB)) != 0) {
+            if (errno == EINTR) continue;
+            const int err = errno;
+            close(fd_);
+            fd_ = -1;
+            if (err == EWOULDBLOCK) return;
+            throw std::runtime_error("cannot lock " + path.string() + ": " + std::strerror(err));
+        }
+    }
+    ~CompactionLock() {
+        if (fd_ >= 0) close(fd_);
+    }
+    CompactionLock(const CompactionLock&) = delete;
+    CompactionLock& operator=(const CompactionLock&) = delete;
+
+    bool held() const { return fd_ >= 0; }
+
+private:
+    int fd_ = -1;
+};
+
+struct FoldResult {
+    size_t segments = 0;
+    size_t added = 0;
+    size_t removed = 0;
+    size_t words = 0;
+};
+
+// Folds every delta segment in `dir` into wlist_match1.txt (sorted, lowercase, one word per
+// line) and deletes them. Only the segments listed here are deleted, so one an --add-words
+// writes meanwhile survives and still applies on top. The caller holds the CompactionLock.
+static FoldResult fold_delta_segments(const fs::path& dir) {
+    FoldResult result;
+    const auto segments = list_delta_segments(dir);
+    if (segments.empty()) return result;
+    const fs::path base = dir / "wlist_match1.txt";
+    std::set<std::string> words;
+    load_word_file(base, words);
+    for (const auto& [word, present] : read_word_changes(segments)) {
+        if (present) result.added += words.insert(word).second;
+        else result.removed += words.erase(word);
+    }
+    const fs::path tmp = dir / ".wlist_match1.txt.tmp";
+    {
+        std::ofstream out(tmp);
+        for (const auto& word : words) out << word << '\n';
+        if (!out.flush()) throw std::runtime_error("cannot write " + tmp.string());
+    }
+    fs::rename(tmp, base);
+    for (const auto& segment : segments) fs::remove(segment);
+    result.segments = segments.size();
+    result.words = words.size();
+    return result;
 }
 
-static inline std::string trim_copy(const std::string& s) {
-    const auto not_space = [](unsigned char ch) { return !std::isspace(ch); };
-    auto begin = std::find_if(s.begin(), s.end(), not_space);
-    auto end = std::find_if(s.rbegin(), s.rend(), not_space).base();
-    if (begin >= end) return std::string();
-    return std::string(begin, end);
+// Writes the --add-words / --remove-words segment, then with --compact-dictionaries folds
+// every segment into wlist_match1.txt, waiting for a running solver's fold to finish first.
+static int run_dictionary_update(const Config& config) {
+    const fs::path dir = config.dictionary_dir;
+    if (!config.word_changes.empty()) {
+        const fs::path segment = write_delta_segment(dir, config.word_changes);
+        std::cout << "Wrote " << config.word_changes.size() << " word changes to " << segment.string() << "\n";
+    }
+    if (!config.compact_dictionaries) return 0;
+    const CompactionLock lock(dir, true);
+    const FoldResult folded = fold_delta_segments(dir);
+    if (!folded.segments) {
+        std::cout << "No delta segments to compact in " << dir.string() << ".\n";
+        return 0;
+    }
+    std::cout << "Folded " << folded.segments << " delta segments into " << (dir / "wlist_match1.txt").string()
+              << " (" << folded.added << " added, " << folded.removed << " removed, " << folded.words << " words).\n";
+    return 0;
 }
 
-static bool has_class_token(const std::string& classes_lower, const std::string& token) {
-    std::istringstream iss(classes_lower);
-    std::string part;
-    while (iss >> part) {
-        if (part == token) return true;
+struct LoadedDictionaries {
+    std::shared_ptr<const WordDictionaries> dictionaries;   // as last read in full, without the segments
+    std::shared_ptr<const WordIndex> massive_base;          // wlist_match1.txt alone
+    LayeredWordIndex massive_index;                         // massive_base plus the delta segments
+    size_t segment_changes = 0;                             // changes the segments made, compacted or not
+};
+
+static std::shared_ptr<const LoadedDictionaries> load_and_index_dictionaries(const fs::path& dir) {
+    block_interrupt_signal();
+    auto loaded = std::make_shared<LoadedDictionaries>();
+    auto dictionaries = std::make_shared<const WordDictionaries>(load_word_dictionaries(dir));
+    if (dictionaries->massive_words.empty()) {
+        throw std::runtime_error("word list 'wlist_match1.txt' appears to be empty in " + dir.string());
     }
-    return false;
+    loaded->massive_base = std::make_shared<const WordIndex>(build_word_index(dictionaries->massive_words));
+    loaded->dictionaries = std::move(dictionaries);
+    loaded->massive_index = layer_word_changes(loaded->massive_base, read_word_changes(list_delta_segments(dir)));
+    loaded->segment_changes = loaded->massive_index.changes();
+    if (loaded->segment_changes > kCompactAfterChanges) {
+        loaded->massive_index = compact_word_index(loaded->massive_index);
+    }
+    return loaded;
 }
 
-static std::string normalize_letters(const std::string& raw) {
-    std::string result;
-    result.reserve(raw.size());
-    for (char ch : raw) {
-        if (std::isspace(static_cast<unsigned char>(ch))) continue;
-        if (!std::isalpha(static_cast<unsigned char>(ch))) {
-            std::ostringstream oss;
-            oss << "letters may only contain alphabetic characters (got '" << ch << "')";
-            throw std::runtime_error(oss.str());
+// Loads and indexes the word lists on a background thread, started before curl and the
+// browser session so that session creation, navigation and the ready prompt hide the load.
+// Callers block only in get(), i.e. at the moment they need the words. A DictionaryWatcher
+// may later replace() the snapshot; callers hold the one get() returned for as long as they
+// use it, so a reload never pulls the words out from under a solve.
+struct DictionaryLoader {
+    fs::path dir;
+    std::ostream* status_out;
+    bool report_waits;   // off in the offline modes, which always wait and print only results
+    std::shared_future<std::shared_ptr<const LoadedDictionaries>> pending;
+    std::atomic<std::shared_ptr<const LoadedDictionaries>> current;   // newest snapshot, once loaded
+    bool announced = false;
+    bool failed = false;
+
+    DictionaryLoader(fs::path d, std::ostream& out, bool waits)
+        : dir(std::move(d)),
+          status_out(&out),
+          report_waits(waits),
+          pending(std::async(std::launch::async, load_and_index_dictionaries, dir).share()) {}
+
+    // The newest snapshot. Until one is loaded, rethrows the load error, if any, on every call.
+    std::shared_ptr<const LoadedDictionaries> get() {
+        if (auto snapshot = current.load()) return snapshot;
+        if (report_waits && pending.wait_for(0s) != std::future_status::ready) {
+            *status_out << "Waiting for word lists to finish loading..." << std::endl;
+        }
+        try {
+            const auto& loaded = pending.get();
+            if (!announced) {
+                *status_out << "Loaded word lists from " << dir
+                            << " (massive set size: " << loaded->dictionaries->massive_words.size() << ")" << std::endl;
+                announced = true;
+            }
+            std::shared_ptr<const LoadedDictionaries> expected;
+            current.compare_exchange_strong(expected, loaded);   // unless a reload got there first
+            return current.load();
+        } catch (...) {
+            failed = true;
+            throw;
         }
-        result.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(ch))));
     }
-    return result;
-}
 
-struct WordDictionaries {
-    std::set<std::string> short_words;
-    std::set<std::string> medium_words;
-    std::set<std::string> extended_words;
-    std::set<std::string> massive_words;
+    void replace(std::shared_ptr<const LoadedDictionaries> snapshot) { current.store(std::move(snapshot)); }
 };
 
-static const std::array<char, 6> kVowels = {'a', 'e', 'i', 'o', 'u', 'y'};
+// Watches the word list directory with inotify for as long as a run keeps going. Once writes
+// to the lists have settled, they are loaded and indexed again on the watcher's thread and
+// swapped into the loader as a new snapshot: a solve already holding the previous one
+// finishes on it and the next solve gets the new words, with no restart and no pause. A
+// reload that fails, say on a list caught half-written, is logged and the current lists kept.
+// A changed delta segment only re-layers the segments on the current base, which takes
+// milliseconds; when that leaves many changes, they are compacted into a new base afterwards.
+// Past kCompactAfterChanges the watcher also folds the segments into wlist_match1.txt on disk
+// (after the first load, too, if they were already past it), so later loads stop paying for
+// them; the new list landing is a list change, which the usual reload picks up.
+class DictionaryWatcher {
+public:
+    static constexpr auto kSettle = 500ms;
+    static constexpr auto kFirstLoadPoll = 100ms;
 
-static bool contains_vowel(const std::string& word) {
-    for (char c : word) {
-        char lower = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-        if (std::find(kVowels.begin(), kVowels.end(), lower) != kVowels.end()) {
-            return true;
+    explicit DictionaryWatcher(DictionaryLoader& loader) : loader_(loader), first_load_(loader.pending) {
+        inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd_ < 0 || inotify_add_watch(inotify_fd_, loader.dir.c_str(), kEvents) < 0 ||
+            pipe(wake_fds_) != 0) {
+            log_at(LogLevel::Warn, "Cannot watch ", loader.dir, " for word list changes: ", std::strerror(errno));
+            return;
         }
+        thread_ = std::thread([this] { watch(); });
     }
-    return false;
-}
 
-static void load_word_file(const fs::path& file, std::set<std::string>& out) {
-    std::ifstream in(file);
-    if (!in) {
-        std::ostringstream oss;
-        oss << "failed to open dictionary file: " << file.string();
-        throw std::runtime_error(oss.str());
+    ~DictionaryWatcher() {
+        if (thread_.joinable()) {
+            const char wake = 0;
+            (void)!write(wake_fds_[1], &wake, 1);
+            thread_.join();
+        }
+        for (int fd : {inotify_fd_, wake_fds_[0], wake_fds_[1]}) {
+            if (fd >= 0) close(fd);
+        }
     }
-    std::string line;
-    while (std::getline(in, line)) {
-        auto trimmed = trim_copy(line);
-        if (trimmed.empty()) continue;
-        out.insert(to_lower_copy(trimmed));
+
+    DictionaryWatcher(const DictionaryWatcher&) = delete;
+    DictionaryWatcher& operator=(const DictionaryWatcher&) = delete;
+
+private:
+    static constexpr uint32_t kEvents = IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM | IN_DELETE_SELF |
+                                        IN_MOVE_SELF;
+
+    struct Touched {
+        bool lists = false;
+        bool segments = false;
+        bool gone = false;   // the directory itself was moved or removed
+    };
+
+    void watch() {
+        block_interrupt_signal();
+        if (!await_first_load()) return;
+        bool lists_changed = false;
+        for (;;) {
+            pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fds_[0], POLLIN, 0}};
+            // With a list change pending, wait for the writes to go quiet before reloading.
+            const int ready = poll(fds, 2, lists_changed ? static_cast<int>(kSettle.count()) : -1);
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready < 0 || fds[1].revents) return;
+            if (ready == 0) {
+                lists_changed = false;
+                reload();
+                continue;
+            }
+            const Touched touched = read_events();
+            if (touched.gone) {
+                log_at(LogLevel::Warn, loader_.dir, " was moved or removed; word list changes are no longer picked up.");
+                return;
+            }
+            lists_changed |= touched.lists;
+            // A segment is complete once closed or renamed into place, so it applies at once,
+            // unless a full reload is due anyway.
+            if (touched.segments && !lists_changed) apply_segments();
+        }
     }
-}
 
-static WordDictionaries load_word_dictionaries(const fs::path& base_dir) {
-    WordDictionaries dictionaries;
-    load_word_file(base_dir / "wordlist.txt", dictionaries.short_words);
-    load_word_file(base_dir / "wiki-100k.txt", dictionaries.medium_words);
-    load_word_file(base_dir / "words.txt", dictionaries.extended_words);
-    load_word_file(base_dir / "words400k.txt", dictionaries.extended_words);
-    load_word_file(base_dir / "wlist_match1.txt", dictionaries.massive_words);
-    return dictionaries;
-}
+    // Waits for the loader's first load, which reads the segments itself, then folds them if
+    // they are already past the threshold. Events meanwhile stay queued. False once woken to stop.
+    bool await_first_load() {
+        while (first_load_.wait_for(0s) != std::future_status::ready) {
+            pollfd wake{wake_fds_[0], POLLIN, 0};
+            if (poll(&wake, 1, static_cast<int>(kFirstLoadPoll.count())) > 0) return false;
+        }
+        try {
+            compact_on_disk(first_load_.get()->segment_changes);
+        } catch (const std::exception&) {
+            // The first load failed; get() reports that to the run.
+        }
+        return true;
+    }
 
-static std::vector<std::string> find_valid_words(const std::set<std::string>& dictionary,
-                                                 const std::string& letters) {
-    if (letters.size() < 1) {
-        throw std::runtime_error("letters input is empty");
+    // Folds the segments into wlist_match1.txt once they make more than kCompactAfterChanges
+    // changes, unless another process is folding them right now.
+    void compact_on_disk(size_t changes) {
+        if (changes <= kCompactAfterChanges) return;
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            const CompactionLock lock(loader_.dir, false);
+            if (!lock.held()) return;
+            const FoldResult folded = fold_delta_segments(loader_.dir);
+            if (!folded.segments) return;
+            log_at(LogLevel::Info, "Folded ", folded.segments, " delta segments (", changes,
+                   " word changes) into wlist_match1.txt in ",
+                   std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(),
+                   " ms");
+        } catch (const std::exception& e) {
+            log_at(LogLevel::Warn, "Could not fold the delta segments in ", loader_.dir, " into wlist_match1.txt (",
+                   e.what(), "); they are still layered at every load.");
+        }
     }
-    const char required = letters.back();
-    std::vector<std::string> results;
-    results.reserve(dictionary.size());
-    for (const auto& word : dictionary) {
-        if (word.size() < 4) continue;
-        bool illegal = false;
-        for (char c : word) {
-            if (letters.find(c) == std::string::npos) {
-                illegal = true;
-                break;
+
+    // Drains the queued events.
+    Touched read_events() {
+        alignas(inotify_event) char buf[4096];
+        Touched touched;
+        for (;;) {
+            const ssize_t n = read(inotify_fd_, buf, sizeof(buf));
+            if (n <= 0) return touched;
+            for (ssize_t offset = 0; offset < n;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buf + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+                if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) touched.gone = true;
+                if (event->len == 0) continue;
+                const std::string_view name(event->name);
+                touched.lists |= std::find(std::begin(kListFiles), std::end(kListFiles), name) != std::end(kListFiles);
+                touched.segments |= is_delta_segment(name);
             }
         }
-        if (illegal) continue;
-        if (word.find(required) == std::string::npos) continue;
-        if (!contains_vowel(word)) continue;
-        results.push_back(word);
     }
-    return results;
+
+    // Layers the segments on the base of the current snapshot, which keeps its word lists.
+    void apply_segments() {
+        const auto current = loader_.current.load();
+        if (!current) {
+            // The first load is still running and may have read the segments before the change.
+            reload();
+            return;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        size_t changes = 0;
+        try {
+            auto snapshot = std::make_shared<LoadedDictionaries>(*current);
+            snapshot->massive_index =
+                layer_word_changes(current->massive_base, read_word_changes(list_delta_segments(loader_.dir)));
+            changes = snapshot->segment_changes = snapshot->massive_index.changes();
+            loader_.replace(snapshot);
+            log_at(LogLevel::Info, "Applied delta segments from ", loader_.dir, " (", changes, " word changes) in ",
+                   std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(),
+                   " ms");
+            if (changes > kCompactAfterChanges) {
+                auto compacted = std::make_shared<LoadedDictionaries>(*snapshot);
+                compacted->massive_index = compact_word_index(snapshot->massive_index);
+                loader_.replace(std::move(compacted));
+            }
+        } catch (const std::exception& e) {
+            log_at(LogLevel::Warn, "Delta segments in ", loader_.dir, " changed but could not be applied (", e.what(),
+                   "); keeping the current words.");
+            return;
+        }
+        compact_on_disk(changes);
+    }
+
+    void reload() {
+        const auto start = std::chrono::steady_clock::now();
+        size_t changes = 0;
+        try {
+            auto snapshot = load_and_index_dictionaries(loader_.dir);
+            const size_t massive = snapshot->dictionaries->massive_words.size();
+            changes = snapshot->segment_changes;
+            loader_.replace(std::move(snapshot));
+            log_at(LogLevel::Info, "Reloaded word lists from ", loader_.dir, " (massive set size: ", massive, ") in ",
+                   std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(),
+                   " ms");
+        } catch (const std::exception& e) {
+            log_at(LogLevel::Warn, "Word lists in ", loader_.dir, " changed but could not be reloaded (", e.what(),
+                   "); keeping the current ones.");
+            return;
+        }
+        compact_on_disk(changes);
+    }
+
+    DictionaryLoader& loader_;
+    std::shared_future<std::shared_ptr<const LoadedDictionaries>> first_load_;   // the loader's, copied for this thread
+    int inotify_fd_ = -1;
+    int wake_fds_[2] = {-1, -1};
+    std::thread thread_;
+};
+
+static int run_offline_mode(const Config& config, const LoadedDictionaries& loaded) {
+    // One-shot, so any delta segments are folded in up front.
+    const LayeredWordIndex compacted = compact_word_index(loaded.massive_index);
+    const WordIndex& massive_index = *compacted.base;
+    if (config.hints != HintsFormat::None) {
+        const auto grid = build_hint_grid(massive_index, solve_hive(massive_index, config.letters_cli));
+        if (config.hints == HintsFormat::Json) std::cout << hint_grid_json(grid).dump(2) << std::endl;
+        else print_hint_table(grid, std::cout);
+        return 0;
+    }
+    if (!config.check_words_file.empty()) {
+        return run_membership_check(config, *loaded.dictionaries, layered_word_changes(loaded.massive_index));
+    }
+    WordIndex tier_index;
+    const WordIndex* index = &massive_index;
+    if (config.query->tier != "massive") {
+        tier_index = build_word_index(dictionary_tier(*loaded.dictionaries, config.query->tier));
+        index = &tier_index;
+    }
+    WordQueryEngine engine(*index);
+    const auto ids = engine.run(*config.query);
+    for (uint32_t id : ids) std::cout << index->words[id] << '\n';
+    std::cerr << ids.size() << " matching words." << std::endl;
+    return 0;
 }
 
-static fs::path find_default_dictionary_dir() {
-    const std::array<fs::path, 3> candidates = {
-        fs::path("WordListerApp/target/classes/com/uestechnology"),
-        fs::path("WordListerApp/src/main/resources/com/uestechnology"),
-        fs::path("WordListerApp/extracted/com/uestechnology")
+static constexpr const char* kSpellingBeeUrl = "https://www.nytimes.com/puzzles/spelling-bee";
+
+struct LatencyStats {
+    double mean_ms = 0;
+    double p50_ms = 0;
+    double p95_ms = 0;
+};
+
+static LatencyStats summarize_latencies(std::vector<double> samples_ms) {
+    LatencyStats stats;
+    if (samples_ms.empty()) return stats;
+    std::sort(samples_ms.begin(), samples_ms.end());
+    double total = 0;
+    for (double v : samples_ms) total += v;
+    stats.mean_ms = total / static_cast<double>(samples_ms.size());
+    stats.p50_ms = samples_ms[samples_ms.size() / 2];
+    stats.p95_ms = samples_ms[std::min(samples_ms.size() - 1, samples_ms.size() * 95 / 100)];
+    return stats;
+}
+
+// Replies as chromedriver sends them, each with the field the client reads from it.
+struct DecodeBenchCase {
+    const char* name;
+    std::string body;
+    std::vector<std::string_view> path;
+};
+
+static std::vector<DecodeBenchCase> decode_bench_cases() {
+    const std::string element_id = "f.2D4C3A1B6E5F7A8B9C0D1E2F3A4B5C6D.d.9E8F7A6B5C4D3E2F1A0B9C8D7E6F5A4B.e.42";
+    return {
+        {"find_element", std::string(R"({"value":{")") + WD::kElemKey + "\":\"" + element_id + "\"}}",
+         {"value", WD::kElemKey}},
+        {"element_text", R"({"value":"G"})", {"value"}},
+        {"attribute_escaped", R"({"value":"hive-cell center \"g\" \u00e9\ud83d\udc1d"})", {"value"}},
+        {"current_url", R"({"value":"https:\/\/www.nytimes.com\/puzzles\/spelling-bee"})", {"value"}},
+        {"new_session",
+         R"JSON({"value":{"capabilities":{"acceptInsecureCerts":false,"browserName":"chrome","browserVersion":"126.0.6478.126",)JSON"
+         R"JSON("chrome":{"chromedriverVersion":"126.0.6478.126 (d36ace6122e0a59570e258d82441395206d60e1c-refs/branch-heads/6478@{#1591})",)JSON"
+         R"JSON("userDataDir":"/tmp/.org.chromium.Chromium.w2P1kq"},"fedcm:accounts":true,)JSON"
+         R"JSON("goog:chromeOptions":{"debuggerAddress":"localhost:40193"},"networkConnectionEnabled":false,)JSON"
+         R"JSON("pageLoadStrategy":"normal","platformName":"linux","proxy":{},"setWindowRect":true,)JSON"
+         R"JSON("strictFileInteractability":false,"timeouts":{"implicit":0,"pageLoad":300000,"script":30000},)JSON"
+         R"JSON("unhandledPromptBehavior":"dismiss and notify","webauthn:extension:credBlob":true,)JSON"
+         R"JSON("webauthn:extension:largeBlob":true,"webauthn:extension:minPinLength":true,)JSON"
+         R"JSON("webauthn:extension:prf":true,"webauthn:virtualAuthenticators":true},)JSON"
+         R"JSON("sessionId":"8c3f4b7e2d1a9f6e5c4b3a2d1e0f9a8b"}})JSON",
+         {"value", "sessionId"}},
+        {"error_stacktrace",
+         R"JSON({"value":{"error":"stale element reference","message":"stale element reference: stale element )JSON"
+         R"JSON(not found in the current frame\n  (Session info: chrome=126.0.6478.126)",)JSON"
+         R"JSON("stacktrace":"#0 0x55d1c3a0e8da <unknown>\n#1 0x55d1c36f3ae0 <unknown>\n#2 0x55d1c36fb4c7 <unknown>\n)JSON"
+         R"JSON(#3 0x55d1c36fd85c <unknown>\n#4 0x55d1c36fd8e0 <unknown>\n#5 0x55d1c3743f5a <unknown>\n)JSON"
+         R"JSON(#6 0x55d1c3766d22 <unknown>\n#7 0x55d1c373b9b2 <unknown>\n#8 0x55d1c3767e5e <unknown>\n)JSON"
+         R"JSON(#9 0x55d1c3785d6e <unknown>\n#10 0x55d1c3766a93 <unknown>\n#11 0x55d1c373a1b4 <unknown>\n)JSON"
+         R"JSON(#12 0x55d1c373b9de <unknown>\n#13 0x55d1c39d5c4b <unknown>\n#14 0x55d1c39d9b2c <unknown>\n)JSON"
+         R"JSON(#15 0x55d1c39c2355 <unknown>\n#16 0x55d1c39da5d7 <unknown>\n#17 0x55d1c39a4d6f <unknown>\n)JSON"
+         R"JSON(#18 0x55d1c39fe378 <unknown>\n#19 0x55d1c39fe550 <unknown>\n#20 0x55d1c3a0d6cc <unknown>\n)JSON"
+         R"JSON(#21 0x7f1e0f294ac3 <unknown>\n"}})JSON",
+         {"value", "error"}},
     };
-    for (const auto& candidate : candidates) {
-        if (fs::exists(candidate) && fs::is_directory(candidate)) {
-            return candidate;
+}
+
+// Decodes each DecodeBenchCase `iterations` times both ways, checks they agree, and prints
+// ns per decode as JSON.
+static int run_decode_benchmark(const Config& config) {
+    json report = json::array();
+    size_t sink = 0;
+    for (const auto& c : decode_bench_cases()) {
+        auto dom = [&] {
+            const json doc = json::parse(c.body);
+            const json* node = &doc;
+            for (auto key : c.path) node = &node->at(std::string(key));
+            return node->get<std::string>();
+        };
+        auto scan = [&] {
+            std::string out;
+            const auto raw = json_value_at(c.body, c.path.data(), c.path.data() + c.path.size());
+            if (!raw || !json_unescape(raw->substr(1, raw->size() - 2), out)) throw std::runtime_error("scan failed");
+            return out;
+        };
+        if (dom() != scan()) throw std::runtime_error(std::string("decoders disagree on ") + c.name);
+        auto time_ns = [&](auto&& decode) {
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < config.bench_decode_iterations; ++i) sink += decode().size();
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                   config.bench_decode_iterations;
+        };
+        const double dom_ns = time_ns(dom);
+        const double scan_ns = time_ns(scan);
+        report.push_back({{"reply", c.name}, {"bytes", c.body.size()}, {"json_parse_ns", dom_ns},
+                          {"scan_ns", scan_ns}, {"speedup", scan_ns > 0 ? dom_ns / scan_ns : 0.0}});
+    }
+    std::cout << json{{"iterations", config.bench_decode_iterations}, {"replies", report}}.dump(2) << std::endl;
+    return sink == 0;   // never true; keeps the decodes from being optimized away
+}
+
+// ---------- Micro-benchmarks ----------
+// --bench times the hot paths that do not need a browser. Each benchmark runs once to warm
+// up, then in growing batches until one batch takes kMicroBenchMinTime; that batch is
+// reported together with the allocations it made.
+static constexpr size_t kDefaultBenchWords = 200000;
+static constexpr auto kMicroBenchMinTime = 200ms;
+static constexpr const char* kBenchHives[] = {"taegnil", "mopcrae", "ybdlnoa", "hutirsk"};
+static volatile size_t g_bench_sink = 0;
+
+template <typename Op>
+static json run_micro_bench(const char* name, size_t items_per_op, const char* item, Op&& op) {
+    size_t sink = op();
+    for (uint64_t iterations = 1;;) {
+        const AllocSnapshot before = AllocSnapshot::now();
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) sink += op();
+        const double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        const AllocSnapshot after = AllocSnapshot::now();
+        const double min_ns = std::chrono::duration<double, std::nano>(kMicroBenchMinTime).count();
+        if (elapsed_ns >= min_ns) {
+            g_bench_sink = g_bench_sink + sink;
+            const double ns_per_op = elapsed_ns / iterations;
+            return {{"name", name},
+                    {"iterations", iterations},
+                    {"ns_per_op", ns_per_op},
+                    {"allocs_per_op", static_cast<double>(after.count - before.count) / iterations},
+                    {"alloc_bytes_per_op", static_cast<double>(after.bytes - before.bytes) / iterations},
+                    {"items_per_op", items_per_op},
+                    {"item", item},
+                    {"items_per_s", items_per_op * 1e9 / ns_per_op}};
         }
+        const double scale = elapsed_ns > 0 ? std::min(10.0, 1.2 * min_ns / elapsed_ns) : 10.0;
+        iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * scale));
     }
-    return {};
 }
 
-static void dump_cell_debug(const std::vector<std::tuple<char, bool, std::string, std::string>>& cells) {
-    std::cerr << "[DEBUG] Hive cell attributes:\n";
-    for (size_t idx = 0; idx < cells.size(); ++idx) {
-        const auto& [letter, is_center, classes, aria] = cells[idx];
-        std::cerr << "  #" << (idx + 1) << " letter='" << letter
-                  << "' center=" << (is_center ? "true" : "false")
-                  << " classes='" << classes << "' aria='" << aria << "'\n";
+// Allocation budgets --bench enforces: a fixed allowance per call plus one per item. The
+// solve is budgeted per word found, so allocating per dictionary word fails the run; a
+// payload or reply that starts costing more allocations per key or reply fails it too.
+struct AllocBudget {
+    const char* phase;
+    const char* item;
+    double per_item;
+    double fixed;
+};
+
+static constexpr AllocBudget kLoadAllocBudget{"load", "words", 2, 256};
+static constexpr AllocBudget kSolveAllocBudget{"solve", "words found", 0, 64};
+static constexpr AllocBudget kPayloadAllocBudget{"payload", "keys", 0, 64};     // one growing buffer
+static constexpr AllocBudget kResponseAllocBudget{"response", "replies", 2, 0};
+
+// Runs `op` once to warm up, then once counted; `op` returns the number of items it handled.
+template <typename Op>
+static json check_alloc_budget(const AllocBudget& budget, const std::string& detail, Op&& op) {
+    (void)op();
+    const AllocSnapshot before = AllocSnapshot::now();
+    const size_t items = op();
+    const AllocSnapshot after = AllocSnapshot::now();
+    const uint64_t allocs = after.count - before.count;
+    const double limit = budget.fixed + budget.per_item * static_cast<double>(items);
+    return {{"phase", budget.phase}, {"detail", detail}, {"allocs", allocs}, {"items", items},
+            {"item", budget.item}, {"budget", limit}, {"ok", static_cast<double>(allocs) <= limit}};
+}
+
+// Uses the real lists when all five are in the dictionary directory and --bench-words is
+// not given; otherwise writes synthetic ones to a scratch directory first.
+static int run_micro_benchmarks(const Config& config) {
+    const bool real = config.bench_words == 0 && !config.dictionary_dir.empty() &&
+                      std::all_of(std::begin(kListFiles), std::end(kListFiles),
+                                  [&](const char* f) { return fs::is_regular_file(config.dictionary_dir / f); });
+    std::optional<ScratchDir> scratch;
+    fs::path dir = config.dictionary_dir;
+    if (!real) {
+        scratch.emplace("spellingbee-bench-");
+        dir = scratch->path;
+        write_synthetic_dictionaries(dir, config.bench_words ? config.bench_words : kDefaultBenchWords,
+                                     config.synthetic);
+    }
+
+    const WordDictionaries dictionaries = load_word_dictionaries(dir);
+    const WordIndex index = build_word_index(dictionaries.massive_words);
+    const size_t listed = dictionaries.short_words.size() + dictionaries.medium_words.size() +
+                          dictionaries.extended_words.size() + dictionaries.massive_words.size();
+    std::vector<std::string> payload_words(index.words.begin(),
+                                           index.words.begin() + std::min<size_t>(1000, index.size()));
+
+    json results = json::array();
+    results.push_back(run_micro_bench("normalize_letters", 1, "calls", [] { return normalize_letters("  TaEg NiL ").size(); }));
+    results.push_back(run_micro_bench("letter_mask", index.size(), "words", [&] {
+        uint32_t acc = 0;
+        for (const auto& w : index.words) acc ^= letter_mask(w);
+        return static_cast<size_t>(acc);
+    }));
+    results.push_back(run_micro_bench("load_word_file", dictionaries.massive_words.size(), "words", [&] {
+        std::set<std::string> words;
+        load_word_file(dir / "wlist_match1.txt", words);
+        return words.size();
+    }));
+    results.push_back(run_micro_bench("load_word_dictionaries", listed, "words",
+                                      [&] { return load_word_dictionaries(dir).massive_words.size(); }));
+    results.push_back(run_micro_bench("build_word_index", index.size(), "words",
+                                      [&] { return build_word_index(dictionaries.massive_words).size(); }));
+    results.push_back(run_micro_bench("find_valid_words", index.size() * std::size(kBenchHives), "words", [&] {
+        size_t found = 0;
+        for (const char* hive : kBenchHives) found += find_valid_words(index, hive).size();
+        return found;
+    }));
+    results.push_back(run_micro_bench("actions_payload", payload_words.size(), "words", [&] {
+        std::string payload;
+        append_actions_payload(payload, payload_words.begin(), payload_words.end());
+        return payload.size();
+    }));
+
+    json budgets = json::array();
+    budgets.push_back(check_alloc_budget(kLoadAllocBudget, "", [&] {
+        const WordDictionaries loaded = load_word_dictionaries(dir);
+        return loaded.short_words.size() + loaded.medium_words.size() + loaded.extended_words.size() +
+               loaded.massive_words.size();
+    }));
+    for (const char* hive : kBenchHives) {
+        budgets.push_back(check_alloc_budget(kSolveAllocBudget, hive, [&] { return solve_hive(index, hive).word_ids.size(); }));
+    }
+    budgets.push_back(check_alloc_budget(kPayloadAllocBudget, "", [&] {
+        size_t keys = 0;
+        for (const auto& w : payload_words) keys += w.size() + 1;   // each word ends with Enter
+        std::string payload;   // fresh each time, so its growth is counted
+        append_actions_payload(payload, payload_words.begin(), payload_words.end());
+        g_bench_sink = g_bench_sink + payload.size();
+        return keys;
+    }));
+    std::vector<std::pair<HttpResponse, std::vector<std::string_view>>> replies;
+    for (const auto& c : decode_bench_cases()) replies.push_back({HttpResponse{200, c.body}, c.path});
+    budgets.push_back(check_alloc_budget(kResponseAllocBudget, "", [&] {
+        const std::string url = "http://127.0.0.1/session";
+        for (const auto& [resp, path] : replies) {
+            g_bench_sink = g_bench_sink + reply_string(resp, url, path.data(), path.data() + path.size()).size();
+        }
+        return replies.size();
+    }));
+
+    std::cout << json{{"dictionary", {{"source", real ? "real" : "synthetic"},
+                                      {"dir", real ? dir.string() : ""},
+                                      {"words", index.size()}}},
+                      {"benchmarks", results},
+                      {"alloc_budgets", budgets}}.dump(2)
+              << std::endl;
+    int rc = 0;
+    for (const auto& b : budgets) {
+        if (b["ok"].get<bool>()) continue;
+        std::cerr << "[FAIL] " << b["phase"].get<std::string>() << (b["detail"].get<std::string>().empty() ? "" : " ")
+                  << b["detail"].get<std::string>() << ": " << b["allocs"].get<uint64_t>() << " allocations for "
+                  << b["items"].get<size_t>() << " " << b["item"].get<std::string>() << ", budget "
+                  << b["budget"].get<double>() << "\n";
+        rc = 1;
     }
+    return rc;
 }
 
-static std::string read_letters_from_board(WD& wd) {
-    std::vector<std::tuple<char, bool, std::string, std::string>> cells;
-    cells.reserve(7);
-    for (int idx = 1; idx <= 7; ++idx) {
-        std::ostringstream css;
-        css << ".hive-cell:nth-child(" << idx << ")";
-        const auto cell_id = wd.find_element_id_css(css.str());
-        auto text = trim_copy(wd.get_element_text(cell_id));
-        if (text.empty()) {
-            std::ostringstream oss;
-            oss << "no letter found for hive cell " << idx;
-            throw std::runtime_error(oss.str());
-        }
-        char letter = text.front();
-        if (!std::isalpha(static_cast<unsigned char>(letter))) {
-            std::ostringstream oss;
-            oss << "unexpected hive character '" << letter << "' at cell " << idx;
-            throw std::runtime_error(oss.str());
-        }
-        char normalized = static_cast<char>(std::tolower(static_cast<unsigned char>(letter)));
-        auto classes = to_lower_copy(wd.get_element_attribute(cell_id, "class"));
-        auto aria = to_lower_copy(wd.get_element_attribute(cell_id, "aria-label"));
+// ---------- Scaling stress ----------
+// --stress generates a synthetic dictionary of each size, then loads, indexes and solves
+// it in a forked child. Each size starts from a clean heap, so RSS is its own, and a size
+// that runs out of memory is reported instead of ending the run.
 
-        bool is_center = false;
-        if (!classes.empty()) {
-            if (has_class_token(classes, "hive-cell--center") ||
-                has_class_token(classes, "hive-cell_center") ||
-                has_class_token(classes, "is-center") ||
-                (has_class_token(classes, "center") && !has_class_token(classes, "outer"))) {
-                is_center = true;
-            }
-        }
-        if (!is_center && !aria.empty()) {
-            if (aria.find("center letter") != std::string::npos || aria == "center") {
-                is_center = true;
-            }
-        }
+// VmRSS and VmHWM from /proc/self/status in KiB; zero where unavailable.
+struct RssSample {
+    uint64_t rss_kib = 0;
+    uint64_t peak_kib = 0;
 
-        cells.emplace_back(normalized, is_center, std::move(classes), std::move(aria));
+    static RssSample now() {
+        RssSample sample;
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.rfind("VmRSS:", 0) == 0) sample.rss_kib = std::strtoull(line.c_str() + 6, nullptr, 10);
+            else if (line.rfind("VmHWM:", 0) == 0) sample.peak_kib = std::strtoull(line.c_str() + 6, nullptr, 10);
+        }
+        return sample;
     }
+};
 
-    if (cells.size() != 7) {
-        std::ostringstream oss;
-        oss << "expected 7 hive cells but collected " << cells.size();
-        throw std::runtime_error(oss.str());
+static json stress_one_size(const fs::path& dir) {
+    using clock = std::chrono::steady_clock;
+    auto seconds = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+    const AllocSnapshot allocs_before = AllocSnapshot::now();
+    const auto load_start = clock::now();
+    const WordDictionaries dictionaries = load_word_dictionaries(dir);
+    const auto load_end = clock::now();
+    const AllocSnapshot allocs_loaded = AllocSnapshot::now();
+    const RssSample loaded = RssSample::now();
+    const WordIndex index = build_word_index(dictionaries.massive_words);
+    const auto index_end = clock::now();
+
+    double solve_total_ms = 0, solve_max_ms = 0;
+    size_t solutions = 0;
+    for (const char* hive : kBenchHives) {
+        const auto start = clock::now();
+        solutions += solve_hive(index, hive).word_ids.size();
+        const double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        solve_total_ms += ms;
+        solve_max_ms = std::max(solve_max_ms, ms);
     }
+    const RssSample end = RssSample::now();
+    return {{"listed_words", dictionaries.short_words.size() + dictionaries.medium_words.size() +
+                                 dictionaries.extended_words.size() + dictionaries.massive_words.size()},
+            {"massive_words", index.size()},
+            {"load_s", seconds(load_end - load_start)},
+            {"load_allocs", allocs_loaded.count - allocs_before.count},
+            {"index_s", seconds(index_end - load_end)},
+            {"rss_loaded_mib", loaded.rss_kib / 1024.0},
+            {"peak_rss_mib", end.peak_kib / 1024.0},
+            {"solve_ms_mean", solve_total_ms / std::size(kBenchHives)},
+            {"solve_ms_max", solve_max_ms},
+            {"solutions", solutions}};
+}
 
-    std::size_t center_count = 0;
-    for (const auto& cell : cells) {
-        if (std::get<1>(cell)) ++center_count;
+// Runs stress_one_size in a child and returns its report, or an "error" entry when the
+// child failed or was killed (typically by the OOM killer).
+static json stress_in_child(const fs::path& dir) {
+    int fds[2];
+    if (pipe(fds) != 0) throw std::system_error(errno, std::generic_category(), "pipe");
+    std::cout.flush();
+    std::cerr.flush();
+    const pid_t pid = fork();
+    if (pid < 0) throw std::system_error(errno, std::generic_category(), "fork");
+    if (pid == 0) {
+        close(fds[0]);
+        std::string out;
+        int status = 0;
+        try {
+            out = stress_one_size(dir).dump();
+        } catch (const std::exception& e) {
+            out = json{{"error", e.what()}}.dump();
+            status = 1;
+        }
+        for (size_t sent = 0; sent < out.size();) {
+            const ssize_t n = write(fds[1], out.data() + sent, out.size() - sent);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            sent += static_cast<size_t>(n);
+        }
+        _exit(status);
     }
-    if (center_count == 0) {
-        std::cerr << "[WARN] No center marker found in hive; falling back to nth-child(4)\n";
-        dump_cell_debug(cells);
-        std::get<1>(cells.at(3)) = true;
-        center_count = 1;
+    close(fds[1]);
+    std::string reply;
+    char buf[4096];
+    for (;;) {
+        const ssize_t n = read(fds[0], buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        reply.append(buf, static_cast<size_t>(n));
     }
-    if (center_count > 1) {
-        dump_cell_debug(cells);
-        throw std::runtime_error("multiple hive cells reported as center");
+    close(fds[0]);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
     }
+    if (WIFSIGNALED(status)) return {{"error", "killed by signal " + std::to_string(WTERMSIG(status))}};
+    json report = json::parse(reply, nullptr, false);
+    if (report.is_discarded()) return {{"error", "child exited with status " + std::to_string(WEXITSTATUS(status))}};
+    return report;
+}
 
-    char center_letter = '\0';
-    std::string letters;
-    letters.reserve(7);
-    for (const auto& cell : cells) {
-        char c = std::get<0>(cell);
-        if (std::get<1>(cell)) {
-            if (center_letter != '\0' && center_letter != c) {
-                dump_cell_debug(cells);
-                std::ostringstream oss;
-                oss << "multiple differing center letters detected (" << center_letter << " vs " << c << ")";
-                throw std::runtime_error(oss.str());
-            }
-            center_letter = c;
-        } else {
-            letters.push_back(c);
+// Stops at the first size that fails, since larger ones would fail the same way.
+static int run_stress(const Config& config) {
+    json sizes = json::array();
+    int rc = 0;
+    for (uint64_t words : config.stress_sizes) {
+        ScratchDir scratch("spellingbee-stress-");
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t bytes = write_synthetic_dictionaries(scratch.path, words, config.synthetic);
+        json entry = {{"words", words},
+                      {"list_mib", bytes / (1024.0 * 1024.0)},
+                      {"generate_s", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()}};
+        std::cerr << "stress: " << words << " words generated, loading" << std::endl;
+        entry.update(stress_in_child(scratch.path));
+        sizes.push_back(entry);
+        if (entry.contains("error")) {
+            std::cerr << "stress: " << words << " words failed: " << entry["error"].get<std::string>() << std::endl;
+            rc = 1;
+            break;
         }
     }
-    if (center_letter == '\0') {
-        dump_cell_debug(cells);
-        throw std::runtime_error("could not determine center hive letter after processing");
+    std::cout << json{{"hives", kBenchHives}, {"sizes", sizes}}.dump(2) << std::endl;
+    return rc;
+}
+
+// Writes --synthetic-words words to --generate-dictionaries for trying the solver at scale.
+static int run_generate_dictionaries(const Config& config) {
+    fs::create_directories(config.generate_dir);
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t bytes = write_synthetic_dictionaries(config.generate_dir, config.synthetic_words, config.synthetic);
+    std::cerr << "Wrote " << config.synthetic_words << " synthetic words (" << bytes / (1024 * 1024) << " MiB across "
+              << std::size(kListFiles) << " files) to " << config.generate_dir.string() << " in " << std::fixed
+              << std::setprecision(1) << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+              << "s" << std::endl;
+    return 0;
+}
+
+// Times the 21-request board read through the blocking client and through the curl_multi
+// client against WEBDRIVER_URL, and prints a JSON report including how many TCP
+// connections each client had to open.
+static int run_webdriver_benchmark(const Config& config) {
+    CurlSession curl;
+    WD wd(curl);
+    if (const char* url = std::getenv("WEBDRIVER_URL"); url && *url) {
+        wd.base = url;
     }
-    if (letters.size() != 6) {
-        dump_cell_debug(cells);
-        std::ostringstream oss;
-        oss << "expected 6 outer hive letters but collected " << letters.size();
-        throw std::runtime_error(oss.str());
+    AsyncCurlClient async_client;
+    AsyncWD async_wd(wd, async_client);
+    wd.new_session();
+    try {
+        wd.navigate(kSpellingBeeUrl);
+        auto time_reads = [&](auto&& read) {
+            std::vector<double> samples;
+            for (int i = 0; i < config.bench_webdriver_iterations; ++i) {
+                const auto start = std::chrono::steady_clock::now();
+                read();
+                samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+            return summarize_latencies(std::move(samples));
+        };
+        const size_t sync_requests_before = wd.cs->request_count;
+        const size_t sync_connects_before = wd.cs->connections_opened;
+        const auto sync_stats = time_reads([&] { read_letters_from_board(wd); });
+        const auto async_stats = time_reads([&] { read_letters_from_board(async_wd); });
+        auto report = [](const LatencyStats& stats, size_t requests, size_t connections) {
+            return json{{"mean_ms", stats.mean_ms}, {"p50_ms", stats.p50_ms}, {"p95_ms", stats.p95_ms},
+                        {"requests", requests}, {"connections_opened", connections}};
+        };
+        std::cout << json{{"iterations", config.bench_webdriver_iterations},
+                          {"webdriver", wd.base},
+                          {"blocking", report(sync_stats, wd.cs->request_count - sync_requests_before,
+                                              wd.cs->connections_opened - sync_connects_before)},
+                          {"concurrent", report(async_stats, async_client.request_count.load(),
+                                                async_client.connections_opened.load())}}.dump(2)
+                  << std::endl;
+    } catch (...) {
+        try { wd.delete_session(); } catch (...) {}
+        throw;
     }
-    letters.push_back(center_letter);
-    return letters;
+    wd.delete_session();
+    return 0;
 }
 
-enum class StopAction { Prompt, Keep, Rerun };
-
-struct Config {
-    StopAction stop_action = StopAction::Rerun;
-    std::string letters_cli;
-    fs::path dictionary_dir;
+// Deterministic stand-in for a solved word list: 4-9 letters drawn from one hive.
+static std::vector<std::string> synthetic_words(int count) {
+    static constexpr char kHive[] = "TAEGNIL";
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> length(4, 9);
+    std::uniform_int_distribution<int> letter(0, 6);
+    std::vector<std::string> words;
+    std::set<std::string> seen;   // distinct, like a real answer list
+    words.reserve(static_cast<size_t>(count));
+    while (words.size() < static_cast<size_t>(count)) {
+        std::string word(static_cast<size_t>(length(rng)), 'L');
+        for (size_t k = 1; k < word.size(); ++k) word[k] = kHive[letter(rng)];
+        if (seen.insert(word).second) words.push_back(std::move(word));
+    }
+    return words;
+}
 
-    bool has_cli_letters() const { return !letters_cli.empty(); }
-};
+// ---------- Submit calibration ----------
+// Blank page that records the keyboard input actually reaching it: keydown letters
+// accumulate until Enter, the way the puzzle's own handler reads them. Every entered word
+// also goes into a found-word list marked up like the puzzle's, which the paced strategy
+// checks against.
+static constexpr const char* kCalibrationPage =
+    "<!doctype html><title>spellingbee calibration</title><body tabindex=\"0\">"
+    "<ul class=\"sb-wordlist-items-pag\"></ul><script>"
+    "window.__sbCalibration = {typed: [], current: ''};"
+    "document.addEventListener('keydown', function (e) {"
+    "  var c = window.__sbCalibration;"
+    "  if (e.key === 'Enter') {"
+    "    c.typed.push(c.current);"
+    "    var item = document.createElement('li'), word = document.createElement('span');"
+    "    word.className = 'sb-anagram'; word.textContent = c.current.toLowerCase();"
+    "    item.appendChild(word); document.querySelector('.sb-wordlist-items-pag').appendChild(item);"
+    "    c.current = '';"
+    "  } else if (e.key.length === 1) { c.current += e.key.toUpperCase(); }"
+    "});"
+    "document.body.focus();"
+    "</script></body>";
+static constexpr const char* kCalibrationReadbackScript =
+    "return window.__sbCalibration ? window.__sbCalibration.typed : null;";
 
-static void print_usage(const char* prog) {
-    std::cout << "Usage: " << prog << " [options]\n"
-              << "Options:\n"
-              << "  --stop-action=prompt|keep|rerun  Control what happens after the run stops.\n"
-              << "  --keep-open-on-stop              Shortcut for --stop-action=keep.\n"
-              << "  --rerun-on-stop                  Shortcut for --stop-action=rerun.\n"
-              << "  --letters=ABCDEFg                Supply hive letters (center letter last).\n"
-              << "  --dictionary-dir=PATH           Override word list directory.\n"
-              << "  -h, --help                       Show this help message.\n";
-}
+struct CalibrationResult {
+    std::string strategy;
+    double ms = 0;
+    double words_per_s = 0;
+    size_t messages = 0;
+    size_t words_intact = 0;
+    double dropped_keystroke_rate = 1.0;
+    std::string error;
 
-static Config parse_args(int argc, char** argv) {
-    Config cfg;
-    cfg.dictionary_dir = find_default_dictionary_dir();
-    const std::string stop_prefix = "--stop-action=";
-    const std::string letters_prefix = "--letters=";
-    const std::string dict_prefix = "--dictionary-dir=";
+    bool reliable(size_t words) const { return error.empty() && words_intact == words; }
+};
 
-    for (int i = 1; i < argc; ++i) {
-        std::string arg = argv[i];
-        if (arg == "--help" || arg == "-h") {
-            print_usage(argv[0]);
-            std::exit(0);
-        }
+static CalibrationResult calibrate_strategy(WD& wd, const std::string& spec, const std::string& page_url,
+                                            const std::vector<std::string>& words_upper) {
+    CalibrationResult result;
+    result.strategy = spec;
+    try {
+        wd.navigate(page_url);   // a fresh page starts with an empty record
+        const auto submitter = make_word_submitter(spec);
+        const auto start = std::chrono::steady_clock::now();
+        result.messages = submitter->submit(wd, words_upper);
+        result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.words_per_s = result.ms > 0 ? words_upper.size() * 1000.0 / result.ms : 0.0;
 
-        if (arg.rfind(stop_prefix, 0) == 0) {
-            std::string value = arg.substr(stop_prefix.size());
-            if (value == "prompt") {
-                cfg.stop_action = StopAction::Prompt;
-            } else if (value == "keep") {
-                cfg.stop_action = StopAction::Keep;
-            } else if (value == "rerun") {
-                cfg.stop_action = StopAction::Rerun;
-            } else {
-                std::cerr << "Unknown stop action: " << value << "\n";
-                print_usage(argv[0]);
-                std::exit(1);
+        const json typed = wd.execute_script(kCalibrationReadbackScript);
+        if (!typed.is_array()) throw std::runtime_error("calibration page did not load");
+        std::multiset<std::string> expected(words_upper.begin(), words_upper.end());
+        size_t keys_sent = 0;
+        size_t keys_seen = 0;
+        for (const auto& word : words_upper) keys_sent += word.size() + 1;
+        for (const auto& entry : typed) {
+            const auto word = entry.get<std::string>();
+            keys_seen += word.size() + 1;
+            if (auto it = expected.find(word); it != expected.end()) {
+                expected.erase(it);
+                ++result.words_intact;
             }
-            continue;
         }
+        result.dropped_keystroke_rate = keys_sent ? 1.0 - std::min(1.0, static_cast<double>(keys_seen) / keys_sent) : 0.0;
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    return result;
+}
 
-        if (arg == "--keep-open-on-stop") {
-            cfg.stop_action = StopAction::Keep;
-            continue;
-        }
-        if (arg == "--rerun-on-stop") {
-            cfg.stop_action = StopAction::Rerun;
-            continue;
-        }
+static std::optional<std::string> load_calibrated_strategy(const fs::path& path) {
+    std::ifstream in(path);
+    if (!in) return std::nullopt;
+    const json saved = json::parse(in, nullptr, false);
+    if (!saved.is_object()) return std::nullopt;
+    const auto spec = saved.value("strategy", std::string());
+    if (!make_word_submitter(spec)) return std::nullopt;
+    if (is_devtools_strategy(spec) && !curl_supports_websockets()) return std::nullopt;
+    return spec;
+}
 
-        if (arg == "--letters") {
-            if (i + 1 >= argc) {
-                std::cerr << "--letters requires a value\n";
-                print_usage(argv[0]);
-                std::exit(1);
-            }
-            cfg.letters_cli = normalize_letters(argv[++i]);
-            continue;
-        }
-        if (arg.rfind(letters_prefix, 0) == 0) {
-            cfg.letters_cli = normalize_letters(arg.substr(letters_prefix.size()));
-            continue;
-        }
+// Types the same synthetic list through every strategy on the recording page against
+// WEBDRIVER_URL (tools/mock_chromedriver.py works too), prints a JSON report and saves the
+// fastest strategy that delivered every word intact.
+static int run_submit_calibration(const Config& config) {
+    CurlSession curl;
+    WD wd(curl);
+    if (const char* url = std::getenv("WEBDRIVER_URL"); url && *url) {
+        wd.base = url;
+    }
+    const auto words = synthetic_words(config.calibrate_submit_words);
+    std::string page_url = "data:text/html,";
+    if (char* escaped = curl_easy_escape(curl.curl, kCalibrationPage, 0)) {
+        page_url += escaped;
+        curl_free(escaped);
+    }
 
-        if (arg == "--dictionary-dir") {
-            if (i + 1 >= argc) {
-                std::cerr << "--dictionary-dir requires a path\n";
-                print_usage(argv[0]);
-                std::exit(1);
-            }
-            cfg.dictionary_dir = fs::path(argv[++i]);
-            continue;
-        }
-        if (arg.rfind(dict_prefix, 0) == 0) {
-            cfg.dictionary_dir = fs::path(arg.substr(dict_prefix.size()));
-            continue;
+    std::vector<CalibrationResult> results;
+    wd.new_session();
+    try {
+        const bool websockets = curl_supports_websockets();
+        for (const char* spec : kSubmitStrategies) {
+            if (is_devtools_strategy(spec) && !websockets) continue;
+            results.push_back(calibrate_strategy(wd, spec, page_url, words));
         }
-
-        std::cerr << "Unknown argument: " << arg << "\n";
-        print_usage(argv[0]);
-        std::exit(1);
+    } catch (...) {
+        try { wd.delete_session(); } catch (...) {}
+        throw;
     }
+    wd.delete_session();
 
-    if (!cfg.letters_cli.empty() && cfg.letters_cli.size() != 7) {
-        std::cerr << "letters must contain exactly 7 alphabetic characters (center letter last)\n";
-        std::exit(1);
+    const CalibrationResult* best = nullptr;
+    json report = json::array();
+    for (const auto& r : results) {
+        json entry = {{"strategy", r.strategy}, {"ms", r.ms}, {"words_per_s", r.words_per_s},
+                      {"messages", r.messages}, {"words_intact", r.words_intact},
+                      {"dropped_keystroke_rate", r.dropped_keystroke_rate}, {"reliable", r.reliable(words.size())}};
+        if (!r.error.empty()) entry["error"] = r.error;
+        report.push_back(std::move(entry));
+        if (r.reliable(words.size()) && (!best || r.words_per_s > best->words_per_s)) best = &r;
+    }
+    std::cout << json{{"words", words.size()}, {"webdriver", wd.base}, {"strategies", report},
+                      {"selected", best ? json(best->strategy) : json()}}.dump(2)
+              << std::endl;
+    if (!best) {
+        log_at(LogLevel::Warn, "No strategy delivered every word intact; nothing saved.");
+        return 1;
     }
 
-    return cfg;
+    const fs::path& path = config.submit_calibration_file;
+    std::error_code ec;
+    if (path.has_parent_path()) fs::create_directories(path.parent_path(), ec);
+    std::ofstream out(path, std::ios::trunc);
+    out << json{{"strategy", best->strategy}, {"words_per_s", best->words_per_s},
+                {"calibrated_words", words.size()}, {"webdriver", wd.base}}.dump() << "\n";
+    if (!out) {
+        log_at(LogLevel::Warn, "Could not save calibration to ", path);
+        return 1;
+    }
+    std::cerr << "Saved '" << best->strategy << "' to " << path << "\n";
+    return 0;
 }
 
 struct AttemptResult {
@@ -523,26 +5052,78 @@ struct AttemptResult {
     bool user_quit = false;
     bool fatal_error = false;
     std::string fatal_message;
+    bool cancelled = false;   // Ctrl-C; the browser is left as it is
+    uint32_t projected_score = 0;
 };
 
-static AttemptResult run_attempt(WD& wd,
-                                 bool have_session,
-                                 bool do_full_setup,
-                                 int attempt_index,
-                                 const Config& config,
-                                 const WordDictionaries& dictionaries) {
+struct PreparedWords {
+    HiveSolution solution;
+    std::vector<std::string> words_upper;
+    std::vector<std::string> pangrams_upper;
+};
+
+// Waits for the dictionaries if they are still loading, then solves.
+static PreparedWords prepare_words(DictionaryLoader& dictionaries, const std::string& letters_lower) {
+    // Always on a step thread of its own, and it may overlap the browser steps.
+    t_trace_track = TraceLog::kSolveTrack;
+    TraceSpan span("solve", "step", {{"letters", letters_lower}});
+    const auto snapshot = dictionaries.get();   // kept until the words are copied out
+    const LayeredWordIndex& index = snapshot->massive_index;
+    PreparedWords prepared;
+    prepared.solution = solve_hive(index, letters_lower);
+    prepared.words_upper.reserve(prepared.solution.word_ids.size());
+    for (uint32_t id : prepared.solution.word_ids) {
+        auto word = index.word(id);
+        to_upper_inplace(word);
+        prepared.words_upper.push_back(std::move(word));
+    }
+    for (uint32_t id : prepared.solution.score.pangram_ids) {
+        auto pangram = index.word(id);
+        to_upper_inplace(pangram);
+        prepared.pangrams_upper.push_back(std::move(pangram));
+    }
+    return prepared;
+}
+
+static void print_prepared_words(const std::string& letters_lower, const PreparedWords& prepared) {
+    std::string outer_letters = letters_lower.substr(0, letters_lower.size() - 1);
+    std::string center_letter(1, static_cast<char>(std::toupper(static_cast<unsigned char>(letters_lower.back()))));
+    std::string outer_upper = outer_letters;
+    to_upper_inplace(outer_upper);
+    std::cout << "Letters: " << outer_upper << " (center " << center_letter << ")\n";
+    std::cout << "Generated " << prepared.words_upper.size() << " candidate words.\n";
+    std::cout << "Projected max score: " << prepared.solution.score.max_score
+              << " (" << prepared.pangrams_upper.size() << " pangrams";
+    for (size_t i = 0; i < prepared.pangrams_upper.size(); ++i) {
+        std::cout << (i == 0 ? ": " : ", ") << prepared.pangrams_upper[i];
+    }
+    std::cout << ")\n";
+}
+
+static Task<AttemptResult> attempt_workflow(Scheduler& sched,
+                                            WD& wd,
+                                            AsyncWD* async_wd,
+                                            bool have_session,
+                                            bool do_full_setup,
+                                            int attempt_index,
+                                            const Config& config,
+                                            DictionaryLoader& dictionaries) {
     AttemptResult result;
+    const StepPolicies policies;
     bool quit = false;
     bool session_active = have_session;
-    std::vector<std::string> words_upper;
     std::string letters_lower;
+    std::optional<PreparedWords> prepared;
+    auto stop_on = [&](StepResult r) {
+        if (r == StepResult::QUIT) quit = true;
+        if (r == StepResult::CANCELLED) result.cancelled = quit = true;
+    };
 
     try {
         if (!session_active) {
-            auto r = retry_with_pause("start session", [&] { wd.new_session(); });
-            if (r == StepResult::QUIT) {
-                quit = true;
-            } else if (r == StepResult::OK) {
+            auto r = co_await retry_with_pause(sched, "start session", policies.session, [&] { wd.new_session(); });
+            stop_on(r);
+            if (r == StepResult::OK) {
                 session_active = true;
                 do_full_setup = true;
             }
@@ -550,147 +5131,281 @@ static AttemptResult run_attempt(WD& wd,
 
         if (!session_active) {
             result.session_active = false;
-            result.user_quit = quit;
-            return result;
+            result.user_quit = quit && !result.cancelled;
+            co_return result;
+        }
+
+        // With letters from the command line, loading and solving don't depend on the
+        // browser at all: run them alongside navigation and the ready prompt.
+        std::optional<BackgroundStep<PreparedWords>> early_solve;
+        if (!quit && config.has_cli_letters()) {
+            early_solve.emplace(sched.start(policies.solve, [&] { return prepare_words(dictionaries, config.letters_cli); }));
         }
 
         if (!quit && do_full_setup) {
-            auto r = retry_with_pause("navigate", [&] { wd.navigate("https://www.nytimes.com/puzzles/spelling-bee"); });
-            if (r == StepResult::QUIT) quit = true;
+            stop_on(co_await retry_with_pause(sched, "navigate", policies.navigate, [&] { wd.navigate(kSpellingBeeUrl); }));
         }
 
         if (!quit && do_full_setup) {
-            auto r = retry_with_pause("resize window", [&] { wd.set_window_size(1680, 939); });
-            if (r == StepResult::QUIT) quit = true;
+            stop_on(co_await retry_with_pause(sched, "resize window", policies.resize, [&] { wd.set_window_size(1680, 939); }));
         }
 
         if (!quit) {
             if (do_full_setup) {
-                pause_banner("Browser ready? Clear modals/login, then press Enter to begin.");
-                (void)prompt_line("> ");
+                bool ready = false;
+                if (config.ready_timeout.count() > 0) {
+                    ready = co_await sched.start(config.ready_timeout + policies.ready_slack, [&] {
+                        TraceSpan span("wait for board", "step");
+                        return wait_for_board_ready(wd, config.ready_timeout);
+                    });
+                }
+                if (!ready && !g_cancel_requested) {
+                    if (config.ready_timeout.count() > 0) {
+                        log_at(LogLevel::Warn, "Board not ready after ", config.ready_timeout.count() / 1000, "s; asking instead.");
+                    }
+                    pause_banner("Browser ready? Clear modals/login, then press Enter to begin.");
+                    (void)prompt_line("> ");
+                }
+                if (g_cancel_requested) result.cancelled = quit = true;
             } else {
                 std::cout << "\n--- Restarting word list (attempt " << attempt_index << ") ---\n";
             }
         }
 
         if (!quit) {
-            auto r = retry_with_pause("focus hive", [&] {
+            stop_on(co_await retry_with_pause(sched, "focus hive", policies.focus, [&] {
                 auto focusId = wd.find_element_id_css(".hive-cell:nth-child(4)");
                 wd.click_element(focusId);
-            });
-            if (r == StepResult::QUIT) quit = true;
+            }));
         }
 
         if (!quit) {
             if (config.has_cli_letters()) {
                 letters_lower = config.letters_cli;
             } else {
-                auto r = retry_with_pause("read hive letters", [&] {
-                    letters_lower = read_letters_from_board(wd);
+                auto r = co_await retry_with_pause(sched, "read hive letters", policies.read_letters, [&] {
+                    PhaseTimer timer("board_read", async_wd ? "async" : "blocking");
+                    letters_lower = async_wd ? read_letters_from_board(*async_wd) : read_letters_from_board(wd);
                 });
-                if (r == StepResult::QUIT) quit = true;
-                else if (r == StepResult::SKIP) quit = true;
+                stop_on(r);
+                if (r == StepResult::SKIP) quit = true;
             }
         }
 
+        if (early_solve) {
+            // Always collected, even when quitting, so the worker never outlives this frame.
+            prepared = co_await std::move(*early_solve);
+        }
+
         if (!quit && letters_lower.empty()) {
             throw std::runtime_error("no hive letters available");
         }
 
         if (!quit) {
-            auto computed = find_valid_words(dictionaries.massive_words, letters_lower);
-            words_upper.clear();
-            words_upper.reserve(computed.size());
-            for (auto word : computed) {
-                to_upper_inplace(word);
-                words_upper.push_back(std::move(word));
+            if (!prepared) {
+                prepared = co_await sched.start(policies.solve, [&] { return prepare_words(dictionaries, letters_lower); });
             }
-            std::string outer_letters = letters_lower.substr(0, letters_lower.size() - 1);
-            std::string center_letter(1, static_cast<char>(std::toupper(static_cast<unsigned char>(letters_lower.back()))));
-            std::string outer_upper = outer_letters;
-            to_upper_inplace(outer_upper);
-            std::cout << "Letters: " << outer_upper << " (center " << center_letter << ")\n";
-            std::cout << "Generated " << words_upper.size() << " candidate words.\n";
+            result.projected_score = prepared->solution.score.max_score;
+            print_prepared_words(letters_lower, *prepared);
         }
 
         if (!quit) {
-            auto r = retry_with_pause("send words", [&] {
-                wd.send_all_words_as_keys(words_upper);
+            const auto submitter = make_word_submitter(config.submit_strategy);
+            auto r = co_await retry_with_pause(sched, "send words", policies.send_words, [&] {
+                PhaseTimer timer("submit", config.submit_strategy.c_str());
+                submitter->submit(wd, prepared->words_upper);
             });
-            if (r == StepResult::QUIT) quit = true;
+            stop_on(r);
+            if (r == StepResult::OK) submitter->report(std::cout);
         }
 
         result.session_active = !wd.sessionId.empty();
-        result.user_quit = quit;
+        result.user_quit = quit && !result.cancelled;
         result.fatal_error = false;
-        return result;
     } catch (const std::exception& e) {
         result.session_active = !wd.sessionId.empty();
-        result.user_quit = quit;
+        result.user_quit = quit && !result.cancelled;
         result.fatal_error = true;
         result.fatal_message = e.what();
-        return result;
     } catch (...) {
         result.session_active = !wd.sessionId.empty();
         result.user_quit = false;
         result.fatal_error = true;
         result.fatal_message = "unknown error";
-        return result;
     }
+    co_return result;
+}
+
+static AttemptResult run_attempt(WD& wd,
+                                 AsyncWD* async_wd,
+                                 bool have_session,
+                                 bool do_full_setup,
+                                 int attempt_index,
+                                 const Config& config,
+                                 DictionaryLoader& dictionaries) {
+    Scheduler sched;
+    g_cancel_requested = false;
+    g_workflow_active = 1;
+    TraceSpan span("run_attempt " + std::to_string(attempt_index), "run", {{"full_setup", do_full_setup}});
+    auto workflow = attempt_workflow(sched, wd, async_wd, have_session, do_full_setup, attempt_index, config, dictionaries);
+    AttemptResult result = sched.run(workflow);
+    if (json* args = span.args()) {
+        (*args)["cancelled"] = result.cancelled;
+        (*args)["user_quit"] = result.user_quit;
+        if (result.fatal_error) (*args)["fatal"] = result.fatal_message;
+    }
+    g_workflow_active = 0;
+    g_cancel_requested = false;
+    return result;
 }
 
 // ---------- Main ----------
 int main(int argc, char** argv) {
     Config config = parse_args(argc, argv);
+    // Declared first, so records logged while anything else is torn down are still written.
+    struct LogOnExit {
+        ~LogOnExit() { g_log.stop(); }
+    } log_on_exit;
+    start_logging(config.log_level, config.log_format);
+
+    if (config.bench || !config.stress_sizes.empty() || !config.generate_dir.empty()) {
+        try {
+            if (!config.generate_dir.empty()) return run_generate_dictionaries(config);
+            if (!config.stress_sizes.empty()) return run_stress(config);
+            return run_micro_benchmarks(config);
+        } catch (const std::exception& e) {
+            log_at(LogLevel::Fatal, e.what());
+            return 1;
+        }
+    }
+
+    if (config.bench_decode_iterations > 0) {
+        try {
+            return run_decode_benchmark(config);
+        } catch (const std::exception& e) {
+            log_at(LogLevel::Fatal, e.what());
+            return 1;
+        }
+    }
+
+    if (config.bench_webdriver_iterations > 0 || config.calibrate_submit_words > 0) {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        int rc = 1;
+        try {
+            rc = config.calibrate_submit_words > 0 ? run_submit_calibration(config) : run_webdriver_benchmark(config);
+        } catch (const std::exception& e) {
+            log_at(LogLevel::Fatal, e.what());
+        }
+        curl_global_cleanup();
+        return rc;
+    }
 
     if (config.dictionary_dir.empty()) {
-        std::cerr << "[FATAL] Could not locate word list directory. Specify --dictionary-dir=PATH." << std::endl;
+        log_at(LogLevel::Fatal, "Could not locate word list directory. Specify --dictionary-dir=PATH.");
         return 1;
     }
     if (!fs::exists(config.dictionary_dir) || !fs::is_directory(config.dictionary_dir)) {
-        std::cerr << "[FATAL] Dictionary directory not found: " << config.dictionary_dir << std::endl;
+        log_at(LogLevel::Fatal, "Dictionary directory not found: ", config.dictionary_dir);
         return 1;
     }
 
-    WordDictionaries dictionaries;
-    try {
-        dictionaries = load_word_dictionaries(config.dictionary_dir);
-    } catch (const std::exception& e) {
-        std::cerr << "[FATAL] " << e.what() << std::endl;
-        return 1;
+    if (!config.word_changes.empty() || config.compact_dictionaries) {
+        try {
+            return run_dictionary_update(config);
+        } catch (const std::exception& e) {
+            log_at(LogLevel::Fatal, e.what());
+            return 1;
+        }
     }
 
-    if (dictionaries.massive_words.empty()) {
-        std::cerr << "[FATAL] word list 'wlist_match1.txt' appears to be empty in "
-                  << config.dictionary_dir << std::endl;
-        return 1;
+    // Keep stdout machine-readable when emitting JSON hints or query results.
+    const bool machine_output = config.hints == HintsFormat::Json || config.query || !config.check_words_file.empty();
+    // Declared before the loader, so the files are written once everything else is torn down.
+    struct MetricsOnExit {
+        fs::path prefix;
+        ~MetricsOnExit() {
+            if (!prefix.empty()) g_phase_metrics.write_files(prefix);
+        }
+    } metrics_on_exit{config.metrics_prefix};
+    if (!config.metrics_prefix.empty()) {
+        g_phase_metrics_enabled = true;
+        start_metrics_signal_thread(config.metrics_prefix);
+    }
+    struct TraceOnExit {
+        fs::path path;
+        ~TraceOnExit() {
+            if (!path.empty()) g_trace.write(path);
+        }
+    } trace_on_exit{config.trace_file};
+    if (!config.trace_file.empty()) g_trace.enable();
+    const bool offline = config.hints != HintsFormat::None || config.query || !config.check_words_file.empty();
+    DictionaryLoader dictionaries(config.dictionary_dir, machine_output ? std::cerr : std::cout, !offline);
+
+    if (offline) {
+        try {
+            return run_offline_mode(config, *dictionaries.get());
+        } catch (const std::exception& e) {
+            log_at(LogLevel::Fatal, e.what());
+            return 1;
+        }
     }
 
-    std::cout << "Loaded word lists from " << config.dictionary_dir
-              << " (massive set size: " << dictionaries.massive_words.size() << ")" << std::endl;
+    if (config.submit_strategy.empty()) {
+        if (auto calibrated = load_calibrated_strategy(config.submit_calibration_file)) {
+            config.submit_strategy = *calibrated;
+            std::cout << "Typing words with the calibrated '" << config.submit_strategy << "' strategy.\n";
+        } else {
+            config.submit_strategy = "actions";
+        }
+    }
 
+    // Started after the loader, so it is stopped before the loader is torn down.
+    DictionaryWatcher dictionary_watcher(dictionaries);
+    install_interrupt_handler();
     curl_global_init(CURL_GLOBAL_DEFAULT);
     bool want_close = true;
     try {
+        std::optional<TrafficRecorder> recorder;
+        if (!config.record_file.empty()) recorder.emplace(config.record_file);
         CurlSession curl;
+        curl.recorder = recorder ? &*recorder : nullptr;
         WD wd(curl);
 
         if (const char* url = std::getenv("WEBDRIVER_URL"); url && *url) {
             wd.base = url;
         }
 
+        std::unique_ptr<AsyncCurlClient> async_client;
+        std::unique_ptr<AsyncWD> async_wd;
+        if (config.async_webdriver) {
+            async_client = std::make_unique<AsyncCurlClient>();
+            async_client->recorder = curl.recorder;
+            async_wd = std::make_unique<AsyncWD>(wd, *async_client);
+        }
+
         bool exit_program = false;
         int attempt_index = 0;
         bool need_full_setup = true;
 
+        if (config.reuse_session) {
+            if (auto url = reattach_saved_session(wd, config.session_file)) {
+                // Still on the puzzle: treat the first attempt like a rerun in this process.
+                need_full_setup = url->rfind(kSpellingBeeUrl, 0) != 0;
+                std::cout << "Reattached to browser session " << wd.sessionId << ".\n";
+            }
+        }
+
         while (!exit_program) {
             ++attempt_index;
             const bool have_session = !wd.sessionId.empty();
             bool do_full_setup = need_full_setup || !have_session;
-            AttemptResult attempt = run_attempt(wd, have_session, do_full_setup, attempt_index, config, dictionaries);
+            AttemptResult attempt = run_attempt(wd, async_wd.get(), have_session, do_full_setup, attempt_index, config, dictionaries);
 
             if (attempt.fatal_error) {
-                std::cerr << "\n[FATAL] " << attempt.fatal_message << "\n";
+                log_at(LogLevel::Fatal, "\n", attempt.fatal_message);
+            }
+            if (attempt.cancelled) {
+                log_at(LogLevel::Warn, "\nRun cancelled; the browser was left as it is.");
             }
 
             if (attempt.user_quit) {
@@ -735,7 +5450,7 @@ int main(int argc, char** argv) {
                 }
             }
 
-            if (attempt.fatal_error && config.stop_action != StopAction::Rerun) {
+            if (attempt.fatal_error && (config.stop_action != StopAction::Rerun || dictionaries.failed)) {
                 exit_program = true;
             }
 
@@ -743,10 +5458,22 @@ int main(int argc, char** argv) {
         }
 
         if (!wd.sessionId.empty() && want_close) {
-            try { wd.delete_session(); } catch (...) {}
+            // Closing was chosen, so a session whose DELETE failed is not kept for reuse either.
+            try { wd.delete_session(); } catch (...) { wd.sessionId.clear(); }
+        }
+        if (!wd.sessionId.empty()) {
+            save_session_state(config.session_file, wd);
+        } else {
+            clear_session_state(config.session_file);
+        }
+        if (config.transport_stats) {
+            TransportStats stats = curl.stats;
+            if (async_client) stats.merge(async_client->stats_snapshot());
+            g_log.flush();
+            stats.print(std::cerr);
         }
     } catch (const std::exception& e) {
-        std::cerr << "\n[FATAL] " << e.what() << "\n";
+        log_at(LogLevel::Fatal, "\n", e.what());
         std::string ans = prompt_line("Type 'keep' to leave the browser open, otherwise press Enter to close: ");
         if (ans == "keep" || ans == "k") {
             want_close = false;
@@ -0,0 +1,154 @@
+"""End-to-end benchmark of the solver binaries against tools/mock_chromedriver.py.
+
+Each run starts a fresh mock and drives one full attempt through it: new session,
+navigate, wait for the board, read the hive, solve, type every word, close the session.
+No browser or network is involved. The report gives wall time and the requests and
+bytes each binary sent, taken from the mock's /mock/stats. Arguments after "--" go to
+the mock, so latency and failure injection apply to every run.
+
+    python3 tools/bench_e2e.py --cpp ./spellingbee --c ./spellingbee_c --dictionary-dir=words
+    python3 tools/bench_e2e.py --cpp ./spellingbee --dictionary-dir=words --runs 5 \\
+        --solver-arg=--submit-strategy=actions -- --latency-ms 2 --fail click=2
+"""
+
+import argparse
+import json
+import os
+import socket
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+import urllib.request
+
+MOCK = os.path.join(os.path.dirname(os.path.abspath(__file__)), "mock_chromedriver.py")
+
+
+def free_port():
+    with socket.socket() as s:
+        s.bind(("127.0.0.1", 0))
+        return s.getsockname()[1]
+
+
+def fetch_stats(port):
+    with urllib.request.urlopen("http://127.0.0.1:%d/mock/stats" % port, timeout=5) as resp:
+        return json.load(resp)
+
+
+def start_mock(port, mock_args):
+    mock = subprocess.Popen([sys.executable, MOCK, "--port", str(port)] + mock_args,
+                            stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+    deadline = time.monotonic() + 5
+    while time.monotonic() < deadline:
+        if mock.poll() is not None:
+            raise RuntimeError("mock exited: " + mock.stderr.read().strip())
+        try:
+            fetch_stats(port)
+            return mock
+        except OSError:
+            time.sleep(0.05)
+    mock.kill()
+    raise RuntimeError("mock did not start listening on port %d" % port)
+
+
+def run_once(binary, args):
+    port = free_port()
+    mock = start_mock(port, args.mock_args)
+    try:
+        with tempfile.TemporaryDirectory() as state_dir:
+            env = dict(os.environ, WEBDRIVER_URL="http://127.0.0.1:%d" % port, XDG_STATE_HOME=state_dir)
+            # stop-action=prompt reads EOF from stdin and closes the session, ending the run.
+            cmd = [binary, "--dictionary-dir=" + args.dictionary_dir, "--new-session",
+                   "--stop-action=prompt"] + args.solver_arg
+            start = time.perf_counter()
+            try:
+                proc = subprocess.run(cmd, env=env, stdin=subprocess.DEVNULL, stdout=subprocess.PIPE,
+                                      stderr=subprocess.STDOUT, timeout=args.timeout)
+                status = "ok" if proc.returncode == 0 else "exit %d" % proc.returncode
+                output = proc.stdout
+            except subprocess.TimeoutExpired as e:
+                status = "timed out"
+                output = e.stdout or b""
+            wall = time.perf_counter() - start
+        stats = fetch_stats(port)
+    finally:
+        mock.terminate()
+        mock.wait()
+    if status != "ok" and args.verbose:
+        sys.stderr.write(output.decode(errors="replace"))
+    return {
+        "wall_s": wall,
+        "status": status,
+        "requests": stats["requests"],
+        "request_bytes": stats["request_bytes"],
+        "response_bytes": stats["response_bytes"],
+        "found": stats["found"],
+        "endpoints": stats["endpoints"],
+    }
+
+
+def summarize(name, runs):
+    ok = [r for r in runs if r["status"] == "ok"]
+    pick = ok or runs
+    return {
+        "binary": name,
+        "runs": len(runs),
+        "failed": len(runs) - len(ok),
+        "wall_s_median": statistics.median(r["wall_s"] for r in pick),
+        "wall_s_min": min(r["wall_s"] for r in pick),
+        "requests": statistics.median(r["requests"] for r in pick),
+        "request_bytes": statistics.median(r["request_bytes"] for r in pick),
+        "response_bytes": statistics.median(r["response_bytes"] for r in pick),
+        "found": statistics.median(r["found"] for r in pick),
+        "endpoints": pick[-1]["endpoints"],
+    }
+
+
+def print_table(summaries):
+    print("%-6s %5s %7s %9s %9s %9s %10s %11s %6s"
+          % ("binary", "runs", "failed", "median s", "min s", "requests", "sent KB", "received KB", "found"))
+    for s in summaries:
+        print("%-6s %5d %7d %9.2f %9.2f %9d %10.1f %11.1f %6d"
+              % (s["binary"], s["runs"], s["failed"], s["wall_s_median"], s["wall_s_min"], s["requests"],
+                 s["request_bytes"] / 1024.0, s["response_bytes"] / 1024.0, s["found"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--cpp", help="binary built from main.cpp")
+    parser.add_argument("--c", help="binary built from main.c")
+    parser.add_argument("--dictionary-dir", required=True)
+    parser.add_argument("--runs", type=int, default=3)
+    parser.add_argument("--timeout", type=float, default=120, help="seconds before a run counts as hung")
+    parser.add_argument("--solver-arg", action="append", default=[], help="extra flag for both binaries")
+    parser.add_argument("--json", action="store_true", help="print the summaries as JSON")
+    parser.add_argument("--verbose", action="store_true", help="show the output of failed runs")
+    parser.add_argument("mock_args", nargs=argparse.REMAINDER, help="-- then arguments for the mock")
+    args = parser.parse_args()
+    if args.mock_args[:1] == ["--"]:
+        args.mock_args = args.mock_args[1:]
+    binaries = [(name, path) for name, path in (("cpp", args.cpp), ("c", args.c)) if path]
+    if not binaries:
+        parser.error("give --cpp and/or --c")
+
+    summaries = []
+    for name, path in binaries:
+        runs = []
+        for i in range(args.runs):
+            run = run_once(os.path.abspath(path), args)
+            sys.stderr.write("%s run %d: %.2fs, %d requests, %s\n" % (name, i + 1, run["wall_s"], run["requests"],
+                                                                      run["status"]))
+            runs.append(run)
+        summaries.append(summarize(name, runs))
+
+    if args.json:
+        json.dump(summaries, sys.stdout, indent=2)
+        print()
+    else:
+        print_table(summaries)
+    return 1 if any(s["failed"] for s in summaries) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
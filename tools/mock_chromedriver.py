@@ -0,0 +1,591 @@
+"""Local stand-in for chromedriver plus Chrome's DevTools WebSocket endpoint.
+
+Answers the WebDriver calls the solver makes to start a session and type words, and
+serves a DevTools page target whose WebSocket accepts Input.dispatchKeyEvent and
+Input.insertText, so every --submit-strategy can be exercised without a browser. Words
+(one per Enter) reaching the single mock page are recorded until the next navigation
+and returned to the calibration read-back script; off the puzzle they all count as found
+for the missing-words check, as the calibration page lists every word typed into it.
+GET /mock/stats counts them per channel. --drop-rate loses that fraction of keystrokes
+on the --lossy channels, to check that calibration rejects unreliable strategies; with
+--safe-gap-ms, only words typed less than that long after the previous one are at risk,
+the way a busy page falls behind, which is what the paced strategy's pause adapts to.
+
+Navigating to the Spelling Bee URL loads a synthetic puzzle: seven .hive-cell elements
+carrying --letters (center last, as the solver's --letters takes them) and a found-word
+list holding the typed words the puzzle accepts. --unknown-rate rejects that fraction of
+otherwise valid words, the way the puzzle's list is smaller than any dictionary, and
+--fail makes the first N calls of a kind fail with a WebDriver error. GET /mock/stats
+also reports requests per endpoint and the bytes each way, which is what
+tools/bench_e2e.py measures.
+
+    python3 tools/mock_chromedriver.py --port 9515 --drop-rate 0.01 --lossy script
+    WEBDRIVER_URL=http://127.0.0.1:9515 ./spellingbee --calibrate-submit=2000
+
+    python3 tools/mock_chromedriver.py --port 9515 --letters taegnil --fail click=2
+    WEBDRIVER_URL=http://127.0.0.1:9515 ./spellingbee --dictionary-dir=words </dev/null
+"""
+
+import argparse
+import base64
+import hashlib
+import json
+import random
+import re
+import struct
+import sys
+import threading
+import time
+import uuid
+import zlib
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC11B85"
+PAGE_ID = "MOCKPAGE0001"
+
+
+CHANNELS = ("actions", "value", "script", "devtools")
+ENTER_KEYS = ("Enter", "\ue007")  # DevTools key name, W3C key code
+ELEMENT_KEY = "element-6066-11e4-a52e-4f735466cecf"
+PUZZLE_URL = "https://www.nytimes.com/puzzles/spelling-bee"
+
+# Calls --fail can break, and the error each one gets unless KIND=N:ERROR names another.
+FAIL_KINDS = {
+    "session": "timeout",
+    "url": "timeout",
+    "rect": "timeout",
+    "element": "no such element",
+    "text": "stale element reference",
+    "attribute": "stale element reference",
+    "click": "element click intercepted",
+    "value": "element not interactable",
+    "actions": "timeout",
+    "script": "script timeout",
+}
+ERROR_STATUS = {
+    "no such element": 404,
+    "stale element reference": 404,
+    "invalid session id": 404,
+    "unknown command": 404,
+    "element click intercepted": 400,
+    "element not interactable": 400,
+    "invalid argument": 400,
+}
+
+
+class Puzzle:
+    """The hive the mock page shows and the words it accepts."""
+
+    def __init__(self, letters, unknown_rate):
+        self.center = letters[-1].upper()
+        self.outer = letters[:-1].upper()
+        self.letters = set(self.center + self.outer)
+        self.unknown_rate = unknown_rate
+
+    def cell(self, index):
+        """(letter, class) for .hive-cell:nth-child(index); the center comes first, as on the page."""
+        if index == 1:
+            return self.center, "hive-cell center"
+        return self.outer[index - 2], "hive-cell outer"
+
+    def accepts(self, word):
+        if len(word) < 4 or self.center not in word or not set(word) <= self.letters:
+            return False
+        # Stable per word, so every run and both ports see the same list.
+        return zlib.crc32(word.encode()) / 2.0 ** 32 >= self.unknown_rate
+
+
+class State:
+    def __init__(self, port, latency_ms, drop_rate, lossy, safe_gap_ms, puzzle, fails, load_polls):
+        self.port = port
+        self.latency = latency_ms / 1000.0
+        self.drop_rate = drop_rate
+        self.lossy = set(lossy)
+        self.safe_gap_ms = safe_gap_ms
+        self.puzzle = puzzle
+        self.fails = fails  # kind -> [calls left to fail, error]
+        self.load_polls = load_polls
+        self.rng = random.Random(7)
+        self.lock = threading.Lock()
+        self.sessions = set()
+        self.page_url = "about:blank"
+        self.words = dict.fromkeys(CHANNELS, 0)
+        self.page_typed = []  # words the page has seen since its last navigation
+        self.found = {}  # of those, the ones the puzzle accepted, in order (values unused)
+        self.probes = 0  # readiness polls since the last navigation
+        self.last_words = []
+        self.endpoints = {}  # "METHOD /path/{id}" -> calls
+        self.request_bytes = 0
+        self.response_bytes = 0
+
+    def on_puzzle(self):
+        return self.page_url.startswith(PUZZLE_URL)
+
+    def navigate(self, url):
+        with self.lock:
+            self.page_url = url
+            self.page_typed = []
+            self.found = {}
+            self.probes = 0
+
+    def take_failure(self, kind):
+        """The error to answer this `kind` of call with, or None to let it through."""
+        with self.lock:
+            fail = self.fails.get(kind)
+            if not fail or fail[0] <= 0:
+                return None
+            fail[0] -= 1
+            return fail[1]
+
+    def record(self, label, received, sent):
+        with self.lock:
+            if label:
+                self.endpoints[label] = self.endpoints.get(label, 0) + 1
+            self.request_bytes += received
+            self.response_bytes += sent
+
+    def stats(self):
+        with self.lock:
+            return {
+                "words": dict(self.words),
+                "last_words": list(self.last_words),
+                "found": len(self.found),
+                "requests": sum(self.endpoints.values()),
+                "endpoints": dict(sorted(self.endpoints.items())),
+                "request_bytes": self.request_bytes,
+                "response_bytes": self.response_bytes,
+            }
+
+    def keep_key(self, channel, gap_ms):
+        """False when a keystroke on `channel`, gap_ms after the previous word, should be lost."""
+        if channel not in self.lossy or not self.drop_rate:
+            return True
+        if self.safe_gap_ms and gap_ms >= self.safe_gap_ms:
+            return True
+        with self.lock:
+            return self.rng.random() >= self.drop_rate
+
+    def submit(self, channel, word):
+        with self.lock:
+            self.words[channel] += 1
+            self.page_typed.append(word)
+            self.last_words.append(word)
+            del self.last_words[:-20]
+            if self.on_puzzle() and word not in self.found and self.puzzle.accepts(word):
+                self.found[word] = None
+
+
+class Typist:
+    """Turns one channel's key presses into submitted words, dropping keys if lossy."""
+
+    def __init__(self, state, channel):
+        self.state = state
+        self.channel = channel
+        self.current = []
+        self.gap_ms = float("inf")  # a new request starts well clear of the last word
+
+    def pause(self, ms):
+        self.gap_ms += ms
+
+    def key(self, key):
+        if not self.state.keep_key(self.channel, self.gap_ms):
+            return
+        if key in ENTER_KEYS:
+            self.state.submit(self.channel, "".join(self.current))
+            self.current = []
+            self.gap_ms = 0
+        elif len(key) == 1:
+            self.current.append(key.upper())
+
+    def text(self, text):
+        for ch in text:
+            self.key(ch)
+
+
+def command_kind(rest):
+    """The --fail kind of a session command, given the path after /session/{id}."""
+    for suffix, kind in (("/value", "value"), ("/click", "click"), ("/text", "text"), ("/url", "url"), ("/window/rect", "rect"),
+                         ("/element", "element"), ("/actions", "actions"), ("/execute/sync", "script")):
+        if rest.endswith(suffix):
+            return kind
+    if "/attribute/" in rest:
+        return "attribute"
+    return None
+
+
+class CountingReader:
+    def __init__(self, raw):
+        self.raw = raw
+        self.count = 0
+
+    def read(self, n=-1):
+        data = self.raw.read(n)
+        self.count += len(data)
+        return data
+
+    def readline(self, limit=-1):
+        line = self.raw.readline(limit)
+        self.count += len(line)
+        return line
+
+    def close(self):
+        self.raw.close()
+
+
+class CountingWriter:
+    def __init__(self, raw):
+        self.raw = raw
+        self.count = 0
+
+    def write(self, data):
+        self.count += len(data)
+        return self.raw.write(data)
+
+    def flush(self):
+        self.raw.flush()
+
+    # BaseHTTPRequestHandler.finish() checks and closes the writer.
+    @property
+    def closed(self):
+        return self.raw.closed
+
+    def close(self):
+        self.raw.close()
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    disable_nagle_algorithm = True  # headers and body go out as separate writes
+    state = None  # set in main()
+
+    def log_message(self, fmt, *args):
+        pass
+
+    # ---------- HTTP plumbing ----------
+
+    def setup(self):
+        super().setup()
+        self.rfile = CountingReader(self.rfile)
+        self.wfile = CountingWriter(self.wfile)
+
+    def handle(self):
+        try:
+            super().handle()
+        except (ConnectionResetError, BrokenPipeError):
+            pass  # the client went away mid-request, e.g. bench_e2e killing a hung run
+
+    def handle_one_request(self):
+        received, sent = self.rfile.count, self.wfile.count
+        self.label = None
+        super().handle_one_request()
+        if not getattr(self, "path", "").startswith("/mock/"):
+            self.state.record(self.label, self.rfile.count - received, self.wfile.count - sent)
+
+    def reply(self, payload, status=200):
+        body = json.dumps(payload, separators=(",", ":")).encode()
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def wd_reply(self, value, status=200):
+        self.reply({"value": value}, status)
+
+    def wd_error(self, error, message, status):
+        self.wd_reply({"error": error, "message": message, "stacktrace": ""}, status)
+
+    def read_body(self):
+        length = int(self.headers.get("Content-Length") or 0)
+        raw = self.rfile.read(length) if length else b""
+        return json.loads(raw) if raw.strip() else {}
+
+    def session_route(self):
+        m = re.match(r"^/session/([^/]+)(/.*)?$", self.path)
+        if not m:
+            return None, None
+        return m.group(1), m.group(2) or ""
+
+    def dispatch(self, method):
+        self.label = method + " " + re.sub(r"^/session/[^/]+", "/session/{id}",
+                                           re.sub(r"/element/[^/]+/", "/element/{id}/", self.path))
+        if self.state.latency:
+            time.sleep(self.state.latency)
+        body = self.read_body() if method in ("POST", "DELETE") else {}
+        if method == "GET" and self.path == "/mock/stats":
+            return self.reply(self.state.stats())
+        if method == "GET" and self.path in ("/json", "/json/list"):
+            return self.reply([self.page_target()])
+        if method == "GET" and self.path == "/json/version":
+            return self.reply({"Browser": "MockChrome/1.0", "Protocol-Version": "1.3"})
+        if method == "POST" and self.path == "/session":
+            return self.injected_failure("session") or self.new_session()
+        session_id, rest = self.session_route()
+        if session_id is None:
+            return self.wd_error("unknown command", "no route for " + self.path, 404)
+        with self.state.lock:
+            alive = session_id in self.state.sessions
+        if not alive:
+            return self.wd_error("invalid session id", "session " + session_id + " does not exist", 404)
+        return self.injected_failure(command_kind(rest)) or self.session_command(method, session_id, rest, body)
+
+    def injected_failure(self, kind):
+        """Answers with the --fail error for `kind` and returns True, or returns False."""
+        error = self.state.take_failure(kind)
+        if error is None:
+            return False
+        self.wd_error(error, "injected by --fail " + kind, ERROR_STATUS.get(error, 500))
+        return True
+
+    def do_GET(self):
+        if self.headers.get("Upgrade", "").lower() == "websocket":
+            self.label = "WS /devtools/page/{id}"
+            return self.devtools_socket()
+        self.dispatch("GET")
+
+    def do_POST(self):
+        self.dispatch("POST")
+
+    def do_DELETE(self):
+        self.dispatch("DELETE")
+
+    # ---------- WebDriver ----------
+
+    def page_target(self):
+        with self.state.lock:
+            url = self.state.page_url
+        return {
+            "id": PAGE_ID,
+            "type": "page",
+            "title": "Spelling Bee",
+            "url": url,
+            "webSocketDebuggerUrl": "ws://127.0.0.1:%d/devtools/page/%s" % (self.state.port, PAGE_ID),
+        }
+
+    def new_session(self):
+        session_id = uuid.uuid4().hex
+        with self.state.lock:
+            self.state.sessions.add(session_id)
+        caps = {
+            "browserName": "chrome",
+            "goog:chromeOptions": {"debuggerAddress": "127.0.0.1:%d" % self.state.port},
+        }
+        self.wd_reply({"sessionId": session_id, "capabilities": caps})
+
+    def session_command(self, method, session_id, rest, body):
+        if method == "DELETE" and rest == "":
+            with self.state.lock:
+                self.state.sessions.discard(session_id)
+            return self.wd_reply(None)
+        if rest == "/url":
+            if method == "POST":
+                self.state.navigate(body.get("url", ""))
+                return self.wd_reply(None)
+            with self.state.lock:
+                return self.wd_reply(self.state.page_url)
+        if rest == "/window/rect" and method == "POST":
+            return self.wd_reply({"x": 0, "y": 0, "width": body.get("width"), "height": body.get("height")})
+        if rest == "/actions" and method == "POST":
+            return self.perform_actions(body)
+        if rest == "/element" and method == "POST":
+            element_id = self.find_element(body.get("value", ""))
+            if element_id is None:
+                return self.wd_error("no such element", "no element matches " + body.get("value", ""), 404)
+            return self.wd_reply({ELEMENT_KEY: element_id})
+        m = re.match(r"^/element/([^/]+)/(value|click|text|attribute/(.+))$", rest)
+        if m:
+            return self.element_command(method, m.group(1), m.group(2), m.group(3), body)
+        if rest == "/execute/sync" and method == "POST":
+            return self.execute_script(body.get("script", ""), body.get("args", []))
+        return self.wd_error("unknown command", "%s %s is not mocked" % (method, rest), 404)
+
+    def find_element(self, css):
+        if css == "body":
+            return "body"
+        m = re.match(r"^\.hive-cell:nth-child\(([1-7])\)$", css)
+        if m and self.state.on_puzzle():
+            return "cell-" + m.group(1)
+        return None
+
+    def element_command(self, method, element_id, command, attribute, body):
+        if command == "value" and method == "POST":
+            Typist(self.state, "value").text(body.get("text", ""))
+            return self.wd_reply(None)
+        m = re.match(r"^cell-([1-7])$", element_id)
+        if not (element_id == "body" or (m and self.state.on_puzzle())):
+            return self.wd_error("stale element reference", "element " + element_id + " is not on the page", 404)
+        if command == "click" and method == "POST":
+            return self.wd_reply(None)
+        if not m or method != "GET":
+            return self.wd_error("unknown command", "%s %s is not mocked" % (method, command), 404)
+        letter, classes = self.state.puzzle.cell(int(m.group(1)))
+        if command == "text":
+            return self.wd_reply(letter)
+        return self.wd_reply(classes if attribute == "class" else None)
+
+    def perform_actions(self, body):
+        for source in body.get("actions", []):
+            typist = Typist(self.state, "actions")
+            for action in source.get("actions", []):
+                if action.get("type") == "keyDown":
+                    typist.key(action.get("value", ""))
+                elif action.get("type") == "pause":
+                    duration = action.get("duration", 0)
+                    time.sleep(duration / 1000.0)
+                    typist.pause(duration)
+        self.wd_reply(None)
+
+    def execute_script(self, script, args):
+        if ".sb-anagram" in script:  # missing-words check against the page's found-word list
+            with self.state.lock:
+                # The calibration page lists every word typed into it, the puzzle only the ones it accepts.
+                found = set(self.state.found) if self.state.on_puzzle() else set(self.state.page_typed)
+            return self.wd_reply(" ".join(w for w in args[0] if w not in found))
+        if "__sbCalibration" in script:  # calibration read-back
+            with self.state.lock:
+                return self.wd_reply(list(self.state.page_typed))
+        if args and isinstance(args[0], list):  # script typing: arguments[0] is the word list
+            typist = Typist(self.state, "script")
+            for word in args[0]:
+                typist.text(word)
+                typist.key("Enter")
+            return self.wd_reply(len(args[0]))
+        with self.state.lock:  # readiness probe: the hive fills in after --load-polls polls
+            self.state.probes += 1
+            loaded = self.state.on_puzzle() and self.state.probes > self.state.load_polls
+        cells = 7 if loaded else 0
+        return self.wd_reply({"cells": cells, "lettered": cells, "modal": False, "dismissed": ""})
+
+    # ---------- DevTools WebSocket ----------
+
+    def devtools_socket(self):
+        key = self.headers.get("Sec-WebSocket-Key", "")
+        accept = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        self.send_response(101, "Switching Protocols")
+        self.send_header("Upgrade", "websocket")
+        self.send_header("Connection", "Upgrade")
+        self.send_header("Sec-WebSocket-Accept", accept)
+        self.end_headers()
+        self.close_connection = True
+        typist = Typist(self.state, "devtools")
+        while True:
+            frame = self.read_frame()
+            if frame is None:
+                return
+            opcode, payload = frame
+            if opcode == 0x8:
+                self.write_frame(0x8, payload[:2])
+                return
+            if opcode == 0x9:
+                self.write_frame(0xA, payload)
+                continue
+            if opcode != 0x1:
+                continue
+            message = json.loads(payload)
+            result = self.devtools_command(message, typist)
+            self.write_frame(0x1, json.dumps(result, separators=(",", ":")).encode())
+
+    def devtools_command(self, message, typist):
+        method = message.get("method", "")
+        params = message.get("params", {})
+        if method == "Input.insertText":
+            typist.text(params.get("text", ""))
+        elif method == "Input.dispatchKeyEvent":
+            if params.get("type") == "keyDown":
+                typist.key(params.get("key", ""))
+        else:
+            return {"id": message.get("id"), "error": {"code": -32601, "message": "'%s' wasn't found" % method}}
+        return {"id": message.get("id"), "result": {}}
+
+    def read_exact(self, n):
+        data = b""
+        while len(data) < n:
+            chunk = self.rfile.read(n - len(data))
+            if not chunk:
+                return None
+            data += chunk
+        return data
+
+    def read_frame(self):
+        payload = b""
+        first_opcode = None
+        while True:
+            header = self.read_exact(2)
+            if header is None:
+                return None
+            fin = header[0] & 0x80
+            opcode = header[0] & 0x0F
+            length = header[1] & 0x7F
+            if length == 126:
+                length = struct.unpack("!H", self.read_exact(2))[0]
+            elif length == 127:
+                length = struct.unpack("!Q", self.read_exact(8))[0]
+            mask = self.read_exact(4) if header[1] & 0x80 else b"\0\0\0\0"
+            data = self.read_exact(length) if length else b""
+            if data is None:
+                return None
+            data = bytes(b ^ mask[i % 4] for i, b in enumerate(data))
+            if opcode >= 0x8:  # control frames may interleave with fragments
+                return opcode, data
+            if first_opcode is None:
+                first_opcode = opcode
+            payload += data
+            if fin:
+                return first_opcode, payload
+
+    def write_frame(self, opcode, payload):
+        header = bytes([0x80 | opcode])
+        if len(payload) < 126:
+            header += bytes([len(payload)])
+        elif len(payload) < 65536:
+            header += bytes([126]) + struct.pack("!H", len(payload))
+        else:
+            header += bytes([127]) + struct.pack("!Q", len(payload))
+        self.wfile.write(header + payload)
+        self.wfile.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", type=int, default=9515)
+    parser.add_argument("--latency-ms", type=float, default=0, help="delay added to every HTTP request")
+    parser.add_argument("--drop-rate", type=float, default=0, help="fraction of keystrokes lost on lossy channels")
+    parser.add_argument("--lossy", default="", help="comma-separated channels: " + ", ".join(CHANNELS))
+    parser.add_argument("--safe-gap-ms", type=float, default=0,
+                        help="words typed at least this long after the previous one are never dropped")
+    parser.add_argument("--letters", default="taegnil", help="the puzzle's seven letters, center last")
+    parser.add_argument("--unknown-rate", type=float, default=0.9,
+                        help="fraction of valid words the puzzle's list does not have; real puzzles "
+                             "list a few dozen of the hundreds of words a big dictionary finds")
+    parser.add_argument("--load-polls", type=int, default=0,
+                        help="readiness polls after navigation that still find an empty hive")
+    parser.add_argument("--fail", action="append", default=[], metavar="KIND=N[:ERROR]",
+                        help="fail the first N calls of KIND (" + ", ".join(FAIL_KINDS) + ")")
+    args = parser.parse_args()
+
+    lossy = [c for c in args.lossy.split(",") if c]
+    unknown = set(lossy) - set(CHANNELS)
+    if unknown:
+        parser.error("unknown channel(s): " + ", ".join(sorted(unknown)))
+    letters = args.letters.lower()
+    if len(letters) != 7 or len(set(letters)) != 7 or not letters.isalpha():
+        parser.error("--letters needs seven distinct letters")
+    fails = {}
+    for spec in args.fail:
+        m = re.match(r"^(\w+)=(\d+)(?::(.+))?$", spec)
+        if not m or m.group(1) not in FAIL_KINDS:
+            parser.error("bad --fail %r; expected KIND=N[:ERROR] with KIND one of %s" % (spec, ", ".join(FAIL_KINDS)))
+        fails[m.group(1)] = [int(m.group(2)), m.group(3) or FAIL_KINDS[m.group(1)]]
+    Handler.state = State(args.port, args.latency_ms, args.drop_rate, lossy, args.safe_gap_ms,
+                          Puzzle(letters, args.unknown_rate), fails, args.load_polls)
+    server = ThreadingHTTPServer(("127.0.0.1", args.port), Handler)
+    server.daemon_threads = True
+    print("mock chromedriver listening on http://127.0.0.1:%d" % args.port, file=sys.stderr)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,194 @@
+"""Replays a --record=FILE WebDriver recording as a local stand-in server.
+
+Each request is answered with the recorded reply to the same method, path and payload,
+after the recorded latency. Requests are matched in recorded order. If none is left for
+that payload, the next reply recorded for the same path is used, then the next for the
+same endpoint with ids masked. Transfers that failed in the recording close the
+connection without replying.
+
+Given a command after "--", the script runs it against the server with WEBDRIVER_URL set
+and then compares the replay with the recording: requests per endpoint and wall time. It
+exits 1 when the command issued more requests than the recording holds, so a build that
+needs extra round trips for the same run fails; past --max-unmatched requests with no
+recorded reply the command is stopped, since it is then only retrying. Without a command
+it just serves.
+
+    ./spellingbee --record=run.jsonl ...
+    python3 tools/replay_webdriver.py run.jsonl -- ./spellingbee --dictionary-dir=words \\
+        --new-session --stop-action=prompt
+"""
+
+import argparse
+import collections
+import json
+import os
+import re
+import subprocess
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import urlsplit
+
+
+def endpoint_label(method, path):
+    """"POST /session/{id}/element/{id}/click": the path with session and element ids masked."""
+    return method + " " + re.sub(r"/(session|element)/[^/]+", r"/\1/{id}", path)
+
+
+class Recording:
+    def __init__(self, path):
+        with open(path) as f:
+            self.entries = [json.loads(line) for line in f if line.strip()]
+        if not self.entries:
+            raise SystemExit("%s holds no requests" % path)
+        self.lock = threading.Lock()
+        self.by_payload = collections.defaultdict(collections.deque)
+        self.by_path = collections.defaultdict(collections.deque)
+        self.by_label = collections.defaultdict(collections.deque)
+        for i, e in enumerate(self.entries):
+            path = urlsplit(e["url"]).path
+            e["path"] = path
+            self.by_payload[(e["method"], path, e.get("payload", ""))].append(i)
+            self.by_path[(e["method"], path)].append(i)
+            self.by_label[endpoint_label(e["method"], path)].append(i)
+        self.used = set()
+        self.replayed = collections.Counter()  # endpoint label -> requests served
+        self.unmatched = collections.Counter()
+
+    def recorded_counts(self):
+        return collections.Counter(endpoint_label(e["method"], e["path"]) for e in self.entries)
+
+    def recorded_wall_ms(self):
+        first = self.entries[0]["t_ms"]
+        return max(e["t_ms"] + e["latency_ms"] for e in self.entries) - first
+
+    def take(self, method, path, payload):
+        """The recorded entry to answer with, or None."""
+        label = endpoint_label(method, path)
+        with self.lock:
+            self.replayed[label] += 1
+            for queue in (self.by_payload.get((method, path, payload)), self.by_path.get((method, path)),
+                          self.by_label.get(label)):
+                while queue and queue[0] in self.used:
+                    queue.popleft()
+                if queue:
+                    i = queue.popleft()
+                    self.used.add(i)
+                    return self.entries[i]
+            self.unmatched[label] += 1
+            return None
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    disable_nagle_algorithm = True
+    recording = None  # set in main()
+    speed = 1.0
+
+    def log_message(self, fmt, *args):
+        pass
+
+    def serve(self, method):
+        length = int(self.headers.get("Content-Length") or 0)
+        payload = self.rfile.read(length).decode(errors="replace") if length else ""
+        path = urlsplit(self.path).path
+        entry = self.recording.take(method, path, payload)
+        if entry is None:
+            body = json.dumps({"value": {"error": "unknown command", "stacktrace": "",
+                                         "message": "no recorded reply for %s %s" % (method, path)}}).encode()
+            status = 404
+        else:
+            if self.speed > 0:
+                time.sleep(entry["latency_ms"] / 1000.0 / self.speed)
+            if entry["status"] == 0:  # failed below HTTP when recorded
+                self.close_connection = True
+                return
+            body = entry["response"].encode()
+            status = entry["status"]
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_GET(self):
+        self.serve("GET")
+
+    def do_POST(self):
+        self.serve("POST")
+
+    def do_DELETE(self):
+        self.serve("DELETE")
+
+
+def report(recording, wall_s):
+    recorded = recording.recorded_counts()
+    replayed = recording.replayed
+    print("%-58s %9s %9s %7s" % ("endpoint", "recorded", "replayed", "delta"))
+    for label in sorted(set(recorded) | set(replayed)):
+        delta = replayed[label] - recorded[label]
+        print("%-58s %9d %9d %+7d%s" % (label, recorded[label], replayed[label], delta,
+                                        "  (%d unmatched)" % recording.unmatched[label]
+                                        if recording.unmatched[label] else ""))
+    total_recorded, total_replayed = sum(recorded.values()), sum(replayed.values())
+    print("%-58s %9d %9d %+7d" % ("total", total_recorded, total_replayed, total_replayed - total_recorded))
+    print("wall time: recorded %.2fs, replayed %.2fs" % (recording.recorded_wall_ms() / 1000.0, wall_s))
+    return total_replayed > total_recorded
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0],
+                                     usage="%(prog)s [options] recording [-- command ...]")
+    parser.add_argument("recording", help="file written by --record=FILE")
+    parser.add_argument("--port", type=int, default=0, help="0 picks a free port")
+    parser.add_argument("--speed", type=float, default=1.0,
+                        help="divide recorded latencies by this; 0 replies without delay")
+    parser.add_argument("--timeout", type=float, default=600, help="seconds the command may run")
+    parser.add_argument("--max-unmatched", type=int, default=20,
+                        help="stop the command after this many requests without a recorded reply")
+    argv = sys.argv[1:]
+    split = argv.index("--") if "--" in argv else len(argv)
+    args = parser.parse_args(argv[:split])
+    command = argv[split + 1:]
+
+    Handler.recording = Recording(args.recording)
+    Handler.speed = args.speed
+    server = ThreadingHTTPServer(("127.0.0.1", args.port), Handler)
+    server.daemon_threads = True
+    url = "http://127.0.0.1:%d" % server.server_address[1]
+    if not command:
+        print("replaying %d requests on %s" % (len(Handler.recording.entries), url), file=sys.stderr)
+        try:
+            server.serve_forever()
+        except KeyboardInterrupt:
+            pass
+        return 0
+
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    start = time.perf_counter()
+    proc = subprocess.Popen(command, env=dict(os.environ, WEBDRIVER_URL=url), stdin=subprocess.DEVNULL,
+                            stdout=subprocess.DEVNULL)
+    status = None
+    while status is None:
+        try:
+            status = proc.wait(timeout=0.1)
+        except subprocess.TimeoutExpired:
+            if sum(Handler.recording.unmatched.values()) > args.max_unmatched:
+                status = "stopped after %d unmatched requests" % args.max_unmatched
+            elif time.perf_counter() - start > args.timeout:
+                status = "timed out"
+            else:
+                continue
+            proc.kill()
+            proc.wait()
+    wall_s = time.perf_counter() - start
+    server.shutdown()
+    more_requests = report(Handler.recording, wall_s)
+    if status != 0:
+        print("command exited with %d" % status if isinstance(status, int) else "command " + status)
+    return 1 if more_requests or status != 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,95 @@
+"""Checks that --check-words sees the delta segments --add-words and --remove-words write.
+
+Each binary gets its own copy of the word lists in a scratch directory, so the given
+directory is never modified. A word new to the lists is added and then removed, a word
+already in wlist_match1.txt is removed and added back, and after every step --check-words
+must report the massive tier bit accordingly; the last step folds the segments in with
+--compact-dictionaries and checks again.
+
+    python3 tools/test_word_changes.py --cpp ./spellingbee --c ./spellingbee_c --dictionary-dir=words
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+LIST_FILES = ("wordlist.txt", "wiki-100k.txt", "words.txt", "words400k.txt", "wlist_match1.txt")
+TIER_MASSIVE = 8
+NEW_WORD = "zzqxlate"
+
+
+def run(binary, dictionary_dir, *args, stdin=None):
+    proc = subprocess.run([binary, "--dictionary-dir=" + dictionary_dir] + list(args), input=stdin,
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=120)
+    if proc.returncode != 0:
+        raise AssertionError("%s exited %d: %s" % (" ".join(args), proc.returncode, proc.stderr.strip()))
+    return proc.stdout
+
+
+def massive(binary, dictionary_dir, words):
+    out = run(binary, dictionary_dir, "--check-words=-", stdin="".join(w + "\n" for w in words))
+    bits = {}
+    for line in out.splitlines():
+        word, value, _ = line.split("\t")
+        bits[word] = bool(int(value) & TIER_MASSIVE)
+    return bits
+
+
+def first_massive_word(dictionary_dir):
+    with open(os.path.join(dictionary_dir, "wlist_match1.txt")) as f:
+        for line in f:
+            if line.strip():
+                return line.strip().lower()
+    raise AssertionError("wlist_match1.txt is empty")
+
+
+def check_binary(binary, source_dir):
+    base_word = first_massive_word(source_dir)
+    steps = [
+        ("start", [], {NEW_WORD: False, base_word: True}),
+        ("add new word", ["--add-words=" + NEW_WORD], {NEW_WORD: True, base_word: True}),
+        ("remove new word", ["--remove-words=" + NEW_WORD], {NEW_WORD: False, base_word: True}),
+        ("remove base word", ["--remove-words=" + base_word], {NEW_WORD: False, base_word: False}),
+        ("add both", ["--add-words=%s,%s" % (NEW_WORD, base_word)], {NEW_WORD: True, base_word: True}),
+        ("compact", ["--compact-dictionaries"], {NEW_WORD: True, base_word: True}),
+    ]
+    failures = []
+    with tempfile.TemporaryDirectory(prefix="spellingbee-word-changes-") as scratch:
+        for name in LIST_FILES:
+            shutil.copy(os.path.join(source_dir, name), scratch)
+        for step, args, expected in steps:
+            if args:
+                run(binary, scratch, *args)
+            got = massive(binary, scratch, list(expected))
+            if got != expected:
+                failures.append("%s: expected massive %s, got %s" % (step, expected, got))
+        if any(name.startswith("delta-") for name in os.listdir(scratch)):
+            failures.append("compact: delta segments left behind")
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--cpp", help="binary built from main.cpp")
+    parser.add_argument("--c", help="binary built from main.c")
+    parser.add_argument("--dictionary-dir", required=True)
+    args = parser.parse_args()
+    binaries = [(name, path) for name, path in (("cpp", args.cpp), ("c", args.c)) if path]
+    if not binaries:
+        parser.error("give --cpp and/or --c")
+
+    failed = False
+    for name, path in binaries:
+        failures = check_binary(os.path.abspath(path), args.dictionary_dir)
+        for failure in failures:
+            sys.stderr.write("%s: %s\n" % (name, failure))
+        print("%s: %s" % (name, "FAIL" if failures else "ok"))
+        failed = failed or bool(failures)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())